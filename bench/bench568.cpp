@@ -0,0 +1,356 @@
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "engine568.h"
+#include "trace568.h"
+#include "lockstep568.h"
+#include "enginePool568.h"
+#include "programReplicas568.h"
+#include "supervisor568.h"
+#include "perfCounters568.h"
+#include "programs.h"
+
+constexpr static auto REPEATS = 5;
+
+/* batch benchmarks count up to a different bound for every input so lanes leave the loop at different times */
+constexpr static auto BATCH_INPUTS = 4096;
+constexpr static auto BATCH_SPREAD = 97;
+
+/* hardware counters around the timed part of each run, where the host allows them */
+static auto counters = PerfCounters568();
+
+/**
+ * @return the counters of a run per interpreted instruction, empty if none could be read
+ */
+static auto counterSummary(const PerfSample568 & sample, unsigned long long steps) -> std::string {
+	auto summary = std::stringstream();
+
+	if (sample.has(PerfCounter568::CYCLES)) summary << ", " << double(sample.get(PerfCounter568::CYCLES)) / double(steps) << " cycles";
+	if (sample.has(PerfCounter568::INSTRUCTIONS)) summary << ", " << double(sample.get(PerfCounter568::INSTRUCTIONS)) / double(steps) << " machine instructions";
+	if (sample.has(PerfCounter568::BRANCH_MISSES)) summary << ", " << double(sample.get(PerfCounter568::BRANCH_MISSES)) / double(steps) << " branch misses";
+	if (sample.has(PerfCounter568::CACHE_MISSES)) summary << ", " << double(sample.get(PerfCounter568::CACHE_MISSES)) / double(steps) << " cache misses";
+	if (sample.has(PerfCounter568::TLB_MISSES)) summary << ", " << double(sample.get(PerfCounter568::TLB_MISSES)) / double(steps) << " dTLB misses";
+
+	if (summary.tellp() > 0) summary << " per instruction";
+
+	return summary.str();
+}
+
+/**
+ * runs the counting loop program up to count and reports the best time over several runs
+ */
+static auto benchmark(const char * name, int count, const std::function<void(Engine568 &)> & run, bool packed = false) -> void {
+	auto canvas = Programs::countingLoop();
+	auto best = std::chrono::nanoseconds::max();
+	auto steps = 0ull;
+	auto sample = PerfSample568();
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		auto engine = Engine568();
+		engine.setPackedGrid(packed);
+		engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+		engine.pushInt(count);
+
+		counters.begin(name);
+		auto begin = std::chrono::steady_clock::now();
+		run(engine);
+		auto elapsed = std::chrono::steady_clock::now() - begin;
+		auto & runSample = counters.end();
+
+		if (engine.getInt(2) != count) {
+			std::cout << name << ": wrong result " << engine.getInt(2) << " " << engine.getError() << std::endl;
+			return;
+		}
+
+		if (elapsed < best) {
+			best = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+			sample = runSample;
+		}
+
+		steps = engine.getSteps();
+		counters.clear();
+	}
+
+	std::cout << name << ": " << best.count() / 1000000.0 << " ms, "
+		<< steps << " instructions, "
+		<< double(best.count()) / double(steps) << " ns/instruction"
+		<< counterSummary(sample, steps) << std::endl;
+}
+
+/**
+ * runs a loop program over an array as long as count, with the engine's loop kernels on or off
+ */
+static auto loopBenchmark(const char * name, ProgramCanvas canvas, int count, bool kernels) -> void {
+	auto input = std::vector<int>(count, 3);
+	auto best = std::chrono::nanoseconds::max();
+	auto steps = 0ull;
+	auto sample = PerfSample568();
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		auto engine = Engine568();
+		engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+		engine.setLoopKernels(kernels);
+		engine.pushInt(count);
+		engine.pushArray(count, input.data());
+
+		counters.begin(name);
+		auto begin = std::chrono::steady_clock::now();
+		engine.run();
+		auto elapsed = std::chrono::steady_clock::now() - begin;
+		auto & runSample = counters.end();
+
+		if (engine.getInt(2) != count) {
+			std::cout << name << ": wrong result " << engine.getInt(2) << " " << engine.getError() << std::endl;
+			return;
+		}
+
+		if (elapsed < best) {
+			best = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+			sample = runSample;
+		}
+
+		steps = engine.getSteps();
+		counters.clear();
+	}
+
+	std::cout << name << (kernels ? "" : " without loop kernels") << ": " << best.count() / 1000000.0 << " ms, "
+		<< steps << " instructions, "
+		<< double(best.count()) / double(steps) << " ns/instruction"
+		<< counterSummary(sample, steps) << std::endl;
+}
+
+/**
+ * runs the counting loop over a batch of inputs split evenly between threads,
+ * each thread handing its share to run, and reports the best time per input
+ */
+static auto batchBenchmark(const char * name, int count, unsigned int numThreads, const std::function<double(ProgramCanvas &, const std::vector<std::vector<int>> &)> & run) -> void {
+	auto canvas = Programs::countingLoop();
+	auto inputs = std::vector<std::vector<int>>(BATCH_INPUTS);
+
+	for (auto i = 0u; i < inputs.size(); ++i) inputs[i].push_back(count + int(i % BATCH_SPREAD));
+
+	auto shares = std::vector<std::vector<std::vector<int>>>(numThreads);
+	for (auto i = 0u; i < inputs.size(); ++i) shares[i * numThreads / inputs.size()].push_back(inputs[i]);
+
+	auto best = std::chrono::nanoseconds::max();
+	auto occupancy = 0.0;
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		auto occupancies = std::vector<double>(numThreads);
+		auto threads = std::vector<std::thread>();
+
+		auto begin = std::chrono::steady_clock::now();
+
+		for (auto t = 0u; t < numThreads; ++t) threads.emplace_back([&, t]() {
+			occupancies[t] = run(canvas, shares[t]);
+		});
+
+		for (auto & thread : threads) thread.join();
+
+		auto elapsed = std::chrono::steady_clock::now() - begin;
+
+		best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+
+		occupancy = 0.0;
+		for (auto threadOccupancy : occupancies) occupancy += threadOccupancy / numThreads;
+	}
+
+	std::cout << name << ": " << best.count() / 1000000.0 << " ms, "
+		<< double(best.count()) / inputs.size() << " ns/input";
+	if (occupancy > 0.0) std::cout << ", " << occupancy * 100.0 << "% lane occupancy";
+	std::cout << std::endl;
+}
+
+/**
+ * @return the lane occupancy of the run, or 0 if any lane came out wrong
+ */
+template <unsigned int Lanes>
+static auto runLockstep(ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) -> double {
+	auto engine = Engine568();
+	engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+
+	auto lockstep = LockstepEngine568<Lanes>(engine);
+	auto results = lockstep.run(share);
+
+	for (auto i = 0u; i < results.size(); ++i)
+		if (results[i].integers[2] != share[i][0]) return 0.0;
+
+	return lockstep.getStats().occupancy();
+}
+
+int main(int argc, char ** argv) {
+	auto count = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+	if (!counters.isAvailable()) std::cout << "Counters unavailable (" << counters.getUnavailableReason() << "), wall time only" << std::endl;
+
+	/* the plain runs and the policies against them without loop kernels, or a closed form loop is all they time */
+	benchmark("run", count, [](Engine568 & engine) {
+		engine.setLoopKernels(false);
+		engine.run();
+	});
+
+	/* the same loop as one closed form */
+	benchmark("run with loop kernels", count, [](Engine568 & engine) {
+		engine.run();
+	});
+
+	/* fetching from the 3 bit grid, see fetch568 for fetches on their own */
+	benchmark("packed run without loop kernels", count, [](Engine568 & engine) {
+		engine.setLoopKernels(false);
+		engine.run();
+	}, true);
+
+	/* the checks policies either side of the default, without loop kernels so every operator goes through them */
+	benchmark("full checks without loop kernels", count, [](Engine568 & engine) {
+		auto observer = NullObserver568();
+		engine.setLoopKernels(false);
+		engine.run<NullObserver568, FullChecks568>(observer);
+	});
+
+	benchmark("no checks without loop kernels", count, [](Engine568 & engine) {
+		auto observer = NullObserver568();
+		engine.setLoopKernels(false);
+		engine.run<NullObserver568, NoChecks568>(observer);
+	});
+
+	/* the same program with the load time verification thrown away */
+	benchmark("checked run", count, [](Engine568 & engine) {
+		engine.getLoadStats().verified = false;
+		engine.setLoopKernels(false);
+		engine.run();
+	});
+
+	/* should match plain run, the null observer's hooks compile away */
+	benchmark("null observer", count, [](Engine568 & engine) {
+		auto observer = NullObserver568();
+		engine.setLoopKernels(false);
+		engine.run(observer);
+	});
+
+	benchmark("profile observer", count, [](Engine568 & engine) {
+		auto observer = ProfileObserver568();
+		engine.run(observer);
+	});
+
+	benchmark("trace observer", count, [](Engine568 & engine) {
+		auto sink = std::stringstream();
+		auto recorder = TraceRecorder(sink);
+		auto observer = TraceObserver568(recorder);
+		engine.run(observer);
+	});
+
+	/* array idioms run as native loops */
+	for (auto kernels : { true, false }) {
+		loopBenchmark("fill loop", Programs::fillLoop(), count, kernels);
+		loopBenchmark("copy loop", Programs::copyLoop(), count, kernels);
+		loopBenchmark("sum loop", Programs::sumLoop(), count, kernels);
+	}
+
+	/* many short runs of the same program, on every core */
+	auto batchCount = count / 1000;
+	auto numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::cout << BATCH_INPUTS << " inputs on " << numThreads << " threads" << std::endl;
+
+	/* one engine per input, the same work each lane does, so without the closed form counting loop */
+	batchBenchmark("thread batch", batchCount, numThreads, [](ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) {
+		for (auto & input : share) {
+			auto engine = Engine568();
+			engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+			engine.setLoopKernels(false);
+			engine.pushInt(input[0]);
+			engine.run();
+
+			if (engine.getInt(2) != input[0]) std::cout << "thread batch: wrong result " << engine.getInt(2) << std::endl;
+		}
+
+		return 0.0;
+	});
+
+	/* the same with the program loaded once and shared, each input run on a pooled engine reset in between */
+	auto countingLoop = Programs::countingLoop();
+	auto pool = EnginePool568(std::make_shared<const Program568>(countingLoop.getWidth(), countingLoop.getHeight(), countingLoop.getPixels()));
+
+	batchBenchmark("shared program batch", batchCount, numThreads, [&pool](ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) {
+		for (auto & input : share) {
+			auto engine = pool.acquire();
+			engine->setLoopKernels(false);
+			engine->pushInt(input[0]);
+			engine->run();
+
+			if (engine->getInt(2) != input[0]) std::cout << "shared program batch: wrong result " << engine->getInt(2) << std::endl;
+
+			pool.release(std::move(engine));
+		}
+
+		return 0.0;
+	});
+
+	std::cout << "shared program batch made " << pool.getCreated() << " engines" << std::endl;
+
+	/* the same again with workers pinned to NUMA nodes, each pooling engines on its own node's replica */
+	auto replicas = ProgramReplicas568(pool.getProgram());
+	auto nodePools = std::vector<std::unique_ptr<EnginePool568>>();
+	for (auto node = 0u; node < replicas.getNumNodes(); ++node) nodePools.push_back(std::make_unique<EnginePool568>(replicas.get(node)));
+
+	auto nextWorker = std::atomic<unsigned int>(0);
+
+	batchBenchmark(replicas.isReplicated() ? "replicated program batch" : "pinned program batch", batchCount, numThreads, [&](ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) {
+		auto & nodePool = *nodePools[replicas.pinWorker(nextWorker++)];
+
+		for (auto & input : share) {
+			auto engine = nodePool.acquire();
+			engine->setLoopKernels(false);
+			engine->pushInt(input[0]);
+			engine->run();
+
+			if (engine->getInt(2) != input[0]) std::cout << "replicated program batch: wrong result " << engine->getInt(2) << std::endl;
+
+			nodePool.release(std::move(engine));
+		}
+
+		return 0.0;
+	});
+
+	/* worker processes running the program mapped from shared memory, against threads with the same engine settings */
+	auto kernelPool = EnginePool568(pool.getProgram());
+
+	batchBenchmark("shared program batch with loop kernels", batchCount, numThreads, [&kernelPool](ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) {
+		for (auto & input : share) {
+			auto engine = kernelPool.acquire();
+			engine->pushInt(input[0]);
+			engine->run();
+
+			if (engine->getInt(2) != input[0]) std::cout << "shared program batch with loop kernels: wrong result " << engine->getInt(2) << std::endl;
+
+			kernelPool.release(std::move(engine));
+		}
+
+		return 0.0;
+	});
+
+	auto supervisor = Supervisor568(*pool.getProgram(), numThreads);
+
+	if (!supervisor.isRunning()) std::cout << "process batch: " << supervisor.getError() << std::endl;
+	else batchBenchmark("process batch", batchCount, 1, [&supervisor](ProgramCanvas & canvas, const std::vector<std::vector<int>> & share) {
+		auto results = supervisor.run(share);
+
+		for (auto i = 0u; i < results.size(); ++i)
+			if (results[i].registers[2] != share[i][0]) std::cout << "process batch: wrong result " << results[i].registers[2] << std::endl;
+
+		return 0.0;
+	});
+
+	batchBenchmark("lockstep 8 lanes", batchCount, numThreads, runLockstep<8>);
+	batchBenchmark("lockstep 16 lanes", batchCount, numThreads, runLockstep<16>);
+
+	return 0;
+}
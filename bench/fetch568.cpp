@@ -0,0 +1,203 @@
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <random>
+#include <vector>
+#include <array>
+#include <thread>
+#include <memory>
+
+#include "engine568.h"
+#include "packedGrid568.h"
+#include "hugePages568.h"
+#include "programReplicas568.h"
+#include "perfCounters568.h"
+
+/*
+ * fetch throughput of the packed grid against the unpacked image
+ *
+ * a large random program is walked the way the engine moves,
+ * along every row, down every column, and to random pixels
+ *
+ * then random fetches again with the image on small and huge pages,
+ * and from every core with one copy of the program against a copy per NUMA node
+ */
+
+constexpr static auto REPEATS = 5;
+constexpr static auto RANDOM_FETCHES = 1 << 24;
+
+static auto isColor(unsigned int rgb) -> bool {
+	return rgb == Engine568::RED || rgb == Engine568::YELLOW || rgb == Engine568::GREEN
+		|| rgb == Engine568::CYAN || rgb == Engine568::BLUE || rgb == Engine568::MAGENTA;
+}
+
+/* only count the calling thread, so runs spread over threads report wall time alone */
+static auto counters = PerfCounters568();
+
+/**
+ * reports the best time per pixel over several runs, and the sum of colors found to compare between grids
+ */
+static auto benchmark(const char * name, unsigned long long pixels, const std::function<unsigned long long()> & run, bool counted = true) -> void {
+	auto best = std::chrono::nanoseconds::max();
+	auto checksum = 0ull;
+	auto sample = PerfSample568();
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		counters.begin(name);
+		auto begin = std::chrono::steady_clock::now();
+		checksum = run();
+		auto elapsed = std::chrono::steady_clock::now() - begin;
+		auto & phase = counters.end();
+
+		if (elapsed < best) sample = phase;
+		best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+	}
+
+	counters.clear();
+
+	std::cout << name << ": " << best.count() / 1000000.0 << " ms, "
+		<< double(best.count()) / double(pixels) << " ns/pixel, checksum " << checksum;
+
+	if (counted && sample.has(PerfCounter568::TLB_MISSES))
+		std::cout << ", " << double(sample.get(PerfCounter568::TLB_MISSES)) / double(pixels) << " dTLB misses/pixel";
+
+	std::cout << std::endl;
+}
+
+int main(int argc, char ** argv) {
+	auto size = argc > 1 ? std::stoi(argv[1]) : 4096;
+	auto percentColored = argc > 2 ? std::stoi(argv[2]) : 10;
+
+	auto random = std::mt19937(568);
+	auto image = std::vector<unsigned int>(static_cast<std::size_t>(size) * size);
+
+	constexpr unsigned int colors [] = { Engine568::RED, Engine568::YELLOW, Engine568::GREEN, Engine568::CYAN, Engine568::BLUE, Engine568::MAGENTA };
+
+	for (auto & pixel : image) pixel = int(random() % 100) < percentColored ? colors[random() % 6] : 0xFFFFFF;
+
+	auto grid = PackedGrid568(image.data(), size, size);
+
+	auto imageBytes = image.size() * sizeof(unsigned int);
+	std::cout << size << " x " << size << ", " << percentColored << "% colored, unpacked "
+		<< imageBytes / 1024 << " KiB, packed " << grid.getBytes() / 1024 << " KiB ("
+		<< double(imageBytes) / double(grid.getBytes()) << "x smaller)" << std::endl;
+
+	auto pixels = static_cast<unsigned long long>(size) * size;
+
+	/* every row right then left and every column down then up, stopping on each color like the engine */
+	auto walk = [&](const std::function<unsigned int(int &, int &, int, int)> & next) {
+		auto sum = 0ull;
+
+		for (auto line = 0; line < size; ++line) {
+			for (auto [x, y, dx, dy] : { std::array { -1, line, 1, 0 }, std::array { size, line, -1, 0 }, std::array { line, -1, 0, 1 }, std::array { line, size, 0, -1 } }) {
+				for (auto rgb = next(x, y, dx, dy); rgb != 0; rgb = next(x, y, dx, dy)) sum += rgb;
+			}
+		}
+
+		return sum;
+	};
+
+	auto unpackedNext = [&](int & x, int & y, int dx, int dy) -> unsigned int {
+		while (true) {
+			x += dx;
+			y += dy;
+
+			if (x < 0 || y < 0 || x >= size || y >= size) return 0;
+
+			auto rgb = image[y * size + x];
+			if (isColor(rgb)) return rgb;
+		}
+	};
+
+	auto packedNext = [&](int & x, int & y, int dx, int dy) -> unsigned int {
+		return grid.next(x, y, dx, dy);
+	};
+
+	benchmark("unpacked walk", pixels * 4, [&]() { return walk(unpackedNext); });
+	benchmark("packed walk", pixels * 4, [&]() { return walk(packedNext); });
+
+	/* the same pixels in the same order for both */
+	auto coordinates = std::vector<std::pair<int, int>>(RANDOM_FETCHES);
+	for (auto & [x, y] : coordinates) x = int(random() % size), y = int(random() % size);
+
+	benchmark("unpacked random", RANDOM_FETCHES, [&]() {
+		auto sum = 0ull;
+		for (auto [x, y] : coordinates) {
+			auto rgb = image[y * size + x];
+			if (isColor(rgb)) sum += rgb;
+		}
+		return sum;
+	});
+
+	benchmark("packed random", RANDOM_FETCHES, [&]() {
+		auto sum = 0ull;
+		for (auto [x, y] : coordinates) {
+			auto code = grid.at(x, y);
+			if (code != 0) sum += PackedGrid568::COLORS[code];
+		}
+		return sum;
+	});
+
+	/* a copy of the image on small pages and on huge pages, since the original came from whatever malloc chose */
+	for (auto huge : { false, true }) {
+		HugePages568::setEnabled(huge);
+		auto copy = ProgramImage568(image.begin(), image.end());
+
+		benchmark(huge ? "huge page random" : "small page random", RANDOM_FETCHES, [&]() {
+			auto sum = 0ull;
+			for (auto [x, y] : coordinates) {
+				auto rgb = copy[y * size + x];
+				if (isColor(rgb)) sum += rgb;
+			}
+			return sum;
+		});
+	}
+
+	HugePages568::setEnabled(true);
+
+	/* every core fetching at once, pinned to its node, from the first node's program or its own node's replica */
+	auto rgba = std::vector<unsigned char>(image.size() * 4);
+	for (auto i = 0u; i < image.size(); ++i) {
+		rgba[i * 4] = image[i] >> 16u;
+		rgba[i * 4 + 1] = image[i] >> 8u;
+		rgba[i * 4 + 2] = image[i];
+	}
+
+	auto program = std::make_shared<const Program568>(size, size, rgba.data(), false);
+	auto numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (auto replicate : { false, true }) {
+		auto replicas = ProgramReplicas568(program, replicate);
+
+		auto name = std::to_string(numThreads) + " threads on " + std::to_string(replicas.getNumNodes()) + " nodes, "
+			+ (replicas.isReplicated() ? "replica per node" : "one copy");
+
+		benchmark(name.c_str(), static_cast<unsigned long long>(RANDOM_FETCHES) * numThreads, [&]() {
+			auto sums = std::vector<unsigned long long>(numThreads);
+			auto threads = std::vector<std::thread>();
+
+			for (auto t = 0u; t < numThreads; ++t) threads.emplace_back([&, t]() {
+				auto * pixels = replicas.get(replicas.pinWorker(t))->getPixels();
+				auto sum = 0ull;
+
+				for (auto [x, y] : coordinates) {
+					auto rgb = pixels[y * size + x];
+					if (isColor(rgb)) sum += rgb;
+				}
+
+				sums[t] = sum;
+			});
+
+			for (auto & thread : threads) thread.join();
+
+			auto sum = 0ull;
+			for (auto threadSum : sums) sum += threadSum;
+
+			return sum;
+		}, false);
+	}
+
+	return 0;
+}
@@ -0,0 +1,352 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <random>
+#include <vector>
+#include <filesystem>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+#include "libpng16/png.h"
+
+#include "engine568.h"
+#include "image/image.h"
+#include "image/imageUtil.h"
+
+/*
+ * the image layer under the interpreter, on its own
+ *
+ * png decode and encode over sizes and color types, converting and classifying an image
+ * into a program, mode filtering at several radii, and nearest and bilinear resampling
+ *
+ * the image layer's own encoder runs at several thread counts, levels and filters,
+ * and has to decode back to the very same pixels each time
+ *
+ * inputs come from a fixed seed and every row ends in a checksum of what it produced,
+ * so runs from two builds can be lined up row by row, --csv writes them for diffing
+ *
+ *     image568 [--csv] [size ...]
+ */
+
+constexpr static auto REPEATS = 5;
+constexpr static auto CODEL_SIZE = 4u;
+constexpr static int MODE_RADII [] = { 1, 2, 4, 8 };
+
+static auto csv = false;
+
+class EncoderSetting {
+public:
+	const char * name;
+	unsigned int threads;
+	int level;
+	CNGE::PNGFilter filter;
+};
+
+static const EncoderSetting ENCODER_SETTINGS [] = {
+	{ "1 thread", 1, 6, CNGE::PNGFilter::ADAPTIVE },
+	{ "all threads", 0, 6, CNGE::PNGFilter::ADAPTIVE },
+	{ "level 1 paeth", 0, 1, CNGE::PNGFilter::PAETH },
+	{ "level 9 adaptive", 0, 9, CNGE::PNGFilter::ADAPTIVE },
+	{ "stored", 0, 0, CNGE::PNGFilter::NONE },
+};
+
+enum class ColorType {
+	RGBA,
+	RGB,
+	PALETTE,
+	GRAY,
+};
+
+static const char * colorTypeNames [] = { "rgba", "rgb", "palette", "gray" };
+
+/* the six instruction colors, filler and black, in palette order */
+constexpr static unsigned int PALETTE [8] = {
+	0xFF0000, 0xFFFF00, 0x00FF00, 0x00FFFF, 0x0000FF, 0xFF00FF, 0xFFFFFF, 0x000000
+};
+
+/**
+ * reports the best time per pixel over several runs,
+ * and a checksum of what the last run left behind, taken outside the timing, to compare between builds
+ */
+static auto benchmark(const std::string & name, unsigned int size, unsigned long long pixels, const std::function<void()> & run, const std::function<unsigned long long()> & result) -> void {
+	auto best = std::chrono::nanoseconds::max();
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		auto begin = std::chrono::steady_clock::now();
+		run();
+		auto elapsed = std::chrono::steady_clock::now() - begin;
+
+		best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+	}
+
+	auto checksum = result();
+	auto milliseconds = best.count() / 1000000.0;
+	auto perPixel = double(best.count()) / double(pixels);
+
+	if (csv) {
+		std::cout << name << "," << size << "," << milliseconds << "," << perPixel << "," << checksum << std::endl;
+	} else {
+		std::cout << name << " " << size << ": " << milliseconds << " ms, " << perPixel << " ns/pixel, checksum " << checksum << std::endl;
+	}
+}
+
+static auto fnv(const unsigned char * bytes, std::size_t length) -> unsigned long long {
+	auto hash = 0xcbf29ce484222325ull;
+
+	for (auto i = std::size_t(0); i < length; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+/**
+ * a program drawn at CODEL_SIZE pixels per codel, mostly filler with the six colors scattered through it
+ */
+static auto makeProgram(unsigned int size) -> std::vector<unsigned char> {
+	auto random = std::mt19937(568);
+	auto rgba = std::vector<unsigned char>(static_cast<std::size_t>(size) * size * 4);
+	auto codels = size / CODEL_SIZE;
+
+	for (auto j = 0u; j < codels; ++j) {
+		for (auto i = 0u; i < codels; ++i) {
+			auto color = random() % 10 < 3 ? PALETTE[random() % 6] : 0xFFFFFF;
+
+			for (auto y = j * CODEL_SIZE; y < (j + 1) * CODEL_SIZE; ++y) {
+				for (auto x = i * CODEL_SIZE; x < (i + 1) * CODEL_SIZE; ++x) {
+					auto * pixel = rgba.data() + (static_cast<std::size_t>(y) * size + x) * 4;
+
+					pixel[0] = color >> 16u;
+					pixel[1] = color >> 8u;
+					pixel[2] = color;
+					pixel[3] = 0xff;
+				}
+			}
+		}
+	}
+
+	return rgba;
+}
+
+static auto paletteIndex(const unsigned char * pixel) -> unsigned char {
+	auto rgb = (unsigned(pixel[0]) << 16u) | (unsigned(pixel[1]) << 8u) | pixel[2];
+
+	for (auto i = 0u; i < 8; ++i) if (PALETTE[i] == rgb) return static_cast<unsigned char>(i);
+
+	return 7;
+}
+
+static auto appendBytes(png_structp png, png_bytep data, png_size_t length) -> void {
+	auto * bytes = static_cast<std::vector<unsigned char> *>(png_get_io_ptr(png));
+	bytes->insert(bytes->end(), data, data + length);
+}
+
+/**
+ * encodes an rgba image in memory as any color type through libpng, since Image::toPNG only writes rgba
+ */
+static auto encode(const std::vector<unsigned char> & rgba, unsigned int size, ColorType type) -> std::vector<unsigned char> {
+	auto bytes = std::vector<unsigned char>();
+
+	auto * png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	auto * info = png_create_info_struct(png);
+
+	png_set_write_fn(png, &bytes, appendBytes, nullptr);
+
+	constexpr int pngTypes [] = { PNG_COLOR_TYPE_RGBA, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_PALETTE, PNG_COLOR_TYPE_GRAY };
+	constexpr unsigned int channels [] = { 4, 3, 1, 1 };
+
+	png_set_IHDR(png, info, size, size, 8, pngTypes[int(type)], PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+	png_color palette [8];
+
+	if (type == ColorType::PALETTE) {
+		for (auto i = 0u; i < 8; ++i) palette[i] = png_color { png_byte(PALETTE[i] >> 16u), png_byte(PALETTE[i] >> 8u), png_byte(PALETTE[i]) };
+		png_set_PLTE(png, info, palette, 8);
+	}
+
+	png_write_info(png, info);
+
+	auto row = std::vector<unsigned char>(size * channels[int(type)]);
+
+	for (auto j = 0u; j < size; ++j) {
+		auto * source = rgba.data() + static_cast<std::size_t>(j) * size * 4;
+
+		for (auto i = 0u; i < size; ++i) {
+			auto * pixel = source + i * 4;
+
+			switch (type) {
+				case ColorType::RGBA: for (auto c = 0u; c < 4; ++c) row[i * 4 + c] = pixel[c]; break;
+				case ColorType::RGB: for (auto c = 0u; c < 3; ++c) row[i * 3 + c] = pixel[c]; break;
+				case ColorType::PALETTE: row[i] = paletteIndex(pixel); break;
+				case ColorType::GRAY: row[i] = static_cast<unsigned char>((pixel[0] + pixel[1] + pixel[2]) / 3); break;
+			}
+		}
+
+		png_write_row(png, row.data());
+	}
+
+	png_write_end(png, nullptr);
+	png_destroy_write_struct(&png, &info);
+
+	return bytes;
+}
+
+/**
+ * @return a copy the image owns, as Image frees its pixels
+ */
+static auto makeImage(const std::vector<unsigned char> & rgba, unsigned int size) -> CNGE::Image {
+	auto * pixels = new u8[rgba.size()];
+	std::copy(rgba.begin(), rgba.end(), pixels);
+
+	return CNGE::Image(size, size, pixels);
+}
+
+static auto benchmarkSize(unsigned int size) -> void {
+	auto rgba = makeProgram(size);
+	auto pixels = static_cast<unsigned long long>(size) * size;
+
+	/* decode of every color type, from memory so the disk is left out */
+	for (auto type : { ColorType::RGBA, ColorType::RGB, ColorType::PALETTE, ColorType::GRAY }) {
+		auto png = encode(rgba, size, type);
+		auto decoded = std::unique_ptr<CNGE::Image>();
+
+		benchmark(std::string("decode ") + colorTypeNames[int(type)], size, pixels, [&]() {
+			decoded = CNGE::Image::fromPNG(png.data(), png.size());
+		}, [&]() {
+			return decoded == nullptr ? 0ull : fnv(decoded->getPixels(), pixels * 4);
+		});
+	}
+
+	for (auto type : { ColorType::RGBA, ColorType::PALETTE }) {
+		auto png = std::vector<unsigned char>();
+
+		benchmark(std::string("encode ") + colorTypeNames[int(type)], size, pixels, [&]() {
+			png = encode(rgba, size, type);
+		}, [&]() {
+			return fnv(png.data(), png.size());
+		});
+	}
+
+	auto image = makeImage(rgba, size);
+
+	/* the image layer's own encoder, on one thread and on all of them, then at the ends of its levels and filters */
+	for (auto [encoderName, threads, level, filter] : ENCODER_SETTINGS) {
+		auto options = CNGE::PNGWriteOptions();
+		options.threads = threads;
+		options.level = level;
+		options.filter = filter;
+
+		auto png = std::vector<u8>();
+
+		benchmark(std::string("toPNG ") + encoderName, size, pixels, [&]() {
+			png = image.toPNG(options);
+		}, [&]() {
+			return fnv(png.data(), png.size());
+		});
+
+		auto decoded = CNGE::Image::fromPNG(png.data(), png.size());
+
+		if (decoded == nullptr || !std::equal(rgba.begin(), rgba.end(), decoded->getPixels())) {
+			std::cerr << "toPNG " << encoderName << " " << size << " does not decode back to the same pixels" << std::endl;
+			std::exit(1);
+		}
+	}
+
+	/* through a temporary file */
+	auto path = std::filesystem::temp_directory_path() / ("image568-" + std::to_string(size) + ".png");
+
+	benchmark("Image::write", size, pixels, [&]() {
+		image.write(path);
+	}, [&]() {
+		return static_cast<unsigned long long>(std::filesystem::file_size(path));
+	});
+
+	std::filesystem::remove(path);
+
+	/* converting to 0xRRGGBB, collapsing codels and verifying, then packing on top */
+	for (auto packed : { false, true }) {
+		auto program = std::unique_ptr<Program568>();
+
+		benchmark(packed ? "load packed" : "load", size, pixels, [&]() {
+			program = std::make_unique<Program568>(size, size, rgba.data(), true, packed);
+		}, [&]() {
+			auto & stats = program->getLoadStats();
+			return static_cast<unsigned long long>(stats.codelSize) * 1000003ull + stats.width * 1009ull + program->getVerifyErrors().size();
+		});
+	}
+
+	for (auto radius : MODE_RADII) {
+		auto from = makeImage(rgba, size);
+		auto to = CNGE::Image::makeSheet(size, size);
+		auto * fromPointer = &from;
+		auto * toPointer = &to;
+
+		u32 colors [8];
+		for (auto i = 0u; i < 8; ++i) colors[i] = PALETTE[i] << 8u | 0xff;
+
+		benchmark("mode radius " + std::to_string(radius), size, pixels, [&]() {
+			CNGE::Util::mode(&fromPointer, &toPointer, colors, 8, radius);
+		}, [&]() {
+			return fnv(to.getPixels(), pixels * 4);
+		});
+	}
+
+	auto to = CNGE::Image::makeSheet(size, size);
+
+	benchmark("copy", size, pixels, [&]() {
+		CNGE::Util::copy(&image, &to);
+	}, [&]() {
+		return fnv(to.getPixels(), pixels * 4);
+	});
+
+	/* one u32 per pixel, what the samplers read */
+	auto packedPixels = std::vector<u32>(pixels);
+	for (auto i = 0u; i < pixels; ++i) packedPixels[i] = CNGE::Util::pix(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+
+	/* down to a pixel per codel the way loading does, and up by half a pixel to land between them */
+	for (auto [scaleName, scale] : { std::pair { "down", float(CODEL_SIZE) }, std::pair { "up", 0.5f } }) {
+		auto scaledSize = static_cast<unsigned int>(float(size) / scale);
+		auto scaledPixels = static_cast<unsigned long long>(scaledSize) * scaledSize;
+		auto scaled = std::vector<u32>(scaledPixels);
+
+		for (auto bilinear : { false, true }) {
+			auto name = std::string(bilinear ? "bilinear " : "nearest ") + scaleName;
+
+			benchmark(name, size, scaledPixels, [&]() {
+				for (auto j = 0u; j < scaledSize; ++j) {
+					for (auto i = 0u; i < scaledSize; ++i) {
+						auto x = float(i) * scale, y = float(j) * scale;
+
+						scaled[j * scaledSize + i] = bilinear
+							? CNGE::Util::sample::bilinear(packedPixels.data(), x, y, size, size, 0)
+							: CNGE::Util::sample::nearest(packedPixels.data(), x, y, size, size, 0);
+					}
+				}
+			}, [&]() {
+				return fnv(reinterpret_cast<const unsigned char *>(scaled.data()), scaled.size() * sizeof(u32));
+			});
+		}
+	}
+}
+
+int main(int argc, char ** argv) {
+	auto sizes = std::vector<unsigned int>();
+
+	for (auto i = 1; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+
+		if (arg == "--csv") csv = true;
+		else sizes.push_back(static_cast<unsigned int>(std::stoul(arg)));
+	}
+
+	if (sizes.empty()) sizes = { 256, 1024, 2048 };
+
+	if (csv) std::cout << "name,size,ms,ns/pixel,checksum" << std::endl;
+
+	for (auto size : sizes) benchmarkSize(size - size % CODEL_SIZE);
+
+	return 0;
+}
@@ -0,0 +1,321 @@
+
+#include "programs.h"
+
+#include <random>
+#include <algorithm>
+
+ProgramCanvas::ProgramCanvas(unsigned int width, unsigned int height) :
+	width(width),
+	height(height),
+	pixels(width * height * 4, 0xff) {}
+
+auto ProgramCanvas::put(unsigned int x, unsigned int y, char codel) -> void {
+	auto color = 0xffffffu;
+
+	switch (codel) {
+		case 'R': color = 0xFF0000; break;
+		case 'Y': color = 0xFFFF00; break;
+		case 'G': color = 0x00FF00; break;
+		case 'C': color = 0x00FFFF; break;
+		case 'B': color = 0x0000FF; break;
+		case 'M': color = 0xFF00FF; break;
+	}
+
+	auto * pixel = pixels.data() + (y * width + x) * 4;
+	pixel[0] = color >> 16u;
+	pixel[1] = (color >> 8u) & 0xffu;
+	pixel[2] = color & 0xffu;
+	pixel[3] = 0xff;
+}
+
+auto ProgramCanvas::row(unsigned int x, unsigned int y, const std::string & codels) -> void {
+	for (auto i = 0u; i < codels.size(); ++i) put(x + i, y, codels[i]);
+}
+
+auto ProgramCanvas::column(unsigned int x, unsigned int y, const std::string & codels) -> void {
+	for (auto j = 0u; j < codels.size(); ++j) put(x, y + j, codels[j]);
+}
+
+auto ProgramCanvas::getWidth() -> unsigned int {
+	return width;
+}
+
+auto ProgramCanvas::getHeight() -> unsigned int {
+	return height;
+}
+
+auto ProgramCanvas::getPixels() -> unsigned char * {
+	return pixels.data();
+}
+
+namespace Programs {
+	/*
+	 * .RC...............
+	 * ..R...............
+	 * ..RGBMMRGRGMYGRYYC
+	 * ..R..............R
+	 * ..YR.............G
+	 *
+	 * enters the body heading right on the third row,
+	 * green = 1 + green, then loops back around while green < yellow
+	 */
+	auto countingLoop() -> ProgramCanvas {
+		auto canvas = ProgramCanvas(18, 5);
+
+		canvas.row(1, 0, "RC");
+		canvas.column(2, 1, "RRRY");
+		canvas.row(3, 2, "GBMMRGRGMYGRYYC");
+		canvas.column(17, 3, "RG");
+		canvas.put(3, 4, 'R');
+
+		return canvas;
+	}
+
+	/*
+	 * <setup>RC..........
+	 * .......R...........
+	 * .......R<body>YC
+	 * .......R.......R
+	 * .......YR......G
+	 *
+	 * the same layout as the counting loop with the setup in front of it
+	 */
+	auto loop(const std::string & setup, const std::string & body) -> ProgramCanvas {
+		auto left = static_cast<unsigned int>(setup.size()) + 1;
+		auto right = left + 1 + static_cast<unsigned int>(body.size()) + 1;
+
+		auto canvas = ProgramCanvas(right + 1, 5);
+
+		canvas.row(0, 0, setup + "RC");
+		canvas.column(left, 1, "RRRY");
+		canvas.row(left + 1, 2, body + "YC");
+		canvas.column(right, 3, "RG");
+		canvas.put(left + 1, 4, 'R');
+
+		return canvas;
+	}
+
+	/* green += 1, green < yellow, the tail of every loop below */
+	static const auto STEP_GREEN = std::string("GBMMRGRGMYGRY");
+
+	auto fillLoop() -> ProgramCanvas {
+		return loop("CGRYC", "GGGBMBGYG" + STEP_GREEN);
+	}
+
+	auto copyLoop() -> ProgramCanvas {
+		return loop("CCRYC", "GYGMBGYC" "GBMMRGRC" + STEP_GREEN);
+	}
+
+	auto sumLoop() -> ProgramCanvas {
+		return loop("", "GYGMMRGRC" + STEP_GREEN);
+	}
+
+	/**
+	 * builds straight line programs out of random statements along the top row,
+	 * with branches and switches that detour through the rows below and rejoin further right
+	 *
+	 * control only ever moves right or comes back up to the top row further along,
+	 * so every program ends by running off the right edge or on an error
+	 *
+	 * arithmetic right hand sides are small literals so results stay well away from overflow,
+	 * and now and then a divisor is zero or a register that may be, or a not lands on a plain value,
+	 * so those errors are run too
+	 */
+	class RandomProgram {
+	private:
+		constexpr static unsigned int ROWS = 4;
+		constexpr static unsigned int MAX_MULTIPLIES = 6;
+
+		std::mt19937 random;
+		std::string rows [ROWS];
+		unsigned int multiplies;
+
+		/* registers that have had arrays allocated so far */
+		std::string allocated;
+
+		auto pick(unsigned int count) -> unsigned int {
+			return random() % count;
+		}
+
+		auto place(unsigned int x, unsigned int y, const std::string & codels) -> void {
+			if (rows[y].size() < x + codels.size()) rows[y].resize(x + codels.size(), '.');
+			rows[y].replace(x, codels.size(), codels);
+		}
+
+		auto registerColor() -> char {
+			return "RYGCBM"[pick(6)];
+		}
+
+		/* the codels of a literal after its green, ones and zeros below the leading one */
+		auto literal(unsigned int value) -> std::string {
+			if (value == 0) return "M";
+
+			auto codels = std::string();
+			auto top = 31u;
+			while ((value >> top) == 0) --top;
+
+			for (auto bit = top; bit-- > 0;) codels += ((value >> bit) & 1u) ? 'G' : 'C';
+
+			return codels + 'B';
+		}
+
+		/* dereferences mostly go through registers that have been given arrays, the rest usually fail */
+		auto dereference() -> std::string {
+			if (pick(16) == 0) return std::string("Y") + registerColor();
+			if (allocated.empty()) return std::string("R") + registerColor();
+
+			return std::string("Y") + allocated[pick(allocated.size())];
+		}
+
+		auto operand() -> std::string {
+			switch (pick(10)) {
+				case 0: return dereference();
+				case 1: case 2: case 3: case 4: return std::string("R") + registerColor();
+				default: return literal(pick(12));
+			}
+		}
+
+		auto target() -> std::string {
+			switch (pick(24)) {
+				case 0: return literal(pick(4));
+				case 1: case 2: case 3: return dereference();
+				default: return std::string("R") + registerColor();
+			}
+		}
+
+		auto divisor() -> std::string {
+			switch (pick(48)) {
+				case 0: return literal(0);
+				case 1: return std::string("R") + registerColor();
+				default: return literal(1 + pick(7));
+			}
+		}
+
+		auto arithmetic() -> std::string {
+			switch (pick(multiplies < MAX_MULTIPLIES ? 5 : 4)) {
+				case 0: return "BRG" + literal(pick(16));
+				case 1: return "BYG" + literal(pick(16));
+				case 2: return "BCG" + divisor();
+				case 3: return "BBG" + divisor();
+				default: return ++multiplies, "BGG" + literal(pick(4));
+			}
+		}
+
+		auto statement() -> std::string {
+			switch (pick(16)) {
+				case 0: case 1: case 2:
+					return "G" + operand() + arithmetic();
+				case 3: case 4: case 5:
+					return "G" + operand() + arithmetic() + "MBG" + target();
+				case 6: case 7:
+					return "G" + operand() + "MBG" + target();
+				case 8:
+					return "G" + operand() + "M" + "RYG"[pick(3)] + "G" + operand();
+				case 9: {
+					auto op = "RYG"[pick(3)];
+					if (op == 'G') {
+						if (multiplies == MAX_MULTIPLIES) op = 'R';
+						else ++multiplies;
+					}
+					return "G" + literal(pick(4)) + "MM" + op + "G" + target();
+				}
+				case 10:
+					return "G" + (pick(8) ? std::string("R") + registerColor() : operand()) + "BM";
+				case 11:
+					return "G" + (pick(8) ? std::string("R") + registerColor() : operand()) + "MMM";
+				case 12:
+					return "G" + (pick(2) ? literal(65 + pick(26)) : std::string("R") + registerColor()) + "MC";
+				case 13: {
+					/* occasionally one initializer too many */
+					auto size = 1 + pick(4);
+					auto initializers = pick(8) ? pick(size + 1) : size + 1;
+					auto color = registerColor();
+					auto codels = "C" + std::string(1, color) + literal(size);
+
+					allocated.push_back(color);
+
+					for (auto i = 0u; i < initializers; ++i) codels += "G" + operand();
+
+					return codels + "C";
+				}
+				case 14:
+					/* leaves an operator waiting on the next statement's value */
+					return "G" + operand() + "B" + "RY"[pick(2)];
+				default:
+					return "G" + operand();
+			}
+		}
+
+		auto block(unsigned int count) -> std::string {
+			auto codels = std::string();
+			for (auto i = 0u; i < count; ++i) codels += statement();
+
+			return codels;
+		}
+
+		/**
+		 * a branch or single case switch at x that detours
+		 * down through the bottom row when taken
+		 *
+		 * @return the column after the detour rejoins the top row
+		 */
+		auto detour(unsigned int x) -> unsigned int {
+			auto entry = std::string("YC");
+			auto turn = x + 1;
+
+			if (pick(2)) {
+				auto value = operand();
+				entry = "YBG" + value + "CCR";
+				turn = x + 3 + value.size();
+			}
+
+			auto notTaken = block(pick(3));
+			auto taken = block(pick(3));
+
+			auto notTakenX = x + entry.size();
+			auto rejoin = 1 + std::max(notTakenX + notTaken.size(), turn + 1 + taken.size());
+
+			place(x, 0, entry);
+			place(notTakenX, 0, notTaken);
+			place(rejoin - 1, 0, "RR");
+
+			place(turn, 2, "R");
+			place(turn, 3, "R" + taken);
+			place(rejoin - 1, 3, "RY");
+			place(rejoin, 1, "R");
+
+			return rejoin + 1;
+		}
+
+	public:
+		explicit RandomProgram(unsigned int seed) : random(seed), rows(), multiplies(0), allocated() {}
+
+		auto generate() -> ProgramCanvas {
+			auto x = 0u;
+			auto statements = 4 + pick(24);
+
+			for (auto i = 0u; i < statements; ++i) {
+				if (pick(5) == 0) {
+					x = detour(x);
+
+				} else {
+					auto codels = statement();
+					place(x, 0, codels);
+					x += codels.size();
+				}
+			}
+
+			auto width = 1u;
+			for (auto & row : rows) width = std::max(width, static_cast<unsigned int>(row.size()));
+
+			auto canvas = ProgramCanvas(width, ROWS);
+			for (auto j = 0u; j < ROWS; ++j) canvas.row(0, j, rows[j]);
+
+			return canvas;
+		}
+	};
+
+	auto random(unsigned int seed) -> ProgramCanvas {
+		return RandomProgram(seed).generate();
+	}
+}
@@ -0,0 +1,48 @@
+
+#ifndef LANGUAGE568_PROGRAMS_H
+#define LANGUAGE568_PROGRAMS_H
+
+#include <vector>
+#include <string>
+
+/**
+ * a blank rgba image to lay out programs on, one character per codel
+ *
+ * R Y G C B M are the six instruction colors, anything else is filler
+ */
+class ProgramCanvas {
+private:
+	unsigned int width, height;
+	std::vector<unsigned char> pixels;
+
+public:
+	ProgramCanvas(unsigned int, unsigned int);
+
+	auto put(unsigned int, unsigned int, char) -> void;
+	auto row(unsigned int, unsigned int, const std::string &) -> void;
+	auto column(unsigned int, unsigned int, const std::string &) -> void;
+
+	auto getWidth() -> unsigned int;
+	auto getHeight() -> unsigned int;
+	auto getPixels() -> unsigned char *;
+};
+
+namespace Programs {
+	/* counts the green register up to the first input */
+	auto countingLoop() -> ProgramCanvas;
+
+	/* runs setup once then body over and over while its last statement is nonzero */
+	auto loop(const std::string &, const std::string &) -> ProgramCanvas;
+
+	/* allocates green as long as the first input and fills it with 7 */
+	auto fillLoop() -> ProgramCanvas;
+	/* copies the array second input into cyan, as long as the first input */
+	auto copyLoop() -> ProgramCanvas;
+	/* sums the array second input into cyan, as long as the first input */
+	auto sumLoop() -> ProgramCanvas;
+
+	/* a random verified program that always terminates, the same one for the same seed */
+	auto random(unsigned int) -> ProgramCanvas;
+}
+
+#endif //LANGUAGE568_PROGRAMS_H
@@ -0,0 +1,114 @@
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <random>
+#include <filesystem>
+
+#include "engine568.h"
+#include "image/image.h"
+#include "programs.h"
+
+/*
+ * time to first instruction and total latency of a tall program,
+ * loaded whole against decoded progressively while it runs
+ *
+ * the counting loop sits at the top of an image padded out with noise,
+ * so every row has to be decoded but the program only ever touches the first few
+ */
+
+constexpr static auto REPEATS = 5;
+
+class Latency {
+public:
+	std::chrono::nanoseconds firstInstruction;
+	std::chrono::nanoseconds total;
+};
+
+/**
+ * @param load builds an engine ready to run the program at path
+ */
+template <typename Load>
+static auto benchmark(const char * name, const std::filesystem::path & path, int count, Load load) -> void {
+	auto best = Latency { std::chrono::nanoseconds::max(), std::chrono::nanoseconds::max() };
+
+	for (auto i = 0; i < REPEATS; ++i) {
+		auto begin = std::chrono::steady_clock::now();
+
+		auto engine = Engine568();
+		if (!load(engine, path)) {
+			std::cout << name << ": could not load " << path << std::endl;
+			return;
+		}
+
+		engine.pushInt(count);
+		engine.start();
+		auto firstInstruction = std::chrono::steady_clock::now();
+
+		while (engine.step());
+		auto end = std::chrono::steady_clock::now();
+
+		if (engine.getInt(2) != count) {
+			std::cout << name << ": wrong result " << engine.getInt(2) << " " << engine.getError() << std::endl;
+			return;
+		}
+
+		best.firstInstruction = std::min(best.firstInstruction, firstInstruction - begin);
+		best.total = std::min(best.total, end - begin);
+	}
+
+	std::cout << name << ": first instruction after " << best.firstInstruction.count() / 1000000.0 << " ms, finished after "
+		<< best.total.count() / 1000000.0 << " ms" << std::endl;
+}
+
+int main(int argc, char ** argv) {
+	auto width = argc > 1 ? std::stoi(argv[1]) : 1024;
+	auto height = argc > 2 ? std::stoi(argv[2]) : 16384;
+	auto count = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+	auto program = Programs::countingLoop();
+	auto image = CNGE::Image::makeSheet(width, height);
+	auto * pixels = image.getPixels();
+
+	/* gray noise never makes an instruction color and does not compress away */
+	auto random = std::mt19937(568);
+
+	for (auto j = 0; j < height; ++j) {
+		for (auto i = 0; i < width; ++i) {
+			auto * pixel = pixels + (static_cast<std::size_t>(j) * width + i) * 4;
+			auto shade = static_cast<unsigned char>(j < 8 ? 0xff : 0x20 + random() % 0xc0);
+
+			pixel[0] = pixel[1] = pixel[2] = shade;
+			pixel[3] = 0xff;
+		}
+	}
+
+	for (auto j = 0u; j < program.getHeight(); ++j)
+		for (auto i = 0u; i < program.getWidth() * 4; ++i)
+			pixels[(static_cast<std::size_t>(j) * width) * 4 + i] = program.getPixels()[j * program.getWidth() * 4 + i];
+
+	auto path = std::filesystem::temp_directory_path() / "progressive568.png";
+	image.write(path);
+
+	std::cout << width << " x " << height << " program, " << std::filesystem::file_size(path) / 1024 << " KiB png" << std::endl;
+
+	benchmark("whole load", path, count, [](Engine568 & engine, const std::filesystem::path & path) {
+		auto image = CNGE::Image::fromPNG(path.string().c_str());
+		if (image == nullptr) return false;
+
+		engine.load(image->getWidth(), image->getHeight(), image->getPixels(), false);
+		return true;
+	});
+
+	benchmark("progressive load", path, count, [](Engine568 & engine, const std::filesystem::path & path) {
+		auto program = Program568::decodePNG(path.string().c_str());
+		if (program == nullptr) return false;
+
+		engine.attach(program);
+		return true;
+	});
+
+	std::filesystem::remove(path);
+
+	return 0;
+}
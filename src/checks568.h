@@ -0,0 +1,52 @@
+
+
+#ifndef LANGUAGE568_CHECKS568_H
+#define LANGUAGE568_CHECKS568_H
+
+/*
+ * policies for which run time checks the engine makes, chosen at compile time
+ * so a check left out leaves no branch behind in the hot loop
+ *
+ * a failed check stops the program with an error the way any other run time error does,
+ * without it the program is trusted not to need it
+ *
+ * the engine library runs all three, see engine568Run.h to run another
+ */
+
+/**
+ * every check, for programs nobody has looked at
+ */
+class FullChecks568 {
+public:
+	/* reading arrays out of bounds or through a register without one, and negating something that is not a reference */
+	constexpr static bool BOUNDS = true;
+	constexpr static bool NEGATIVE_SIZE = true;
+	constexpr static bool DIVISION_BY_ZERO = true;
+	/* + - * and / leaving the range of an int */
+	constexpr static bool INTEGER_OVERFLOW = true;
+};
+
+/**
+ * what the engine has always checked, plus division by zero,
+ * with arithmetic wrapping around instead of overflowing
+ */
+class DefaultChecks568 {
+public:
+	constexpr static bool BOUNDS = true;
+	constexpr static bool NEGATIVE_SIZE = true;
+	constexpr static bool DIVISION_BY_ZERO = true;
+	constexpr static bool INTEGER_OVERFLOW = false;
+};
+
+/**
+ * nothing checked, for verified programs that are trusted to stay in bounds and never divide by zero
+ */
+class NoChecks568 {
+public:
+	constexpr static bool BOUNDS = false;
+	constexpr static bool NEGATIVE_SIZE = false;
+	constexpr static bool DIVISION_BY_ZERO = false;
+	constexpr static bool INTEGER_OVERFLOW = false;
+};
+
+#endif //LANGUAGE568_CHECKS568_H
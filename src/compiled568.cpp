@@ -0,0 +1,121 @@
+
+#include "compiled568.h"
+
+#include <map>
+
+static auto registry() -> std::map<std::string, Compiled568::Factory> & {
+	static auto programs = std::map<std::string, Compiled568::Factory>();
+	return programs;
+}
+
+Compiled568::Compiled568() :
+	registerIndex(1),
+	registers(NUM_REGISTERS),
+	arrays(NUM_REGISTERS),
+	x(0), y(0),
+	dx(0), dy(0),
+	errorColor(nullptr),
+	error("")
+{}
+
+Compiled568::~Compiled568() = default;
+
+/**
+ * clears registers and arrays, like loading an engine again
+ */
+auto Compiled568::reset() -> void {
+	registers.clear();
+	registers.resize(NUM_REGISTERS);
+
+	arrays.clear();
+	arrays.resize(NUM_REGISTERS);
+
+	registerIndex = 1;
+	error = "";
+}
+
+auto Compiled568::pushInt(int value) -> void {
+	registers[registerIndex].integer = value;
+
+	++registerIndex;
+}
+
+auto Compiled568::pushArray(unsigned int length, int * data) -> void {
+	auto & backingArray = arrays.at(registerIndex);
+	auto & reg = registers.at(registerIndex);
+
+	backingArray.assign(data, data + length);
+
+	reg.integer = 0;
+	reg.array = &backingArray;
+
+	++registerIndex;
+}
+
+/**
+ * the program ran out of bounds here, which is how programs end
+ */
+auto Compiled568::end(int x, int y, int dx, int dy) -> void {
+	this->x = x;
+	this->y = y;
+	this->dx = dx;
+	this->dy = dy;
+}
+
+auto Compiled568::fail(int x, int y, int dx, int dy, const char * color, std::string && error) -> void {
+	end(x, y, dx, dy);
+
+	this->errorColor = color;
+	this->error = error;
+}
+
+auto Compiled568::getInt(unsigned int index) -> int {
+	return registers[index].integer;
+}
+
+auto Compiled568::getRegister(unsigned int index) -> RegisterValue & {
+	return registers.at(index);
+}
+
+auto Compiled568::getNumInputs() -> unsigned int {
+	return registerIndex - 1;
+}
+
+auto Compiled568::getArray(unsigned int index) -> std::vector<int> & {
+	return arrays.at(index);
+}
+
+auto Compiled568::getError() -> std::string {
+	if (error.empty()) return "";
+
+	return Engine568::formatError(x, y, dx, dy, errorColor, error);
+}
+
+auto Compiled568::getX() -> int {
+	return x;
+}
+
+auto Compiled568::getY() -> int {
+	return y;
+}
+
+auto Compiled568::getDX() -> int {
+	return dx;
+}
+
+auto Compiled568::getDY() -> int {
+	return dy;
+}
+
+auto Compiled568::add(const char * name, Factory factory) -> bool {
+	registry()[name] = factory;
+	return true;
+}
+
+/**
+ * @return the factory for a compiled program linked into this binary, or null
+ */
+auto Compiled568::find(const std::string & name) -> Factory {
+	auto found = registry().find(name);
+	return found == registry().end() ? nullptr : found->second;
+}
@@ -0,0 +1,90 @@
+
+#ifndef LANGUAGE568_COMPILED568_H
+#define LANGUAGE568_COMPILED568_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "engine568.h"
+
+/**
+ * base of the programs transpile568 turns into C++ ahead of time
+ *
+ * inputs go in and results come out through the same calls as Engine568,
+ * so a compiled program can stand in for an engine running the same image
+ */
+class Compiled568 {
+public:
+	using Factory = std::unique_ptr<Compiled568> (*)();
+
+protected:
+	constexpr static int NUM_REGISTERS = 6;
+
+	/* the operator waiting on the next value, engine568 keeps these as functions */
+	enum Operator : int {
+		NONE,
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		MODULO,
+		EQUAL,
+		LESS,
+		GREATER,
+		ASSIGN,
+		COMPOUND_ADD,
+		COMPOUND_SUBTRACT,
+		COMPOUND_MULTIPLY,
+		COMPOUND_DIVIDE,
+		COMPOUND_MODULO,
+	};
+
+	unsigned int registerIndex;
+	std::vector<RegisterValue> registers;
+	std::vector<std::vector<int>> arrays;
+
+	int x, y;
+	int dx, dy;
+
+	/* color under the error, null if it happened out of bounds */
+	const char * errorColor;
+	std::string error;
+
+	auto end(int, int, int, int) -> void;
+	auto fail(int, int, int, int, const char *, std::string &&) -> void;
+
+	/* arithmetic wraps around the way DefaultChecks568 has the engine do it */
+	inline static auto wrap(long long result) -> int {
+		return int(static_cast<unsigned int>(result));
+	}
+
+public:
+	Compiled568();
+	virtual ~Compiled568();
+
+	auto reset() -> void;
+
+	auto pushInt(int) -> void;
+	auto pushArray(unsigned int, int *) -> void;
+
+	virtual auto run() -> void = 0;
+
+	auto getInt(unsigned int) -> int;
+	auto getRegister(unsigned int) -> RegisterValue &;
+	auto getNumInputs() -> unsigned int;
+	auto getArray(unsigned int) -> std::vector<int> &;
+
+	auto getError() -> std::string;
+
+	auto getX() -> int;
+	auto getY() -> int;
+	auto getDX() -> int;
+	auto getDY() -> int;
+
+	/* generated programs register themselves under their class name */
+	static auto add(const char *, Factory) -> bool;
+	static auto find(const std::string &) -> Factory;
+};
+
+#endif //LANGUAGE568_COMPILED568_H
@@ -0,0 +1,667 @@
+
+#ifndef LANGUAGE568_CONSTEXPR568_H
+#define LANGUAGE568_CONSTEXPR568_H
+
+/*
+ * an interpreter core that can run entirely during compilation
+ *
+ * programs come in as codel arrays written by embed568 and everything
+ * the engine keeps on the heap lives in fixed capacity arrays instead,
+ * so a constexpr variable can hold the registers, arrays and output of a finished run
+ */
+
+#include <initializer_list>
+#include <string_view>
+
+/* one byte per codel in an embedded program, in the order of Engine568's color names */
+enum class Codel568 : unsigned char {
+	RED = 0,
+	YELLOW = 1,
+	GREEN = 2,
+	CYAN = 3,
+	BLUE = 4,
+	MAGENTA = 5,
+	NONE = 6,
+};
+
+class EmbeddedProgram568 {
+public:
+	unsigned int width, height;
+	const unsigned char * codels;
+};
+
+enum class ConstError568 : unsigned char {
+	NONE,
+	OUT_OF_BOUNDS,
+	INVALID_DIRECTION,
+	REGISTER_AFTER_LITERAL,
+	ZERO_END,
+	UNEXPECTED_COLOR,
+	NOT_AN_ARRAY,
+	ARRAY_OUT_OF_BOUNDS,
+	NEGATIVE_SIZE,
+	TOO_MANY_ELEMENTS,
+	ASSIGN_TO_VALUE,
+	COMPOUND_ASSIGN_TO_VALUE,
+	NEGATE_VALUE,
+	DIVISION_BY_ZERO,
+	/* limits of the fixed capacity storage */
+	ARRAY_TOO_LARGE,
+	OUTPUT_FULL,
+	STEP_LIMIT,
+};
+
+/**
+ * the engine's semantics, including where it stops on errors,
+ * without std::function, iostream or allocation
+ *
+ * references are kept as indices rather than pointers so a finished engine
+ * can be copied out of a constant evaluation
+ */
+template <unsigned int MaxArray = 256, unsigned int MaxOutput = 256>
+class ConstEngine568 {
+public:
+	class Array {
+	public:
+		int elements [MaxArray] {};
+		unsigned int size = 0;
+	};
+
+private:
+	constexpr static int NUM_REGISTERS = 6;
+
+	/* where a reference points, an array element or a register's integer */
+	constexpr static int REF_NONE = -2;
+	constexpr static int REF_REGISTER = -1;
+
+	class Ref {
+	public:
+		int array;
+		int index;
+	};
+
+	class Register {
+	public:
+		int integer;
+		int array;
+	};
+
+	class Value {
+	public:
+		int val;
+		Ref ref;
+		int reg;
+	};
+
+	enum Operator : unsigned char {
+		NONE,
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		MODULO,
+		EQUAL,
+		LESS,
+		GREATER,
+		ASSIGN,
+		COMPOUND_ADD,
+		COMPOUND_SUBTRACT,
+		COMPOUND_MULTIPLY,
+		COMPOUND_DIVIDE,
+		COMPOUND_MODULO,
+	};
+
+	constexpr static int RED = 0, YELLOW = 1, GREEN = 2, CYAN = 3, BLUE = 4, MAGENTA = 5;
+
+	EmbeddedProgram568 program;
+	unsigned long long maxSteps;
+
+	unsigned int registerIndex;
+	Register registers [NUM_REGISTERS];
+	Array arrays [NUM_REGISTERS];
+
+	char output [MaxOutput];
+	unsigned int outputSize;
+
+	int x, y;
+	int dx, dy;
+	int lastValue;
+	Ref lastRef;
+	int lastReg;
+	Operator currentOperator;
+	int currentColor;
+	unsigned long long steps;
+
+	ConstError568 error;
+
+	constexpr auto outOfBounds() -> bool;
+	constexpr auto moveUntil(int &) -> bool;
+	constexpr auto fail(ConstError568) -> void;
+	constexpr auto deref(Ref) -> int &;
+	constexpr auto basicOp(Operator, int, int) -> int;
+
+	constexpr auto turn(int) -> bool;
+	constexpr auto parseDir() -> int;
+	constexpr auto parseBranch() -> void;
+	constexpr auto parseVal() -> Value;
+	constexpr auto parseHeap() -> void;
+	constexpr auto parseOperator1(bool) -> Operator;
+	constexpr auto parseOperator2() -> void;
+	constexpr auto applyOperator(Value &) -> void;
+	constexpr auto execute() -> bool;
+
+public:
+	constexpr explicit ConstEngine568(EmbeddedProgram568, unsigned long long = 1u << 20u);
+
+	constexpr auto pushInt(int) -> void;
+	constexpr auto pushArray(std::initializer_list<int>) -> void;
+
+	constexpr auto run() -> void;
+
+	constexpr auto getInt(unsigned int) const -> int;
+	constexpr auto getArray(unsigned int) const -> const Array &;
+	constexpr auto getOutput() const -> std::string_view;
+	constexpr auto getError() const -> ConstError568;
+	constexpr auto getSteps() const -> unsigned long long;
+	constexpr auto getX() const -> int;
+	constexpr auto getY() const -> int;
+};
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr ConstEngine568<MaxArray, MaxOutput>::ConstEngine568(EmbeddedProgram568 program, unsigned long long maxSteps) :
+	program(program),
+	maxSteps(maxSteps),
+	registerIndex(1),
+	registers(),
+	arrays(),
+	output(),
+	outputSize(0),
+	x(0), y(0),
+	dx(0), dy(0),
+	lastValue(0),
+	lastRef { REF_NONE, 0 },
+	lastReg(-1),
+	currentOperator(NONE),
+	currentColor(0),
+	steps(0),
+	error(ConstError568::NONE)
+{
+	for (auto & reg : registers) reg = Register { 0, -1 };
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::outOfBounds() -> bool {
+	return x < 0 || y < 0 || x >= int(program.width) || y >= int(program.height);
+}
+
+/**
+ * @return true if it ran out of bounds before reaching a colored codel
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::moveUntil(int & color) -> bool {
+	while (true) {
+		x += dx;
+		y += dy;
+
+		if (outOfBounds()) return true;
+
+		auto codel = program.codels[y * program.width + x];
+
+		if (codel < static_cast<unsigned char>(Codel568::NONE)) {
+			color = codel;
+			return false;
+		}
+	}
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::fail(ConstError568 error) -> void {
+	this->error = error;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::deref(Ref ref) -> int & {
+	if (ref.array == REF_REGISTER) return registers[ref.index].integer;
+	else return arrays[ref.array].elements[ref.index];
+}
+
+/**
+ * checked and wrapped around as DefaultChecks568 has the engine do it,
+ * a zero divisor fails and gives 0, which compound assignment still stores
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::basicOp(Operator op, int lastVal, int currentVal) -> int {
+	auto wrap = [](long long result) { return int(static_cast<unsigned int>(result)); };
+
+	switch (op) {
+		case ADD: case COMPOUND_ADD: return wrap(static_cast<long long>(lastVal) + currentVal);
+		case SUBTRACT: case COMPOUND_SUBTRACT: return wrap(static_cast<long long>(lastVal) - currentVal);
+		case MULTIPLY: case COMPOUND_MULTIPLY: return wrap(static_cast<long long>(lastVal) * currentVal);
+		case DIVIDE: case COMPOUND_DIVIDE: {
+			if (currentVal == 0) return fail(ConstError568::DIVISION_BY_ZERO), 0;
+			return currentVal == -1 ? wrap(-static_cast<long long>(lastVal)) : lastVal / currentVal;
+		}
+		case MODULO: case COMPOUND_MODULO: {
+			if (currentVal == 0) return fail(ConstError568::DIVISION_BY_ZERO), 0;
+			return currentVal == -1 ? 0 : lastVal % currentVal;
+		}
+		case EQUAL: return lastVal == currentVal;
+		case LESS: return lastVal < currentVal;
+		case GREATER: return lastVal > currentVal;
+		default: return currentVal;
+	}
+}
+
+/**
+ * @return true if the color is not a direction
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::turn(int color) -> bool {
+	switch (color) {
+		case RED: dx = 1; dy = 0; return false;
+		case YELLOW: dx = 0; dy = -1; return false;
+		case GREEN: dx = -1; dy = 0; return false;
+		case CYAN: dx = 0; dy = 1; return false;
+		default: return true;
+	}
+}
+
+/**
+ * @return the direction color, or -1 after failing
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseDir() -> int {
+	auto color = 0;
+	if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS), -1;
+
+	if (color > CYAN && color != BLUE) return fail(ConstError568::INVALID_DIRECTION), -1;
+
+	return color;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseBranch() -> void {
+	auto direction = parseDir();
+	if (direction == -1) return;
+
+	/* for blue, a switch statement */
+	if (direction != BLUE) {
+		if (lastValue) turn(direction);
+		return;
+	}
+
+	while (true) {
+		auto color = 0;
+		if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS);
+
+		switch (color) {
+			case RED: {
+				direction = parseDir();
+				if (direction == -1) return;
+				if (turn(direction)) return fail(ConstError568::INVALID_DIRECTION);
+
+				break;
+			}
+			case GREEN: {
+				auto value = parseVal();
+				if (error != ConstError568::NONE) return;
+
+				direction = parseDir();
+				if (direction == -1) return;
+				if (direction == BLUE) return fail(ConstError568::INVALID_DIRECTION);
+
+				if (value.val == lastValue) {
+					turn(direction);
+					return;
+				}
+
+				break;
+			}
+			case CYAN: {
+				direction = parseDir();
+				if (direction == -1) return;
+				if (turn(direction)) return fail(ConstError568::INVALID_DIRECTION);
+
+				return;
+			}
+			case BLUE: return;
+			default: return fail(ConstError568::UNEXPECTED_COLOR);
+		}
+	}
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseVal() -> Value {
+	auto value = 1;
+	auto color = 0;
+
+	while (true) {
+		if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS), Value { 0, Ref { REF_NONE, 0 }, -1 };
+
+		switch (color) {
+			case RED: {
+				if (value != 1) return fail(ConstError568::REGISTER_AFTER_LITERAL), Value { 0, Ref { REF_NONE, 0 }, -1 };
+				if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS), Value { 0, Ref { REF_NONE, 0 }, -1 };
+
+				return Value { registers[color].integer, Ref { REF_REGISTER, color }, color };
+			}
+			case YELLOW: {
+				if (value != 1) return fail(ConstError568::REGISTER_AFTER_LITERAL), Value { 0, Ref { REF_NONE, 0 }, -1 };
+				if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS), Value { 0, Ref { REF_NONE, 0 }, -1 };
+
+				auto & reg = registers[color];
+
+				if (reg.array == -1) return fail(ConstError568::NOT_AN_ARRAY), Value { 0, Ref { REF_NONE, 0 }, -1 };
+				if (static_cast<unsigned int>(reg.integer) >= arrays[reg.array].size) return fail(ConstError568::ARRAY_OUT_OF_BOUNDS), Value { 0, Ref { REF_NONE, 0 }, -1 };
+
+				return Value { arrays[reg.array].elements[reg.integer], Ref { reg.array, reg.integer }, -1 };
+			}
+			case GREEN: value = (value << 1) + 1; break;
+			case CYAN: value <<= 1; break;
+			case BLUE: return Value { value, Ref { REF_NONE, 0 }, -1 };
+			case MAGENTA: {
+				if (value != 1) return fail(ConstError568::ZERO_END), Value { 0, Ref { REF_NONE, 0 }, -1 };
+				return Value { 0, Ref { REF_NONE, 0 }, -1 };
+			}
+		}
+	}
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseHeap() -> void {
+	auto index = 0;
+	if (moveUntil(index)) return fail(ConstError568::OUT_OF_BOUNDS);
+
+	auto size = parseVal();
+	if (error != ConstError568::NONE) return;
+	if (size.val < 0) return fail(ConstError568::NEGATIVE_SIZE);
+	if (static_cast<unsigned int>(size.val) > MaxArray) return fail(ConstError568::ARRAY_TOO_LARGE);
+
+	auto & array = arrays[index];
+	array.size = size.val;
+	for (auto & element : array.elements) element = 0;
+
+	registers[index] = Register { 0, index };
+
+	for (auto element = 0;;) {
+		auto color = 0;
+		if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS);
+
+		switch (color) {
+			case RED: {
+				auto direction = parseDir();
+				if (direction == -1) return;
+				if (turn(direction)) return fail(ConstError568::INVALID_DIRECTION);
+
+				break;
+			}
+			case GREEN: {
+				if (element == size.val) return fail(ConstError568::TOO_MANY_ELEMENTS);
+
+				auto value = parseVal();
+				if (error != ConstError568::NONE) return;
+
+				array.elements[element++] = value.val;
+				break;
+			}
+			case CYAN: return;
+			default: return fail(ConstError568::UNEXPECTED_COLOR);
+		}
+	}
+}
+
+/**
+ * @param compound whether a not without a reference to write through is reported as compound assignment
+ *
+ * @return the binary operator, or NONE for the unary not which has already been applied
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseOperator1(bool compound) -> Operator {
+	auto color = 0;
+	if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS), NONE;
+
+	switch (color) {
+		case RED: return ADD;
+		case YELLOW: return SUBTRACT;
+		case GREEN: return MULTIPLY;
+		case CYAN: return DIVIDE;
+		case BLUE: return MODULO;
+		default: {
+			if (lastRef.array == REF_NONE) fail(compound ? ConstError568::COMPOUND_ASSIGN_TO_VALUE : ConstError568::NEGATE_VALUE);
+			else deref(lastRef) = !lastValue;
+
+			return NONE;
+		}
+	}
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::parseOperator2() -> void {
+	auto color = 0;
+	if (moveUntil(color)) return fail(ConstError568::OUT_OF_BOUNDS);
+
+	switch (color) {
+		case RED: currentOperator = EQUAL; break;
+		case YELLOW: currentOperator = LESS; break;
+		case GREEN: currentOperator = GREATER; break;
+		case CYAN: {
+			if (outputSize == MaxOutput) return fail(ConstError568::OUTPUT_FULL);
+			output[outputSize++] = char(lastValue);
+			break;
+		}
+		case BLUE: currentOperator = ASSIGN; break;
+		case MAGENTA: {
+			auto op = parseOperator1(true);
+			if (op != NONE) currentOperator = static_cast<Operator>(op - ADD + COMPOUND_ADD);
+
+			break;
+		}
+	}
+}
+
+/**
+ * the operator waiting on a value, applied even if the value failed to load like the engine does
+ */
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::applyOperator(Value & current) -> void {
+	switch (currentOperator) {
+		case NONE: return;
+		case ASSIGN: {
+			if (current.reg != -1) {
+				if (lastReg != -1) registers[current.reg] = registers[lastReg];
+				else registers[current.reg].integer = lastValue;
+
+			} else if (current.ref.array != REF_NONE) {
+				deref(current.ref) = lastValue;
+
+			} else {
+				fail(ConstError568::ASSIGN_TO_VALUE);
+			}
+
+			break;
+		}
+		case COMPOUND_ADD:
+		case COMPOUND_SUBTRACT:
+		case COMPOUND_MULTIPLY:
+		case COMPOUND_DIVIDE:
+		case COMPOUND_MODULO: {
+			if (current.ref.array != REF_NONE) {
+				deref(current.ref) = basicOp(currentOperator, lastValue, current.val);
+				current.val = deref(current.ref);
+
+			} else {
+				fail(ConstError568::COMPOUND_ASSIGN_TO_VALUE);
+			}
+
+			break;
+		}
+		default: {
+			current.val = basicOp(currentOperator, lastValue, current.val);
+			break;
+		}
+	}
+
+	currentOperator = NONE;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::execute() -> bool {
+	if (outOfBounds() || error != ConstError568::NONE) return false;
+
+	if (steps == maxSteps) return fail(ConstError568::STEP_LIMIT), false;
+
+	switch (currentColor) {
+		case RED: {
+			auto direction = parseDir();
+			if (direction != -1 && turn(direction)) fail(ConstError568::INVALID_DIRECTION);
+
+			break;
+		}
+		case YELLOW: parseBranch(); break;
+		case GREEN: {
+			auto value = parseVal();
+			applyOperator(value);
+
+			lastValue = value.val;
+			lastRef = value.ref;
+			lastReg = value.reg;
+
+			break;
+		}
+		case CYAN: parseHeap(); break;
+		case BLUE: {
+			auto op = parseOperator1(false);
+			if (op != NONE) currentOperator = op;
+
+			break;
+		}
+		case MAGENTA: parseOperator2(); break;
+	}
+
+	++steps;
+
+	if (error == ConstError568::NONE) moveUntil(currentColor);
+
+	return true;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::pushInt(int value) -> void {
+	registers[registerIndex].integer = value;
+
+	++registerIndex;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::pushArray(std::initializer_list<int> values) -> void {
+	auto & array = arrays[registerIndex];
+	array.size = 0;
+
+	for (auto value : values) array.elements[array.size++] = value;
+
+	registers[registerIndex] = Register { 0, int(registerIndex) };
+
+	++registerIndex;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::run() -> void {
+	lastValue = 0;
+	lastRef = Ref { REF_NONE, 0 };
+	lastReg = -1;
+	steps = 0;
+
+	/* first register enters as number of registers */
+	registers[0].integer = registerIndex - 1;
+
+	/* start in top left corner moving to the right */
+	x = -1;
+	y = 0;
+	dx = 1;
+	dy = 0;
+
+	currentColor = 0;
+	moveUntil(currentColor);
+
+	while (execute());
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getInt(unsigned int index) const -> int {
+	return registers[index].integer;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getArray(unsigned int index) const -> const Array & {
+	return arrays[index];
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getOutput() const -> std::string_view {
+	return std::string_view(output, outputSize);
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getError() const -> ConstError568 {
+	return error;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getSteps() const -> unsigned long long {
+	return steps;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getX() const -> int {
+	return x;
+}
+
+template <unsigned int MaxArray, unsigned int MaxOutput>
+constexpr auto ConstEngine568<MaxArray, MaxOutput>::getY() const -> int {
+	return y;
+}
+
+/* not constexpr, so reaching one during constant evaluation stops the build with the error in its name */
+template <ConstError568 Error>
+inline auto language568ProgramFailed() -> void {}
+
+constexpr auto reportFailure(ConstError568 error) -> void {
+	switch (error) {
+		case ConstError568::NONE: break;
+		case ConstError568::OUT_OF_BOUNDS: language568ProgramFailed<ConstError568::OUT_OF_BOUNDS>(); break;
+		case ConstError568::INVALID_DIRECTION: language568ProgramFailed<ConstError568::INVALID_DIRECTION>(); break;
+		case ConstError568::REGISTER_AFTER_LITERAL: language568ProgramFailed<ConstError568::REGISTER_AFTER_LITERAL>(); break;
+		case ConstError568::ZERO_END: language568ProgramFailed<ConstError568::ZERO_END>(); break;
+		case ConstError568::UNEXPECTED_COLOR: language568ProgramFailed<ConstError568::UNEXPECTED_COLOR>(); break;
+		case ConstError568::NOT_AN_ARRAY: language568ProgramFailed<ConstError568::NOT_AN_ARRAY>(); break;
+		case ConstError568::ARRAY_OUT_OF_BOUNDS: language568ProgramFailed<ConstError568::ARRAY_OUT_OF_BOUNDS>(); break;
+		case ConstError568::NEGATIVE_SIZE: language568ProgramFailed<ConstError568::NEGATIVE_SIZE>(); break;
+		case ConstError568::TOO_MANY_ELEMENTS: language568ProgramFailed<ConstError568::TOO_MANY_ELEMENTS>(); break;
+		case ConstError568::ASSIGN_TO_VALUE: language568ProgramFailed<ConstError568::ASSIGN_TO_VALUE>(); break;
+		case ConstError568::COMPOUND_ASSIGN_TO_VALUE: language568ProgramFailed<ConstError568::COMPOUND_ASSIGN_TO_VALUE>(); break;
+		case ConstError568::NEGATE_VALUE: language568ProgramFailed<ConstError568::NEGATE_VALUE>(); break;
+		case ConstError568::DIVISION_BY_ZERO: language568ProgramFailed<ConstError568::DIVISION_BY_ZERO>(); break;
+		case ConstError568::ARRAY_TOO_LARGE: language568ProgramFailed<ConstError568::ARRAY_TOO_LARGE>(); break;
+		case ConstError568::OUTPUT_FULL: language568ProgramFailed<ConstError568::OUTPUT_FULL>(); break;
+		case ConstError568::STEP_LIMIT: language568ProgramFailed<ConstError568::STEP_LIMIT>(); break;
+	}
+}
+
+/**
+ * runs an embedded program on integer inputs during compilation,
+ * a program that ends in an error fails the build
+ */
+template <unsigned int MaxArray = 256, unsigned int MaxOutput = 256>
+consteval auto evaluate568(EmbeddedProgram568 program, std::initializer_list<int> inputs) -> ConstEngine568<MaxArray, MaxOutput> {
+	auto engine = ConstEngine568<MaxArray, MaxOutput>(program);
+
+	for (auto input : inputs) engine.pushInt(input);
+
+	engine.run();
+
+	reportFailure(engine.getError());
+
+	return engine;
+}
+
+#endif //LANGUAGE568_CONSTEXPR568_H
@@ -4,8 +4,11 @@
 //
 
 #include "engine568.h"
+#include "engine568Run.h"
 
 #include <iostream>
+#include <limits>
+#include <algorithm>
 
 RegisterValue::RegisterValue() : integer(0), array() {}
 
@@ -19,6 +22,8 @@ auto DirReturn::isDirection() -> bool {
 	return !(dx == 0 && dy == 0);
 }
 
+LoadStats::LoadStats() : sourceWidth(0), sourceHeight(0), codelSize(1), width(0), height(0), verified(false), packed(false) {}
+
 OpReturn::OpReturn() : unary(false), basicOp(nullptr) {}
 OpReturn::OpReturn(bool unary, BasicOpFunc && basicOp) : unary(unary), basicOp(basicOp) {}
 
@@ -34,39 +39,88 @@ const char * Engine568::colorNames [6] = {
 Engine568::Engine568() :
 	registerIndex(0),
 	registers(),
-	image(),
+	arrays(),
+	program(),
+	image(nullptr),
+	grid(nullptr),
 	imageWidth(0),
 	imageHeight(0),
+	packGrid(false),
+	loadStats(),
 	x(0),
 	y(0),
 	dx(0),
 	dy(0),
 	lastValue(0),
 	lastRef(nullptr),
-	currentOperator(nullptr),
 	lastReg(nullptr),
-	error("")
+	currentOperator(nullptr),
+	currentColor(0),
+	steps(0),
+	turns(0),
+	stepLimit(~0ull),
+	error(),
+	output(&std::cout),
+	loopKernels(true),
+	loopAt(),
+	loopStats()
 {
 
 }
 
-auto Engine568::load(unsigned int width, unsigned int height, unsigned char * image) -> void {
-	this->imageWidth = width;
-	this->imageHeight = height;
+/**
+ * an engine ready to run a program already loaded elsewhere
+ */
+Engine568::Engine568(std::shared_ptr<const Program568> program) : Engine568() {
+	attach(std::move(program));
+}
+
+/**
+ * loads a program only this engine runs, see Program568 to share one between engines
+ *
+ * @param detectCodels when true, images drawn at a uniform scale
+ * are collapsed down to one pixel per codel, and positions are reported in codels
+ */
+auto Engine568::load(unsigned int width, unsigned int height, unsigned char * image, bool detectCodels) -> void {
+	attach(std::make_shared<const Program568>(width, height, image, detectCodels, packGrid));
+}
+
+/**
+ * switches this engine over to running a program and resets it
+ */
+auto Engine568::attach(std::shared_ptr<const Program568> program) -> void {
+	this->program = std::move(program);
+
+	image = this->program->getPixels();
+	grid = &this->program->getGrid();
+	imageWidth = this->program->getWidth();
+	imageHeight = this->program->getRowsReady();
+	loadStats = this->program->getLoadStats();
 
-	this->image.resize(width * height);
+	loopAt.clear();
+
+	reset();
+}
+
+/**
+ * clears everything a run leaves behind so the engine can take new inputs,
+ * keeping the program and the array storage of the last run
+ */
+auto Engine568::reset() -> void {
+	registers.assign(NUM_REGISTERS, RegisterValue());
 
-	for (auto i = 0u; i < width * height; ++i)
-		this->image[i] = (image[i * 4] << 16u) | (image[i * 4 + 1] << 8u) | image[i * 4 + 2];
+	arrays.resize(NUM_REGISTERS);
+	for (auto & array : arrays) array.clear();
 
-	this->registers.clear();
-	this->registers.resize(NUM_REGISTERS);
+	registerIndex = 1;
+	error.clear();
 
-	this->arrays.clear();
-	this->arrays.resize(NUM_REGISTERS);
+	lastValue = 0;
+	lastRef = nullptr;
+	lastReg = nullptr;
+	currentOperator = nullptr;
 
-	this->registerIndex = 1;
-	this->error = "";
+	loopStats = LoopStats568();
 }
 
 auto Engine568::pushInt(int value) -> void {
@@ -84,35 +138,18 @@ auto Engine568::pushArray(unsigned int length, int * data) -> void {
 	++registerIndex;
 }
 
-auto Engine568::outOfBounds() -> bool {
-	return x < 0 || y < 0 || x >= imageWidth || y >= imageHeight;
-}
-
-auto Engine568::getRGB() -> unsigned int {
-	return image[y * imageWidth + x];
-}
-
-auto Engine568::moveUntil(unsigned int & rgb) -> bool {
-	while (true) {
-		x += dx;
-		y += dy;
-
-		if (outOfBounds()) {
-			return true;
-
-		} else {
-			auto current = getRGB();
-
-			if (current == RED || current == YELLOW || current == GREEN || current == CYAN || current == BLUE || current == MAGENTA) {
-				rgb = current;
-				return false;
-			}
-		}
-	}
+/**
+ * replaces any error with a new one, see ErrorCode568 for which codes take names and values
+ */
+auto Engine568::makeErr(ErrorCode568 code, const char * name, long long first, long long second, const char * otherName) -> void {
+	error.set(code, name, first, second, otherName);
 }
 
-auto Engine568::makeErr(std::string && error) -> void {
-	this->error = error;
+/**
+ * adds the context an error came up through at the cursor
+ */
+auto Engine568::wrapErr(ErrorContext568 context, const char * name, int value) -> void {
+	error.wrap(context, x, y, dx, dy, name, value);
 }
 
 auto Engine568::colorName(unsigned int color) -> const char * {
@@ -120,22 +157,6 @@ auto Engine568::colorName(unsigned int color) -> const char * {
 	return index == -1 ? "unknown" : colorNames[index];
 }
 
-auto Engine568::colorIndex(unsigned int color) -> unsigned int {
-	switch (color) {
-		case RED: return 0;
-		case YELLOW: return 1;
-		case GREEN: return 2;
-		case CYAN: return 3;
-		case BLUE: return 4;
-		case MAGENTA: return 5;
-		default: return -1;
-	}
-}
-
-auto Engine568::hasError() -> bool {
-	return !error.empty();
-}
-
 auto Engine568::assignArray(unsigned int index, unsigned int size) -> std::vector<int> & {
 	auto & reg = registers.at(index);
 	auto & backingArray = arrays.at(index);
@@ -156,6 +177,119 @@ auto Engine568::basicToOp(BasicOpFunc basicOp) -> OpFunc {
 	};
 }
 
+/**
+ * the arithmetic operator for a color, checked as the policy asks
+ */
+template <typename Checks>
+auto Engine568::basicOperator(unsigned int rgb) -> OpReturn {
+	/* widened so the true result can be compared with what fits, or wrapped around */
+	auto arithmetic = [this](long long result) {
+		if constexpr (Checks::INTEGER_OVERFLOW) {
+			if (result < std::numeric_limits<int>::min() || result > std::numeric_limits<int>::max()) makeErr(ErrorCode568::INTEGER_OVERFLOW);
+		}
+
+		return int(static_cast<unsigned int>(result));
+	};
+
+	switch (rgb) {
+		case RED: /* + */
+			return OpReturn(false, [arithmetic](int lastVal, int currentVal) {
+				return arithmetic(static_cast<long long>(lastVal) + currentVal);
+			});
+		case YELLOW: /* - */
+			return OpReturn(false, [arithmetic](int lastVal, int currentVal) {
+				return arithmetic(static_cast<long long>(lastVal) - currentVal);
+			});
+		case GREEN: /* * */
+			return OpReturn(false, [arithmetic](int lastVal, int currentVal) {
+				return arithmetic(static_cast<long long>(lastVal) * currentVal);
+			});
+		case CYAN: /* / */
+			return OpReturn(false, [this, arithmetic](int lastVal, int currentVal) {
+				if constexpr (Checks::DIVISION_BY_ZERO) {
+					if (currentVal == 0) return makeErr(ErrorCode568::DIVISION_BY_ZERO), 0;
+
+					/* the one quotient that does not fit */
+					if (currentVal == -1) return arithmetic(-static_cast<long long>(lastVal));
+				}
+
+				return lastVal / currentVal;
+			});
+		case BLUE: /* % */
+			return OpReturn(false, [this](int lastVal, int currentVal) {
+				if constexpr (Checks::DIVISION_BY_ZERO) {
+					if (currentVal == 0) return makeErr(ErrorCode568::DIVISION_BY_ZERO), 0;
+					if (currentVal == -1) return 0;
+				}
+
+				return lastVal % currentVal;
+			});
+		case MAGENTA: /* ! */
+			return OpReturn(true, [](int lastVal, int currentVal) {
+				return !lastVal;
+			});
+	}
+
+	return OpReturn();
+}
+
+auto Engine568::comparisonOperator(unsigned int rgb) -> BasicOpFunc {
+	switch (rgb) {
+		case RED: /* == */
+			return [](int lastVal, int currentVal) {
+				return lastVal == currentVal;
+			};
+		case YELLOW: /* < */
+			return [](int lastVal, int currentVal) {
+				return lastVal < currentVal;
+			};
+		default: /* > */
+			return [](int lastVal, int currentVal) {
+				return lastVal > currentVal;
+			};
+	}
+}
+
+auto Engine568::assignOperator() -> OpFunc {
+	return [this](int lastVal, int * lastRef, RegisterValue * lastReg, int currentVal, int * currentRef, RegisterValue * currentReg) {
+		/* assignment to register */
+		if (currentReg != nullptr) {
+			/* register array pointer copy */
+			if (lastReg != nullptr) {
+				currentReg->integer = lastReg->integer;
+				currentReg->array = lastReg->array;
+
+			/* value to register assignment */
+			} else {
+				currentReg->integer = lastVal;
+			}
+
+		/* assignment to array element */
+		} else if (currentRef != nullptr) {
+			*currentRef = lastVal;
+
+		/* assignment last operand must be to register or to array element */
+		} else {
+			makeErr(ErrorCode568::ASSIGN_TO_VALUE);
+		}
+
+		return currentVal;
+	};
+}
+
+auto Engine568::compoundOperator(BasicOpFunc basicOp) -> OpFunc {
+	return [basicOp, this](int lastVal, int *lastRef, RegisterValue *lastReg, int currentVal, int *currentRef, RegisterValue *currentReg) {
+		if (currentRef != nullptr) {
+			*currentRef = basicOp(lastVal, currentVal);
+			return *currentRef;
+
+		} else {
+			makeErr(ErrorCode568::COMPOUND_ASSIGN_TO_VALUE);
+			return currentVal;
+		}
+	};
+}
+
 auto Engine568::directionName(int dx, int dy) -> const char * {
 	if (dx < 1)
 		return "left";
@@ -181,388 +315,515 @@ auto Engine568::setDirection(DirReturn & dirReturn) -> bool {
 	} else return true;
 }
 
+/**
+ * the slow side of the bounds check, for a cursor below the rows
+ * of a program that was still being decoded the last time it looked
+ *
+ * @return true once the cursor's row is decoded, false if it really is out of bounds
+ */
+auto Engine568::waitForRow() -> bool {
+	if (x < 0 || y < 0 || x >= imageWidth || imageHeight == program->getHeight() || y >= program->getHeight()) return false;
+
+	imageHeight = program->waitForRows(y + 1);
+
+	return true;
+}
+
 auto Engine568::outOfBoundsError() -> void {
-	makeErr("Out of bounds");
+	makeErr(ErrorCode568::OUT_OF_BOUNDS);
 }
 
-auto Engine568::invalidDirectionError(std::string && base) -> void {
-	makeErr(base + "Invalid direction");
+auto Engine568::invalidDirectionError() -> void {
+	makeErr(ErrorCode568::INVALID_DIRECTION);
 }
 
-auto Engine568::parseDir() -> DirReturn {
-	auto rgb = 0u;
+auto Engine568::invalidDirectionError(ErrorContext568 context) -> void {
+	makeErr(ErrorCode568::INVALID_DIRECTION);
+	wrapErr(context);
+}
 
-	if (moveUntil(rgb)) return outOfBoundsError(), DirReturn();
+auto Engine568::run() -> void {
+	auto observer = NullObserver568();
+	run(observer);
+}
 
-	switch (rgb) {
-		case RED: return DirReturn(1, 0, rgb);
-		case YELLOW: return DirReturn(0, -1, rgb);
-		case GREEN: return DirReturn(-1, 0, rgb);
-		case CYAN: return DirReturn(0, 1, rgb);
-		default: return DirReturn(0, 0, rgb);
-	}
+auto Engine568::start() -> void {
+	auto observer = NullObserver568();
+	start(observer);
 }
 
-auto Engine568::parseBranch() -> void {
-	auto dirReturn = parseDir();
+auto Engine568::step() -> bool {
+	auto observer = NullObserver568();
+	return step(observer);
+}
 
-	/* for blue, a switch statement */
-	if (dirReturn.color == BLUE) {
-		auto inSwitch = true;
+/**
+ * the interpreter's operator for a decoded one, for handing a loop back to it mid iteration
+ */
+template <typename Checks>
+auto Engine568::loopOperator(LoopOperator op) -> OpFunc {
+	/* the color each operator is written with after its blue, magenta or magenta magenta */
+	constexpr static unsigned int colors [] = {
+		0, RED, YELLOW, GREEN, CYAN, BLUE, RED, YELLOW, GREEN, BLUE, RED, YELLOW, GREEN, CYAN, BLUE
+	};
 
-		while (inSwitch) {
-			auto rgb = 0u;
-			if (moveUntil(rgb)) return makeErr("While parsing switch: " + error);
+	auto color = colors[int(op)];
 
-			switch (rgb) {
-				/* can change direction mid switch statement */
-				case RED: {
-					dirReturn = parseDir();
-					if (setDirection(dirReturn)) invalidDirectionError("While parsing switch: ");
+	if (op == LoopOperator::NONE) return nullptr;
+	else if (op <= LoopOperator::MODULO) return basicToOp(basicOperator<Checks>(color).basicOp);
+	else if (op <= LoopOperator::GREATER) return basicToOp(comparisonOperator(color));
+	else if (op == LoopOperator::ASSIGN) return assignOperator();
+	else return compoundOperator(basicOperator<Checks>(color).basicOp);
+}
 
-					break;
-				}
-				/* value, followed by a direction is a case */
-				case GREEN: {
-					auto [val, ref, reg] = parseVal();
-					if (hasError()) return makeErr("while parsing switch case: " + error);
-
-					auto dirReturn = parseDir();
-					if (hasError()) return makeErr("while parsing switch case direction: " + error);
-					if (!dirReturn.isDirection()) return invalidDirectionError("while parsing switch case direction: ");
-
-					/* change direction on switch case equality */
-					/* exit out of switch */
-					if (val == lastValue) {
-						setDirection(dirReturn);
-						inSwitch = false;
-					}
+/**
+ * applies a waiting operator to a loaded value the way the interpreter would
+ *
+ * @return false without changing anything if the interpreter would fail or trap,
+ * leaving it to the interpreter to do so
+ */
+template <typename Checks>
+auto Engine568::applyLoopOperator(LoopOperator op, int & val, int * ref, RegisterValue * reg) -> bool {
+	auto arithmetic = op;
+	if (op >= LoopOperator::COMPOUND_ADD) arithmetic = LoopOperator(int(op) - int(LoopOperator::COMPOUND_ADD) + int(LoopOperator::ADD));
+
+	auto result = 0;
+	auto wide = 0ll;
+
+	switch (arithmetic) {
+		case LoopOperator::ADD: wide = static_cast<long long>(lastValue) + val; break;
+		case LoopOperator::SUBTRACT: wide = static_cast<long long>(lastValue) - val; break;
+		case LoopOperator::MULTIPLY: wide = static_cast<long long>(lastValue) * val; break;
+		case LoopOperator::DIVIDE:
+		case LoopOperator::MODULO: {
+			if (val == 0 || (val == -1 && lastValue == std::numeric_limits<int>::min())) return false;
+			result = arithmetic == LoopOperator::DIVIDE ? lastValue / val : lastValue % val;
+			break;
+		}
+		case LoopOperator::EQUAL: result = lastValue == val; break;
+		case LoopOperator::LESS: result = lastValue < val; break;
+		case LoopOperator::GREATER: result = lastValue > val; break;
+		case LoopOperator::ASSIGN: {
+			if (reg != nullptr) {
+				if (lastReg != nullptr) {
+					reg->integer = lastReg->integer;
+					reg->array = lastReg->array;
 
-					break;
+				} else {
+					reg->integer = lastValue;
 				}
-				/* default for switch statements */
-				case CYAN: {
-					auto dirReturn = parseDir();
-					if (setDirection(dirReturn)) invalidDirectionError("while parsing switch default case: ");
 
-					/* exit out of switch */
-					inSwitch = false;
-					break;
-				}
-				/* switch statement ends */
-				case BLUE: {
-					inSwitch = false;
-					break;
-				}
-				default: return makeErr(std::string("Unexpected ") + colorName(rgb) + " while parsing switch");
+			} else if (ref != nullptr) {
+				*ref = lastValue;
+
+			} else {
+				return false;
 			}
+
+			return true;
 		}
+		default: return true;
+	}
 
-	/* for normal directions, just an if statement */
-	} else if (dirReturn.isDirection()) {
-		if (lastValue) setDirection(dirReturn);
+	if (arithmetic <= LoopOperator::MULTIPLY) {
+		if constexpr (Checks::INTEGER_OVERFLOW) {
+			if (wide < std::numeric_limits<int>::min() || wide > std::numeric_limits<int>::max()) return false;
+		}
 
-	} else {
-		invalidDirectionError("While parsing switch: ");
+		result = int(static_cast<unsigned int>(wide));
 	}
-}
-
-auto Engine568::parseVal() -> ValReturn {
-	auto value = 1;
-	auto rgb = 0u;
 
-	while (true) {
-		if(moveUntil(rgb)) return outOfBoundsError(), ValReturn();
+	if (op >= LoopOperator::COMPOUND_ADD) {
+		if (ref == nullptr) return false;
+		*ref = result;
+	}
 
-		switch(rgb) {
-			case RED: { /* register */
-				if (value != 1) return makeErr("Trying to call register value after literal signifier"), ValReturn();
-				if(moveUntil(rgb)) return outOfBoundsError(), ValReturn();
+	val = result;
+	return true;
+}
 
-				auto index = colorIndex(rgb);
+/**
+ * runs the loop at the yellow branch under the cursor without fetching or decoding anything
+ *
+ * leaves the engine on the branch once the loop is over for the interpreter to leave through,
+ * or on an instruction that is about to fail so the interpreter fails on it exactly as it would have
+ */
+template <typename Checks>
+auto Engine568::runLoop() -> void {
+	auto direction = dx > 0 ? 0 : dy < 0 ? 1 : dx < 0 ? 2 : 3;
+	auto [entry, unseen] = loopAt.try_emplace((static_cast<unsigned long long>(y) * imageWidth + x) * 4 + direction, nullptr);
+
+	if (unseen) {
+		entry->second = program->findLoop(x, y, dx, dy);
+		if (entry->second != nullptr) ++loopStats.loops;
+	}
 
-				return ValReturn(registers[index].integer, &registers[index].integer, registers.data() + index);
-			}
-			case YELLOW: {
-				if (value != 1) return makeErr("Trying to call dereferenced value after literal signifier"), ValReturn();
-				if(moveUntil(rgb)) return outOfBoundsError(), ValReturn();
+	if (entry->second == nullptr || currentOperator != nullptr) return;
 
-				auto index = colorIndex(rgb);
+	auto & loop = *entry->second;
+	auto counted = loop.counted;
+	auto pending = LoopOperator::NONE;
 
-				auto & reg = registers.at(index);
+	++loopStats.entries;
 
-				if (reg.array == nullptr) return makeErr(std::string("Register ") + colorNames[index] + " does not point to an array"), ValReturn();
-				if (reg.integer >= reg.array->size()) return makeErr(std::string("Trying to access array ") + colorNames[index] + " out of bounds (" + std::to_string(reg.integer) + " out of " + std::to_string(reg.array->size()) + ")"), ValReturn();
-				return ValReturn((*reg.array)[reg.integer], reg.array->data() + reg.integer, nullptr);
-			}
-			case GREEN: { /* 1 */
-				value <<= 1;
-				value += 1;
-				break;
-			}
-			case CYAN: { /* 0 */
-				value <<= 1;
-				break;
-			}
-			case BLUE: { /* END */
-				return ValReturn(value, nullptr, nullptr);
-			}
-			case MAGENTA: { /* END 0 */
-				if (value == 1)
-					return ValReturn(0, nullptr, nullptr);
-				else
-					return makeErr("Unexpected zero end for nonzero value"), ValReturn();
-			}
+	while ((lastValue != 0) == loop.whenTaken && steps < stepLimit) {
+		/* as many whole iterations as can be done at once, the rest go op by op */
+		if (counted) {
+			counted = false;
+			if (runCountedLoop<Checks>(loop)) continue;
 		}
-	}
-}
 
-auto Engine568::parseHeap() -> void {
-	/* next color is the register we are allocating to */
-	auto rgb = 0u;
-	if (moveUntil(rgb)) return outOfBoundsError();
+		/* the branch */
+		++steps;
 
-	auto registerIndex = colorIndex(rgb);
+		for (auto & op : loop.ops) {
+			/* out of steps, stopped on this op so the interpreter stops on it exactly as it would have */
+			auto fail = steps >= stepLimit;
 
-	/* next color block is a value, the size of the heap block we are allocating */
-	auto [arraySize, ref, reg_unused] = parseVal();
-	if (hasError()) return makeErr(std::string("While parsing array size for register ") + colorNames[registerIndex] + ": " + error);
-	if (arraySize < 0) return makeErr(std::string("Trying to allocate array of negative size (") + std::to_string(arraySize) + ") for register " + colorNames[registerIndex]);
+			if (!fail) switch (op.kind) {
+				case LoopOpKind::TURN: break;
+				case LoopOpKind::OPERATOR: pending = op.op; break;
+				case LoopOpKind::PRINT: *output << char(lastValue); break;
+				case LoopOpKind::NOT:
+				case LoopOpKind::COMPOUND_NOT: {
+					if (lastRef == nullptr) fail = true;
+					else *lastRef = !lastValue;
 
-	/* allocate */
-	auto & reg = registers.at(registerIndex);
-	auto & backingArray = assignArray(registerIndex, arraySize);
-	/* 0 out array */
-	for (auto i = 0; i < backingArray.size(); ++i) backingArray[i] = 0;
-
-	/* initialize memory */
-	for (auto element = 0;;) {
-		if (moveUntil(rgb)) return outOfBoundsError();
+					break;
+				}
+				default: {
+					auto val = op.value;
+					int * ref = nullptr;
+					RegisterValue * reg = nullptr;
+
+					if (op.kind == LoopOpKind::REGISTER) {
+						reg = registers.data() + op.value;
+						ref = &reg->integer;
+						val = reg->integer;
+
+					} else if (op.kind == LoopOpKind::ELEMENT) {
+						auto & source = registers[op.value];
+
+						if (source.array == nullptr || static_cast<std::size_t>(source.integer) >= source.array->size()) {
+							fail = true;
+							break;
+						}
+
+						ref = source.array->data() + source.integer;
+						val = *ref;
+					}
 
-		switch (rgb) {
-			case RED: {
-				auto dirReturn = parseDir();
-				if (setDirection(dirReturn)) return invalidDirectionError("While initializing array elements for register: ");
+					if (pending != LoopOperator::NONE && !applyLoopOperator<Checks>(pending, val, ref, reg)) {
+						fail = true;
+						break;
+					}
 
-				break;
+					lastValue = val;
+					lastRef = ref;
+					lastReg = reg;
+					pending = LoopOperator::NONE;
+					break;
+				}
 			}
-			case GREEN: {
-				if (element == arraySize) return makeErr("Trying to initialize more array elements than array size (" + std::to_string(arraySize) + ") for register " + colorNames[registerIndex]);
 
-				auto [elementVal, elementRef, r_unused2] = parseVal();
-				if (hasError()) return makeErr("While parsing array initializer value " + std::to_string(element + 1) + " for register " + colorNames[registerIndex] + ": " + error);
-
-				backingArray[element] = elementVal;
-				++element;
-				break;
-			}
-			case CYAN: {
+			if (fail) {
+				x = op.x;
+				y = op.y;
+				dx = op.dx;
+				dy = op.dy;
+				currentColor = op.color;
+				currentOperator = loopOperator<Checks>(pending);
 				return;
 			}
-			default: {
-				return makeErr(std::string("Unexpected ") + colorName(rgb) + " while allocating elements for " + colorNames[registerIndex]);
-			}
+
+			++steps;
 		}
+
+		++loopStats.iterations;
 	}
 }
 
-auto Engine568::parseOperator1() -> OpReturn {
-	auto rgb = 0u;
-	if (moveUntil(rgb)) return outOfBoundsError(), OpReturn();
-
-	switch (rgb) {
-		case RED: /* + */
-			return OpReturn(false, [](int lastVal, int currentVal) {
-				return lastVal + currentVal;
-			});
-		case YELLOW: /* - */
-			return OpReturn(false, [](int lastVal, int currentVal) {
-				return lastVal - currentVal;
-			});
-		case GREEN: /* * */
-			return OpReturn(false, [](int lastVal, int currentVal) {
-				return lastVal * currentVal;
-			});
-		case CYAN: /* / */
-			return OpReturn(false, [](int lastVal, int currentVal) {
-				return lastVal / currentVal;
-			});
-		case BLUE: /* % */
-			return OpReturn(false, [](int lastVal, int currentVal) {
-				return lastVal % currentVal;
-			});
-		case MAGENTA: /* ! */
-			return OpReturn(true, [](int lastVal, int currentVal) {
-				return !lastVal;
-			});
+/**
+ * runs the iterations of a counted loop that cannot fail, each idiom as one loop over its arrays
+ *
+ * @return false if none were run, when an access fails straight away,
+ * a register would overflow, or arrays the loop writes to are shared,
+ * and for sums where overflow is checked as the interpreter fails partway through them
+ */
+template <typename Checks>
+auto Engine568::runCountedLoop(const Loop568 & loop) -> bool {
+	if constexpr (Checks::INTEGER_OVERFLOW) {
+		for (auto & statement : loop.statements) if (statement.idiom == LoopIdiom::REDUCE) return false;
 	}
 
-	return OpReturn();
-}
+	long long step [NUM_REGISTERS] = {};
 
-auto Engine568::parseOperator2() -> void {
-	auto rgb = 0u;
-	if (moveUntil(rgb)) return outOfBoundsError();
+	for (auto & statement : loop.statements)
+		if (statement.idiom == LoopIdiom::INDUCTION) step[statement.target] = statement.value;
 
-	switch (rgb) {
-		case RED: /* == */
-			currentOperator = basicToOp([](int lastVal, int currentVal) {
-				return lastVal == currentVal;
-			});
-			break;
-		case YELLOW: /* < */
-			currentOperator = basicToOp([](int lastVal, int currentVal) {
-				return lastVal < currentVal;
-			});
-			break;
-		case GREEN: /* > */
-			currentOperator = basicToOp([](int lastVal, int currentVal) {
-				return lastVal > currentVal;
-			});
-			break;
-		case CYAN: /* print */
-			std::cout << char(lastValue);
-			break;
-		case BLUE: /* assignment */ {
-			currentOperator = [this](int lastVal, int * lastRef, RegisterValue * lastReg, int currentVal, int * currentRef, RegisterValue * currentReg) {
-				/* assignment to register */
-				if (currentReg != nullptr) {
-					/* register array pointer copy */
-					if (lastReg != nullptr) {
-						currentReg->integer = lastReg->integer;
-						currentReg->array = lastReg->array;
-
-					/* value to register assignment */
-					} else {
-						currentReg->integer = lastVal;
-					}
+	long long counter = registers[loop.counter].integer;
+	long long bound = loop.boundLiteral ? loop.bound : registers[loop.bound].integer;
+	auto counterStep = step[loop.counter];
 
-				/* assignment to array element */
-				} else if (currentRef != nullptr) {
-					*currentRef = lastVal;
+	/* the branch already chose the first iteration, after that the counter decides at the end of each */
+	auto iterations = counter + counterStep >= bound ? 1ll : (bound - counter + counterStep - 1) / counterStep;
 
-				/* assignment last operand must be to register or to array element */
-				} else {
-					makeErr("Trying to assign to value");
-				}
+	/* no further than the step limit allows whole iterations, runLoop takes it op by op from there */
+	auto allowed = (stepLimit - steps) / (loop.ops.size() + 1);
+	if (static_cast<unsigned long long>(iterations) > allowed) iterations = static_cast<long long>(allowed);
 
-				return currentVal;
-			};
-			break;
-		}
-		case MAGENTA: /* compound assignment */ {
-			auto [unary, basicOp] = parseOperator1();
-			if (hasError()) return makeErr("While parsing compound assignment operator: " + error);
+	for (auto i = 0; i < NUM_REGISTERS; ++i) {
+		auto last = registers[i].integer + iterations * step[i];
+		if (last < std::numeric_limits<int>::min() || last > std::numeric_limits<int>::max()) return false;
+	}
 
-			if (unary) {
-				if (lastRef != nullptr)
-					*lastRef = basicOp(lastValue, 0);
-				else
-					makeErr("Trying to compound assign to value");
+	/* where an idiom starts in the array its register points to, after any step earlier in the iteration */
+	bool stepped [NUM_REGISTERS] = {};
 
-			} else {
-				auto captureBasicOp = basicOp;
-
-				currentOperator = [captureBasicOp, this](int lastVal, int *lastRef, RegisterValue *lastReg, int currentVal, int *currentRef, RegisterValue *currentReg) {
-					if (currentRef != nullptr) {
-						*currentRef = captureBasicOp(lastVal, currentVal);
-						return *currentRef;
+	auto start = [&](int index) {
+		return registers[index].integer + (stepped[index] ? step[index] : 0ll);
+	};
 
-					} else {
-						makeErr("Trying to compound assign to value");
-						return currentVal;
-					}
-				};
-			}
+	/* stop short of the first iteration with an access out of bounds */
+	auto limit = [&](int index) {
+		auto * array = registers[index].array;
 
-			break;
+		if (array == nullptr) {
+			iterations = 0;
+			return;
 		}
-	}
-}
 
-auto Engine568::run() -> void {
-	lastValue = 0;
-	lastRef = nullptr;
-	lastReg = nullptr;
-
-	/* first register enters as number of registers */
-	registers[0].integer = registerIndex - 1;
+		auto first = start(index);
+		auto size = static_cast<long long>(array->size());
+		auto inBounds = iterations;
 
-	/* start in top left corner moving to the right */
-	x = -1;
-	y = 0;
-	dx = 1;
-	dy = 0;
+		if (first < 0 || first >= size) inBounds = 0;
+		else if (step[index] > 0) inBounds = (size - first + step[index] - 1) / step[index];
+		else if (step[index] < 0) inBounds = first / -step[index] + 1;
 
-	auto rgb = 0u;
-	moveUntil(rgb);
+		iterations = std::min(iterations, inBounds);
+	};
 
-	while (!outOfBounds() && !hasError()) {
-		switch (rgb) {
-			case RED: {
-				auto dirReturn = parseDir();
-				if (setDirection(dirReturn)) invalidDirectionError("");
+	auto arrays = std::vector<std::pair<std::vector<int> *, bool>>();
 
+	for (auto & statement : loop.statements) {
+		switch (statement.idiom) {
+			case LoopIdiom::INDUCTION: stepped[statement.target] = true; break;
+			case LoopIdiom::FILL: {
+				limit(statement.target);
+				arrays.emplace_back(registers[statement.target].array, true);
+				break;
+			}
+			case LoopIdiom::COPY: {
+				limit(statement.source);
+				limit(statement.target);
+				arrays.emplace_back(registers[statement.source].array, false);
+				arrays.emplace_back(registers[statement.target].array, true);
 				break;
 			}
-			case YELLOW:
-				parseBranch();
+			case LoopIdiom::REDUCE: {
+				limit(statement.source);
+				arrays.emplace_back(registers[statement.source].array, false);
 				break;
-			case GREEN: {
-				auto [val, ref, reg] = parseVal();
+			}
+		}
+	}
 
-				if (currentOperator != nullptr) {
-					val = currentOperator(lastValue, lastRef, lastReg, val, ref, reg);
-					currentOperator = nullptr;
-				}
+	if (iterations == 0) return false;
 
-				lastValue = val;
-				lastRef = ref;
-				lastReg = reg;
+	/* each idiom runs on its own, so none may see another's writes */
+	for (auto i = 0u; i < arrays.size(); ++i)
+		for (auto j = i + 1; j < arrays.size(); ++j)
+			if (arrays[i].first == arrays[j].first && (arrays[i].second || arrays[j].second)) return false;
 
+	for (auto & index : stepped) index = false;
+
+	for (auto & statement : loop.statements) {
+		switch (statement.idiom) {
+			case LoopIdiom::INDUCTION: {
+				stepped[statement.target] = true;
 				break;
 			}
-			case CYAN:
-				parseHeap();
+			case LoopIdiom::FILL: {
+				auto * target = registers[statement.target].array->data() + start(statement.target);
+				auto targetStep = step[statement.target];
+				auto value = statement.literal ? statement.value : registers[statement.source].integer;
+
+				if (targetStep == 1) std::fill_n(target, iterations, value);
+				else for (auto t = 0ll; t < iterations; ++t) target[t * targetStep] = value;
+
 				break;
-			case BLUE: {
-				auto [unary, op] = parseOperator1();
+			}
+			case LoopIdiom::COPY: {
+				auto * source = registers[statement.source].array->data() + start(statement.source);
+				auto * target = registers[statement.target].array->data() + start(statement.target);
+				auto sourceStep = step[statement.source], targetStep = step[statement.target];
 
-				if (unary) *lastRef = op(lastValue, 0);
-				else currentOperator = basicToOp(op);
+				if (sourceStep == 1 && targetStep == 1) std::copy_n(source, iterations, target);
+				else for (auto t = 0ll; t < iterations; ++t) target[t * targetStep] = source[t * sourceStep];
 
 				break;
 			}
-			case MAGENTA:
-				parseOperator2();
+			case LoopIdiom::REDUCE: {
+				auto * source = registers[statement.source].array->data() + start(statement.source);
+				auto sourceStep = step[statement.source];
+
+				/* wraps the same as adding one at a time */
+				auto sum = unsigned(registers[statement.target].integer);
+
+				if (sourceStep == 1) for (auto t = 0ll; t < iterations; ++t) sum += unsigned(source[t]);
+				else for (auto t = 0ll; t < iterations; ++t) sum += unsigned(source[t * sourceStep]);
+
+				registers[statement.target].integer = int(sum);
 				break;
+			}
 		}
-
-		if (!hasError()) moveUntil(rgb);
 	}
+
+	for (auto i = 0; i < NUM_REGISTERS; ++i) registers[i].integer += int(iterations * step[i]);
+
+	/* left as the last statement, counter < bound, leaves it */
+	lastValue = registers[loop.counter].integer < bound;
+	lastRef = loop.boundLiteral ? nullptr : &registers[loop.bound].integer;
+	lastReg = loop.boundLiteral ? nullptr : registers.data() + loop.bound;
+
+	steps += iterations * (loop.ops.size() + 1);
+	loopStats.iterations += iterations;
+	loopStats.bulkIterations += iterations;
+
+	return true;
+}
+
+auto Engine568::setLoopKernels(bool enabled) -> void {
+	loopKernels = enabled;
+}
+
+/**
+ * stops runs that have not ended after this many instructions with an error,
+ * on the same instruction whether loops are run by kernels or not
+ *
+ * turns taken inside switches and arrays are held to it too, counted apart from instructions,
+ * as those can go around forever without an instruction ending
+ *
+ * @param limit 0 for no limit
+ */
+auto Engine568::setStepLimit(unsigned long long limit) -> void {
+	stepLimit = limit == 0 ? ~0ull : limit;
+}
+
+/**
+ * @param enabled when true, the next load keeps the image as a 3 bit per pixel grid
+ */
+auto Engine568::setPackedGrid(bool enabled) -> void {
+	packGrid = enabled;
+}
+
+/**
+ * @param output where the program prints to instead of standard out, kept across loads
+ */
+auto Engine568::setOutput(std::ostream & output) -> void {
+	this->output = &output;
 }
 
+auto Engine568::getLoopStats() -> LoopStats568 & {
+	return loopStats;
+}
+
+template auto Engine568::run<NullObserver568, FullChecks568>(NullObserver568 &) -> void;
+template auto Engine568::run<NullObserver568, DefaultChecks568>(NullObserver568 &) -> void;
+template auto Engine568::run<NullObserver568, NoChecks568>(NullObserver568 &) -> void;
+template auto Engine568::run(ProfileObserver568 &) -> void;
+
+/* for runs in other translation units */
+template auto Engine568::basicOperator<FullChecks568>(unsigned int) -> OpReturn;
+template auto Engine568::basicOperator<DefaultChecks568>(unsigned int) -> OpReturn;
+template auto Engine568::basicOperator<NoChecks568>(unsigned int) -> OpReturn;
+template auto Engine568::runLoop<FullChecks568>() -> void;
+template auto Engine568::runLoop<DefaultChecks568>() -> void;
+template auto Engine568::runLoop<NoChecks568>() -> void;
+
 auto Engine568::getInt(unsigned int index) -> int {
 	return registers[index].integer;
 }
 
+auto Engine568::getRegister(unsigned int index) -> RegisterValue & {
+	return registers.at(index);
+}
+
+/**
+ * @return how many values have been pushed into the engine since loading
+ */
+auto Engine568::getNumInputs() -> unsigned int {
+	return registerIndex - 1;
+}
+
 auto Engine568::getArray(unsigned int index) -> std::vector<int> & {
 	return arrays.at(index);
 }
 
 auto Engine568::getError() -> std::string {
-	if (error.empty()) {
+	if (!error.isSet()) {
 		return "";
 
 	} else {
-		auto ret = std::string("ERROR | x: ") + std::to_string(x) + " y: " + std::to_string(y) + " d: " + directionName(dx, dy);
+		return formatError(x, y, dx, dy, outOfBounds() ? nullptr : colorName(getRGB()), error.render());
+	}
+}
+
+/**
+ * @return the error as recorded, without rendering its message
+ */
+auto Engine568::getErrorInfo() -> const EngineError568 & {
+	return error;
+}
+
+/**
+ * the text getError reports, shared with programs compiled ahead of time
+ *
+ * @param color name of the color under the error, or null if it was out of bounds
+ */
+auto Engine568::formatError(int x, int y, int dx, int dy, const char * color, const std::string & error) -> std::string {
+	auto ret = std::string("ERROR | x: ") + std::to_string(x) + " y: " + std::to_string(y) + " d: " + directionName(dx, dy);
 
-		if (!outOfBounds()) ret += std::string(" c: ") + colorName(getRGB());
+	if (color != nullptr) ret += std::string(" c: ") + color;
 
-		ret += " | " + error;
+	ret += " | " + error;
 
-		return ret;
-	}
+	return ret;
+}
+
+auto Engine568::getProgram() -> const std::shared_ptr<const Program568> & {
+	return program;
+}
+
+/**
+ * @return the program as loaded, one 0xRRGGBB color per codel,
+ * unpacked from the grid with filler turned white if the engine loaded packed
+ */
+auto Engine568::getImage() -> const ProgramImage568 & {
+	return program->getImage();
+}
+
+auto Engine568::getLoadStats() -> LoadStats & {
+	return loadStats;
+}
+
+/**
+ * @return why the program could not be verified at load time
+ */
+auto Engine568::getVerifyErrors() -> const std::vector<VerifyError> & {
+	return program->getVerifyErrors();
+}
+
+auto Engine568::getSteps() -> unsigned long long {
+	return steps;
+}
+
+/**
+ * @return 0 if there is none
+ */
+auto Engine568::getStepLimit() -> unsigned long long {
+	return stepLimit == ~0ull ? 0 : stepLimit;
 }
 
 auto Engine568::getX() -> int {
@@ -572,3 +833,18 @@ auto Engine568::getX() -> int {
 auto Engine568::getY() -> int {
 	return y;
 }
+
+auto Engine568::getDX() -> int {
+	return dx;
+}
+
+auto Engine568::getDY() -> int {
+	return dy;
+}
+
+/**
+ * @return the color of the instruction about to be executed
+ */
+auto Engine568::getColor() -> unsigned int {
+	return currentColor;
+}
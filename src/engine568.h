@@ -9,52 +9,21 @@
 #include <vector>
 #include <string>
 #include <functional>
-
-class RegisterValue {
-public:
-	RegisterValue();
-
-	int integer;
-	std::vector<int> * array;
-};
-
-class ValReturn {
-public:
-	ValReturn();
-	ValReturn(int, int *, RegisterValue *);
-
-	int val;
-	int * ref;
-	RegisterValue * reg;
-};
-
-class DirReturn {
-public:
-	DirReturn();
-	DirReturn(int, int, unsigned int);
-
-	auto isDirection() -> bool;
-
-	int dx, dy;
-	unsigned int color;
-};
-
-using BasicOpFunc = std::function<int(int, int)>;
-using OpFunc = std::function<int(int, int *, RegisterValue *, int, int *, RegisterValue *)>;
-
-class OpReturn {
-public:
-	OpReturn();
-	OpReturn(bool, BasicOpFunc &&);
-
-	bool unary;
-	BasicOpFunc basicOp;
-};
+#include <unordered_map>
+#include <memory>
+#include <ostream>
+
+#include "engine568Types.h"
+#include "engine568Observer.h"
+#include "checks568.h"
+#include "engineError568.h"
+#include "program568.h"
+#include "verifier568.h"
+#include "loops568.h"
+#include "packedGrid568.h"
 
 class Engine568 {
-private:
-	constexpr static int NUM_REGISTERS = 6;
-
+public:
 	constexpr static unsigned int RED = 0xFF0000;
 	constexpr static unsigned int YELLOW = 0xFFFF00;
 	constexpr static unsigned int GREEN = 0x00FF00;
@@ -62,15 +31,27 @@ private:
 	constexpr static unsigned int BLUE = 0x0000FF;
 	constexpr static unsigned int MAGENTA = 0xFF00FF;
 
+private:
+	constexpr static int NUM_REGISTERS = 6;
+
 	static const char * colorNames [];
 
 	unsigned int registerIndex;
 	std::vector<RegisterValue> registers;
 	std::vector<std::vector<int>> arrays;
 
-	std::vector<unsigned int> image;
+	/* the program being run, shared with any other engines running it, and what fetching reads of it */
+	std::shared_ptr<const Program568> program;
+	const unsigned int * image;
+	const PackedGrid568 * grid;
+	/* the height is only as far as the program was decoded when last looked at */
 	unsigned int imageWidth, imageHeight;
 
+	bool packGrid;
+
+	/* this engine's copy, so one run can be made to take the checked path */
+	LoadStats loadStats;
+
 	int x, y;
 	int dx, dy;
 	int lastValue;
@@ -79,47 +60,127 @@ private:
 
 	OpFunc currentOperator;
 
-	std::string error;
+	unsigned int currentColor;
+	unsigned long long steps;
+	/* turns taken inside a switch or an array's elements, which can go around forever within one instruction */
+	unsigned long long turns;
+	/* the most of either, as high as it goes for none */
+	unsigned long long stepLimit;
+
+	/* rendered into text only when getError asks */
+	EngineError568 error;
+
+	std::ostream * output;
+
+	bool loopKernels;
+	/* the program's loop at each branch position and direction looked at so far, null for none */
+	std::unordered_map<unsigned long long, const Loop568 *> loopAt;
+	LoopStats568 loopStats;
 
 	auto outOfBounds() -> bool;
+	auto waitForRow() -> bool;
 	auto getRGB() -> unsigned int;
-	auto moveUntil(unsigned int &) -> bool;
-	auto makeErr(std::string &&) -> void;
+	template <typename Observer>
+	auto moveUntil(unsigned int &, Observer &) -> bool;
+	template <typename Observer, bool Verified>
+	auto nextOperand(unsigned int &, Observer &) -> bool;
+	auto makeErr(ErrorCode568, const char * = nullptr, long long = 0, long long = 0, const char * = nullptr) -> void;
+	auto wrapErr(ErrorContext568, const char * = nullptr, int = 0) -> void;
 	auto colorName(unsigned int) -> const char *;
 	auto colorIndex(unsigned int) -> unsigned int;
 	auto hasError() -> bool;
 	auto assignArray(unsigned int, unsigned int) -> std::vector<int> &;
 	auto basicToOp(BasicOpFunc) -> OpFunc;
-	auto directionName(int, int) -> const char *;
+	template <typename Checks>
+	auto basicOperator(unsigned int) -> OpReturn;
+	static auto comparisonOperator(unsigned int) -> BasicOpFunc;
+	auto assignOperator() -> OpFunc;
+	auto compoundOperator(BasicOpFunc) -> OpFunc;
+	static auto directionName(int, int) -> const char *;
 	auto setDirection(DirReturn &) -> bool;
 
 	auto outOfBoundsError() -> void;
-	auto invalidDirectionError(std::string &&) -> void;
-
-	auto parseDir() -> DirReturn;
-	auto parseBranch() -> void;
-	auto parseVal() -> ValReturn;
-	auto parseHeap() -> void;
-	auto parseOperator1() -> OpReturn;
-	auto parseOperator2() -> void;
+	auto invalidDirectionError() -> void;
+	auto invalidDirectionError(ErrorContext568) -> void;
+
+	template <typename Observer, bool Verified>
+	auto parseDir(Observer &) -> DirReturn;
+	template <typename Observer, bool Verified, typename Checks>
+	auto parseBranch(Observer &) -> void;
+	template <typename Observer, bool Verified, typename Checks>
+	auto parseVal(Observer &) -> ValReturn;
+	template <typename Observer, bool Verified, typename Checks>
+	auto parseHeap(Observer &) -> void;
+	template <typename Observer, bool Verified, typename Checks>
+	auto parseOperator1(Observer &) -> OpReturn;
+	template <typename Observer, bool Verified, typename Checks>
+	auto parseOperator2(Observer &) -> void;
+	template <typename Observer, bool Verified, typename Checks>
+	auto execute(Observer &) -> bool;
+
+	template <typename Checks>
+	auto loopOperator(LoopOperator) -> OpFunc;
+	template <typename Checks>
+	auto applyLoopOperator(LoopOperator, int &, int *, RegisterValue *) -> bool;
+	template <typename Checks>
+	auto runLoop() -> void;
+	template <typename Checks>
+	auto runCountedLoop(const Loop568 &) -> bool;
 
 public:
+	/* choices reported to observers when a switch statement exits */
+	constexpr static int SWITCH_END = 0;
+	constexpr static int SWITCH_DEFAULT = 1;
+	constexpr static int SWITCH_CASE = 2;
+
 	Engine568();
+	explicit Engine568(std::shared_ptr<const Program568>);
 
-	auto load(unsigned int, unsigned int, unsigned char *) -> void;
+	auto load(unsigned int, unsigned int, unsigned char *, bool = true) -> void;
+	auto attach(std::shared_ptr<const Program568>) -> void;
+	auto reset() -> void;
 
 	auto pushInt(int) -> void;
 	auto pushArray(unsigned int, int *) -> void;
 
 	auto run() -> void;
+	auto start() -> void;
+	auto step() -> bool;
+
+	/* observed runs with a choice of checks, see engine568Run.h and checks568.h */
+	template <typename Observer, typename Checks = DefaultChecks568>
+	auto run(Observer &) -> void;
+	template <typename Observer>
+	auto start(Observer &) -> void;
+	template <typename Observer, typename Checks = DefaultChecks568>
+	auto step(Observer &) -> bool;
 
 	auto getInt(unsigned int) -> int;
+	auto getRegister(unsigned int) -> RegisterValue &;
+	auto getNumInputs() -> unsigned int;
 	auto getArray(unsigned int) -> std::vector<int> &;
 
 	auto getError() -> std::string;
+	auto getErrorInfo() -> const EngineError568 &;
+	static auto formatError(int, int, int, int, const char *, const std::string &) -> std::string;
+	auto getProgram() -> const std::shared_ptr<const Program568> &;
+	auto getImage() -> const ProgramImage568 &;
+	auto getLoadStats() -> LoadStats &;
+	auto getVerifyErrors() -> const std::vector<VerifyError> &;
+	auto getSteps() -> unsigned long long;
+	auto getStepLimit() -> unsigned long long;
+
+	auto setLoopKernels(bool) -> void;
+	auto setStepLimit(unsigned long long) -> void;
+	auto setPackedGrid(bool) -> void;
+	auto setOutput(std::ostream &) -> void;
+	auto getLoopStats() -> LoopStats568 &;
 
 	auto getX() -> int;
 	auto getY() -> int;
+	auto getDX() -> int;
+	auto getDY() -> int;
+	auto getColor() -> unsigned int;
 };
 
 #endif //LANGUAGE568_ENGINE568_H
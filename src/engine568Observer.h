@@ -0,0 +1,72 @@
+
+#ifndef LANGUAGE568_ENGINE568OBSERVER_H
+#define LANGUAGE568_ENGINE568OBSERVER_H
+
+class Engine568;
+
+/**
+ * the default observer policy, every hook is empty so an observed run
+ * compiles down to the same code as an unobserved one
+ *
+ * other observers provide the same set of hooks, they are resolved at compile time
+ */
+class NullObserver568 {
+public:
+	inline auto onStart(Engine568 &) -> void {}
+	inline auto onFetch(Engine568 &, unsigned int) -> void {}
+	inline auto onInstruction(Engine568 &, unsigned int) -> void {}
+	inline auto onBranch(Engine568 &, bool) -> void {}
+	inline auto onSwitch(Engine568 &, int) -> void {}
+	inline auto onAlloc(Engine568 &, unsigned int, int) -> void {}
+	inline auto onPrint(Engine568 &, char) -> void {}
+	inline auto onError(Engine568 &) -> void {}
+	inline auto onEnd(Engine568 &) -> void {}
+};
+
+/**
+ * counts what a run spent its time on
+ */
+class ProfileObserver568 : public NullObserver568 {
+public:
+	unsigned long long fetches = 0;
+	unsigned long long instructions [6] = {};
+	unsigned long long branchesTaken = 0, branchesNotTaken = 0;
+	unsigned long long switches = 0;
+	unsigned long long allocations = 0, allocatedElements = 0;
+	unsigned long long printed = 0;
+
+	inline auto onFetch(Engine568 &, unsigned int) -> void {
+		++fetches;
+	}
+
+	inline auto onInstruction(Engine568 &, unsigned int color) -> void {
+		switch (color) {
+			case 0xFF0000: ++instructions[0]; break;
+			case 0xFFFF00: ++instructions[1]; break;
+			case 0x00FF00: ++instructions[2]; break;
+			case 0x00FFFF: ++instructions[3]; break;
+			case 0x0000FF: ++instructions[4]; break;
+			case 0xFF00FF: ++instructions[5]; break;
+		}
+	}
+
+	inline auto onBranch(Engine568 &, bool taken) -> void {
+		if (taken) ++branchesTaken;
+		else ++branchesNotTaken;
+	}
+
+	inline auto onSwitch(Engine568 &, int) -> void {
+		++switches;
+	}
+
+	inline auto onAlloc(Engine568 &, unsigned int, int size) -> void {
+		++allocations;
+		allocatedElements += size;
+	}
+
+	inline auto onPrint(Engine568 &, char) -> void {
+		++printed;
+	}
+};
+
+#endif //LANGUAGE568_ENGINE568OBSERVER_H
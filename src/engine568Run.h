@@ -0,0 +1,472 @@
+
+#ifndef LANGUAGE568_ENGINE568RUN_H
+#define LANGUAGE568_ENGINE568RUN_H
+
+/*
+ * definitions of the engine's observer templated hot loop,
+ * include this to run an engine with an observer the engine library does not already instantiate
+ */
+
+#include <iostream>
+#include <type_traits>
+
+#include "engine568.h"
+
+/* hot helpers, inline so every observer's instantiation can fold them in */
+
+inline auto Engine568::outOfBounds() -> bool {
+	return (x < 0 || y < 0 || x >= imageWidth || y >= imageHeight) && !waitForRow();
+}
+
+inline auto Engine568::getRGB() -> unsigned int {
+	if (loadStats.packed) return grid->rgb(x, y);
+
+	return image[y * imageWidth + x];
+}
+
+inline auto Engine568::hasError() -> bool {
+	return error.isSet();
+}
+
+inline auto Engine568::colorIndex(unsigned int color) -> unsigned int {
+	switch (color) {
+		case RED: return 0;
+		case YELLOW: return 1;
+		case GREEN: return 2;
+		case CYAN: return 3;
+		case BLUE: return 4;
+		case MAGENTA: return 5;
+		default: return -1;
+	}
+}
+
+template <typename Observer>
+auto Engine568::moveUntil(unsigned int & rgb, Observer & observer) -> bool {
+	if (loadStats.packed) {
+		auto current = grid->next(x, y, dx, dy);
+		if (current == 0) return true;
+
+		observer.onFetch(*this, current);
+
+		rgb = current;
+		return false;
+	}
+
+	while (true) {
+		x += dx;
+		y += dy;
+
+		if (outOfBounds()) {
+			return true;
+
+		} else {
+			auto current = getRGB();
+
+			if (current == RED || current == YELLOW || current == GREEN || current == CYAN || current == BLUE || current == MAGENTA) {
+				observer.onFetch(*this, current);
+
+				rgb = current;
+				return false;
+			}
+		}
+	}
+}
+
+/**
+ * moves onto the next operand of the instruction being parsed,
+ * verified programs always have one so the bounds checks can go
+ */
+template <typename Observer, bool Verified>
+auto Engine568::nextOperand(unsigned int & rgb, Observer & observer) -> bool {
+	if constexpr (Verified) {
+		if (loadStats.packed) {
+			rgb = grid->next(x, y, dx, dy);
+
+		} else {
+			do {
+				x += dx;
+				y += dy;
+				rgb = image[y * imageWidth + x];
+			} while (!(rgb == RED || rgb == YELLOW || rgb == GREEN || rgb == CYAN || rgb == BLUE || rgb == MAGENTA));
+		}
+
+		observer.onFetch(*this, rgb);
+		return false;
+
+	} else {
+		return moveUntil(rgb, observer);
+	}
+}
+
+template <typename Observer, bool Verified>
+auto Engine568::parseDir(Observer & observer) -> DirReturn {
+	auto rgb = 0u;
+
+	if (nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError(), DirReturn();
+
+	switch (rgb) {
+		case RED: return DirReturn(1, 0, rgb);
+		case YELLOW: return DirReturn(0, -1, rgb);
+		case GREEN: return DirReturn(-1, 0, rgb);
+		case CYAN: return DirReturn(0, 1, rgb);
+		default: return DirReturn(0, 0, rgb);
+	}
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::parseBranch(Observer & observer) -> void {
+	auto dirReturn = parseDir<Observer, Verified>(observer);
+
+	/* for blue, a switch statement */
+	if (dirReturn.color == BLUE) {
+		auto inSwitch = true;
+		auto caseIndex = 0;
+
+		while (inSwitch) {
+			auto rgb = 0u;
+			if (nextOperand<Observer, Verified>(rgb, observer)) return wrapErr(ErrorContext568::SWITCH);
+
+			switch (rgb) {
+				/* can change direction mid switch statement */
+				case RED: {
+					if (++turns >= stepLimit) return makeErr(ErrorCode568::STEP_LIMIT, nullptr, stepLimit);
+
+					dirReturn = parseDir<Observer, Verified>(observer);
+					if (setDirection(dirReturn)) invalidDirectionError(ErrorContext568::SWITCH);
+
+					break;
+				}
+				/* value, followed by a direction is a case */
+				case GREEN: {
+					auto [val, ref, reg] = parseVal<Observer, Verified, Checks>(observer);
+					if (hasError()) return wrapErr(ErrorContext568::SWITCH_CASE);
+
+					auto dirReturn = parseDir<Observer, Verified>(observer);
+					if (hasError()) return wrapErr(ErrorContext568::SWITCH_CASE_DIRECTION);
+					if (!dirReturn.isDirection()) return invalidDirectionError(ErrorContext568::SWITCH_CASE_DIRECTION);
+
+					/* change direction on switch case equality */
+					/* exit out of switch */
+					if (val == lastValue) {
+						setDirection(dirReturn);
+						inSwitch = false;
+
+						observer.onSwitch(*this, SWITCH_CASE + caseIndex);
+					}
+
+					++caseIndex;
+					break;
+				}
+				/* default for switch statements */
+				case CYAN: {
+					auto dirReturn = parseDir<Observer, Verified>(observer);
+					if (setDirection(dirReturn)) invalidDirectionError(ErrorContext568::SWITCH_DEFAULT);
+
+					/* exit out of switch */
+					inSwitch = false;
+
+					observer.onSwitch(*this, SWITCH_DEFAULT);
+					break;
+				}
+				/* switch statement ends */
+				case BLUE: {
+					inSwitch = false;
+
+					observer.onSwitch(*this, SWITCH_END);
+					break;
+				}
+				default: return makeErr(ErrorCode568::UNEXPECTED_IN_SWITCH, colorName(rgb));
+			}
+		}
+
+	/* for normal directions, just an if statement */
+	} else if (dirReturn.isDirection()) {
+		if (lastValue) setDirection(dirReturn);
+
+		observer.onBranch(*this, lastValue != 0);
+
+	} else {
+		invalidDirectionError(ErrorContext568::SWITCH);
+	}
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::parseVal(Observer & observer) -> ValReturn {
+	auto value = 1;
+	auto rgb = 0u;
+
+	while (true) {
+		if(nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError(), ValReturn();
+
+		switch(rgb) {
+			case RED: { /* register */
+				if (!Verified && value != 1) return makeErr(ErrorCode568::REGISTER_AFTER_LITERAL), ValReturn();
+				if(nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError(), ValReturn();
+
+				auto index = colorIndex(rgb);
+
+				return ValReturn(registers[index].integer, &registers[index].integer, registers.data() + index);
+			}
+			case YELLOW: {
+				if (!Verified && value != 1) return makeErr(ErrorCode568::DEREFERENCE_AFTER_LITERAL), ValReturn();
+				if(nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError(), ValReturn();
+
+				auto index = colorIndex(rgb);
+
+				auto & reg = Verified ? registers[index] : registers.at(index);
+
+				if constexpr (Checks::BOUNDS) {
+					if (reg.array == nullptr) return makeErr(ErrorCode568::NOT_AN_ARRAY, colorNames[index]), ValReturn();
+					if (reg.integer >= reg.array->size()) return makeErr(ErrorCode568::ARRAY_OUT_OF_BOUNDS, colorNames[index], reg.integer, static_cast<long long>(reg.array->size())), ValReturn();
+				}
+
+				return ValReturn((*reg.array)[reg.integer], reg.array->data() + reg.integer, nullptr);
+			}
+			case GREEN: { /* 1 */
+				value <<= 1;
+				value += 1;
+				break;
+			}
+			case CYAN: { /* 0 */
+				value <<= 1;
+				break;
+			}
+			case BLUE: { /* END */
+				return ValReturn(value, nullptr, nullptr);
+			}
+			case MAGENTA: { /* END 0 */
+				if (Verified || value == 1)
+					return ValReturn(0, nullptr, nullptr);
+				else
+					return makeErr(ErrorCode568::UNEXPECTED_ZERO_END), ValReturn();
+			}
+		}
+	}
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::parseHeap(Observer & observer) -> void {
+	/* next color is the register we are allocating to */
+	auto rgb = 0u;
+	if (nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError();
+
+	auto registerIndex = colorIndex(rgb);
+
+	/* next color block is a value, the size of the heap block we are allocating */
+	auto [arraySize, ref, reg_unused] = parseVal<Observer, Verified, Checks>(observer);
+	if (hasError()) return wrapErr(ErrorContext568::ARRAY_SIZE, colorNames[registerIndex]);
+	if constexpr (Checks::NEGATIVE_SIZE) if (arraySize < 0) return makeErr(ErrorCode568::NEGATIVE_ARRAY_SIZE, colorNames[registerIndex], arraySize);
+
+	/* allocate */
+	auto & backingArray = assignArray(registerIndex, arraySize);
+
+	observer.onAlloc(*this, registerIndex, arraySize);
+	/* 0 out array */
+	for (auto i = 0; i < backingArray.size(); ++i) backingArray[i] = 0;
+
+	/* initialize memory */
+	for (auto element = 0;;) {
+		if (nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError();
+
+		switch (rgb) {
+			case RED: {
+				if (++turns >= stepLimit) return makeErr(ErrorCode568::STEP_LIMIT, nullptr, stepLimit);
+
+				auto dirReturn = parseDir<Observer, Verified>(observer);
+				if (setDirection(dirReturn)) return invalidDirectionError(ErrorContext568::ARRAY_ELEMENTS);
+
+				break;
+			}
+			case GREEN: {
+				if (element == arraySize) return makeErr(ErrorCode568::TOO_MANY_ELEMENTS, colorNames[registerIndex], arraySize);
+
+				auto [elementVal, elementRef, r_unused2] = parseVal<Observer, Verified, Checks>(observer);
+				if (hasError()) return wrapErr(ErrorContext568::ARRAY_ELEMENT, colorNames[registerIndex], element + 1);
+
+				backingArray[element] = elementVal;
+				++element;
+				break;
+			}
+			case CYAN: {
+				return;
+			}
+			default: {
+				return makeErr(ErrorCode568::UNEXPECTED_IN_ELEMENTS, colorName(rgb), 0, 0, colorNames[registerIndex]);
+			}
+		}
+	}
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::parseOperator1(Observer & observer) -> OpReturn {
+	auto rgb = 0u;
+	if (nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError(), OpReturn();
+
+	return basicOperator<Checks>(rgb);
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::parseOperator2(Observer & observer) -> void {
+	auto rgb = 0u;
+	if (nextOperand<Observer, Verified>(rgb, observer)) return outOfBoundsError();
+
+	switch (rgb) {
+		case RED: /* == */
+		case YELLOW: /* < */
+		case GREEN: /* > */
+			currentOperator = basicToOp(comparisonOperator(rgb));
+			break;
+		case CYAN: /* print */
+			observer.onPrint(*this, char(lastValue));
+			*output << char(lastValue);
+			break;
+		case BLUE: /* assignment */
+			currentOperator = assignOperator();
+			break;
+		case MAGENTA: /* compound assignment */ {
+			auto [unary, basicOp] = parseOperator1<Observer, Verified, Checks>(observer);
+			if (hasError()) return wrapErr(ErrorContext568::COMPOUND_OPERATOR);
+
+			if (unary) {
+				if (lastRef != nullptr)
+					*lastRef = basicOp(lastValue, 0);
+				else
+					makeErr(ErrorCode568::COMPOUND_ASSIGN_TO_VALUE);
+
+			} else {
+				currentOperator = compoundOperator(basicOp);
+			}
+
+			break;
+		}
+	}
+}
+
+template <typename Observer, typename Checks>
+auto Engine568::run(Observer & observer) -> void {
+	start(observer);
+
+	/* loop kernels run whole iterations without calling any hooks, so only unobserved runs use them */
+	if constexpr (std::is_same_v<Observer, NullObserver568>) {
+		if (loadStats.verified && loopKernels) {
+			do {
+				if (currentColor == YELLOW && !outOfBounds() && !hasError()) runLoop<Checks>();
+			} while (execute<Observer, true, Checks>(observer));
+
+			return;
+		}
+	}
+
+	if (loadStats.verified) while (execute<Observer, true, Checks>(observer));
+	else while (execute<Observer, false, Checks>(observer));
+}
+
+/**
+ * resets execution state and moves onto the first instruction
+ */
+template <typename Observer>
+auto Engine568::start(Observer & observer) -> void {
+	lastValue = 0;
+	lastRef = nullptr;
+	lastReg = nullptr;
+	steps = 0;
+	turns = 0;
+
+	/* first register enters as number of registers */
+	registers[0].integer = registerIndex - 1;
+
+	observer.onStart(*this);
+
+	/* start in top left corner moving to the right */
+	x = -1;
+	y = 0;
+	dx = 1;
+	dy = 0;
+
+	currentColor = 0u;
+	moveUntil(currentColor, observer);
+}
+
+/**
+ * executes the instruction under the current position
+ *
+ * @return false once execution has ended
+ */
+template <typename Observer, typename Checks>
+auto Engine568::step(Observer & observer) -> bool {
+	if (loadStats.verified) return execute<Observer, true, Checks>(observer);
+	else return execute<Observer, false, Checks>(observer);
+}
+
+template <typename Observer, bool Verified, typename Checks>
+auto Engine568::execute(Observer & observer) -> bool {
+	if (outOfBounds() || hasError()) {
+		if (hasError()) observer.onError(*this);
+		observer.onEnd(*this);
+
+		return false;
+	}
+
+	if (steps >= stepLimit) {
+		makeErr(ErrorCode568::STEP_LIMIT, nullptr, stepLimit);
+		observer.onError(*this);
+		observer.onEnd(*this);
+
+		return false;
+	}
+
+	observer.onInstruction(*this, currentColor);
+
+	switch (currentColor) {
+		case RED: {
+			auto dirReturn = parseDir<Observer, Verified>(observer);
+			if (setDirection(dirReturn)) invalidDirectionError();
+
+			break;
+		}
+		case YELLOW:
+			parseBranch<Observer, Verified, Checks>(observer);
+			break;
+		case GREEN: {
+			auto [val, ref, reg] = parseVal<Observer, Verified, Checks>(observer);
+
+			if (currentOperator != nullptr) {
+				val = currentOperator(lastValue, lastRef, lastReg, val, ref, reg);
+				currentOperator = nullptr;
+			}
+
+			lastValue = val;
+			lastRef = ref;
+			lastReg = reg;
+
+			break;
+		}
+		case CYAN:
+			parseHeap<Observer, Verified, Checks>(observer);
+			break;
+		case BLUE: {
+			auto [unary, op] = parseOperator1<Observer, Verified, Checks>(observer);
+
+			if (unary) {
+				if (Checks::BOUNDS && lastRef == nullptr) makeErr(ErrorCode568::NEGATE_VALUE);
+				else *lastRef = op(lastValue, 0);
+
+			} else {
+				currentOperator = basicToOp(op);
+			}
+
+			break;
+		}
+		case MAGENTA:
+			parseOperator2<Observer, Verified, Checks>(observer);
+			break;
+	}
+
+	++steps;
+
+	if (!hasError()) moveUntil(currentColor, observer);
+
+	return true;
+}
+
+#endif //LANGUAGE568_ENGINE568RUN_H
@@ -0,0 +1,68 @@
+
+#ifndef LANGUAGE568_ENGINE568TYPES_H
+#define LANGUAGE568_ENGINE568TYPES_H
+
+/*
+ * small value types shared by programs and the engines running them
+ */
+
+#include <vector>
+#include <functional>
+
+class RegisterValue {
+public:
+	RegisterValue();
+
+	int integer;
+	std::vector<int> * array;
+};
+
+class ValReturn {
+public:
+	ValReturn();
+	ValReturn(int, int *, RegisterValue *);
+
+	int val;
+	int * ref;
+	RegisterValue * reg;
+};
+
+class DirReturn {
+public:
+	DirReturn();
+	DirReturn(int, int, unsigned int);
+
+	auto isDirection() -> bool;
+
+	int dx, dy;
+	unsigned int color;
+};
+
+using BasicOpFunc = std::function<int(int, int)>;
+using OpFunc = std::function<int(int, int *, RegisterValue *, int, int *, RegisterValue *)>;
+
+class OpReturn {
+public:
+	OpReturn();
+	OpReturn(bool, BasicOpFunc &&);
+
+	bool unary;
+	BasicOpFunc basicOp;
+};
+
+class LoadStats {
+public:
+	LoadStats();
+
+	unsigned int sourceWidth, sourceHeight;
+	unsigned int codelSize;
+	unsigned int width, height;
+
+	/* every reachable instruction parses, so the engine can skip those checks */
+	bool verified;
+
+	/* the image is held as a packed grid instead */
+	bool packed;
+};
+
+#endif //LANGUAGE568_ENGINE568TYPES_H
@@ -0,0 +1,125 @@
+#include "engineError568.h"
+
+EngineError568::EngineError568() :
+	code(ErrorCode568::NONE),
+	names(),
+	values(),
+	numFrames(0),
+	frames() {}
+
+auto EngineError568::clear() -> void {
+	code = ErrorCode568::NONE;
+	numFrames = 0;
+}
+
+/**
+ * replaces whatever error there was, context and all
+ *
+ * @param name the register or color the message names, see ErrorCode568 for which
+ * @param otherName the register, for the one code that names two
+ */
+auto EngineError568::set(ErrorCode568 code, const char * name, long long first, long long second, const char * otherName) -> void {
+	this->code = code;
+	names[0] = name;
+	names[1] = otherName;
+	values[0] = first;
+	values[1] = second;
+	numFrames = 0;
+}
+
+/**
+ * adds the context an error came up through, setting an undescribed one if there was none yet
+ */
+auto EngineError568::wrap(ErrorContext568 context, int x, int y, int dx, int dy, const char * name, int value) -> void {
+	if (code == ErrorCode568::NONE) set(ErrorCode568::UNDESCRIBED);
+
+	/* instructions do not nest, so one frame is as deep as the engine goes */
+	if (numFrames == MAX_FRAMES) return;
+
+	frames[numFrames++] = ErrorFrame568 { context, x, y, dx, dy, name, value };
+}
+
+static auto appendContext(std::string & message, const ErrorFrame568 & frame) -> void {
+	switch (frame.context) {
+		case ErrorContext568::SWITCH: message += "While parsing switch: "; break;
+		case ErrorContext568::SWITCH_CASE: message += "while parsing switch case: "; break;
+		case ErrorContext568::SWITCH_CASE_DIRECTION: message += "while parsing switch case direction: "; break;
+		case ErrorContext568::SWITCH_DEFAULT: message += "while parsing switch default case: "; break;
+		case ErrorContext568::ARRAY_SIZE: {
+			message += "While parsing array size for register ";
+			message += frame.name;
+			message += ": ";
+			break;
+		}
+		case ErrorContext568::ARRAY_ELEMENTS: message += "While initializing array elements for register: "; break;
+		case ErrorContext568::ARRAY_ELEMENT: {
+			message += "While parsing array initializer value " + std::to_string(frame.value) + " for register ";
+			message += frame.name;
+			message += ": ";
+			break;
+		}
+		case ErrorContext568::COMPOUND_OPERATOR: message += "While parsing compound assignment operator: "; break;
+	}
+}
+
+/**
+ * @return the message the engine reports, outermost context first, empty if there is no error
+ */
+auto EngineError568::render() const -> std::string {
+	auto message = std::string();
+
+	for (auto i = numFrames; i > 0; --i) appendContext(message, frames[i - 1]);
+
+	switch (code) {
+		case ErrorCode568::NONE: break;
+		case ErrorCode568::UNDESCRIBED: break;
+		case ErrorCode568::OUT_OF_BOUNDS: message += "Out of bounds"; break;
+		case ErrorCode568::INVALID_DIRECTION: message += "Invalid direction"; break;
+		case ErrorCode568::INTEGER_OVERFLOW: message += "Integer overflow"; break;
+		case ErrorCode568::DIVISION_BY_ZERO: message += "Division by zero"; break;
+		case ErrorCode568::ASSIGN_TO_VALUE: message += "Trying to assign to value"; break;
+		case ErrorCode568::COMPOUND_ASSIGN_TO_VALUE: message += "Trying to compound assign to value"; break;
+		case ErrorCode568::NEGATE_VALUE: message += "Trying to negate value"; break;
+		case ErrorCode568::REGISTER_AFTER_LITERAL: message += "Trying to call register value after literal signifier"; break;
+		case ErrorCode568::DEREFERENCE_AFTER_LITERAL: message += "Trying to call dereferenced value after literal signifier"; break;
+		case ErrorCode568::NOT_AN_ARRAY: {
+			message += "Register ";
+			message += names[0];
+			message += " does not point to an array";
+			break;
+		}
+		case ErrorCode568::ARRAY_OUT_OF_BOUNDS: {
+			message += "Trying to access array ";
+			message += names[0];
+			message += " out of bounds (" + std::to_string(values[0]) + " out of " + std::to_string(values[1]) + ")";
+			break;
+		}
+		case ErrorCode568::UNEXPECTED_ZERO_END: message += "Unexpected zero end for nonzero value"; break;
+		case ErrorCode568::NEGATIVE_ARRAY_SIZE: {
+			message += "Trying to allocate array of negative size (" + std::to_string(values[0]) + ") for register ";
+			message += names[0];
+			break;
+		}
+		case ErrorCode568::TOO_MANY_ELEMENTS: {
+			message += "Trying to initialize more array elements than array size (" + std::to_string(values[0]) + ") for register ";
+			message += names[0];
+			break;
+		}
+		case ErrorCode568::UNEXPECTED_IN_SWITCH: {
+			message += "Unexpected ";
+			message += names[0];
+			message += " while parsing switch";
+			break;
+		}
+		case ErrorCode568::UNEXPECTED_IN_ELEMENTS: {
+			message += "Unexpected ";
+			message += names[0];
+			message += " while allocating elements for ";
+			message += names[1];
+			break;
+		}
+		case ErrorCode568::STEP_LIMIT: message += "Ran out of steps (" + std::to_string(values[0]) + ")"; break;
+	}
+
+	return message;
+}
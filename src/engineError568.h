@@ -0,0 +1,94 @@
+#ifndef LANGUAGE568_ENGINEERROR568_H
+#define LANGUAGE568_ENGINEERROR568_H
+
+#include <string>
+
+/* what went wrong, each one's message is in engineError568.cpp */
+enum class ErrorCode568 : unsigned char {
+	NONE,
+	/* nothing but the context it was raised in, as when a switch runs out of the image */
+	UNDESCRIBED,
+	OUT_OF_BOUNDS,
+	INVALID_DIRECTION,
+	INTEGER_OVERFLOW,
+	DIVISION_BY_ZERO,
+	ASSIGN_TO_VALUE,
+	COMPOUND_ASSIGN_TO_VALUE,
+	NEGATE_VALUE,
+	REGISTER_AFTER_LITERAL,
+	DEREFERENCE_AFTER_LITERAL,
+	/* register name */
+	NOT_AN_ARRAY,
+	/* register name, index, size */
+	ARRAY_OUT_OF_BOUNDS,
+	UNEXPECTED_ZERO_END,
+	/* register name, size */
+	NEGATIVE_ARRAY_SIZE,
+	/* register name, size */
+	TOO_MANY_ELEMENTS,
+	/* color name */
+	UNEXPECTED_IN_SWITCH,
+	/* color name, then register name */
+	UNEXPECTED_IN_ELEMENTS,
+	/* the limit */
+	STEP_LIMIT,
+};
+
+/* what the engine was parsing when an error came up from inside it */
+enum class ErrorContext568 : unsigned char {
+	SWITCH,
+	SWITCH_CASE,
+	SWITCH_CASE_DIRECTION,
+	SWITCH_DEFAULT,
+	/* register name */
+	ARRAY_SIZE,
+	ARRAY_ELEMENTS,
+	/* register name, which element counting from 1 */
+	ARRAY_ELEMENT,
+	COMPOUND_OPERATOR,
+};
+
+class ErrorFrame568 {
+public:
+	ErrorContext568 context;
+
+	/* where the cursor was when the error passed through */
+	int x, y;
+	int dx, dy;
+
+	const char * name;
+	int value;
+};
+
+/**
+ * an engine error kept as a code, the context frames it was raised through and their payloads,
+ * names are the engine's static color names, so recording one never allocates
+ *
+ * the message is only put together when render is called, reading the same as when it was built up as it went
+ */
+class EngineError568 {
+public:
+	constexpr static unsigned int MAX_FRAMES = 4;
+
+	EngineError568();
+
+	ErrorCode568 code;
+	const char * names [2];
+	long long values [2];
+
+	/* innermost first */
+	unsigned int numFrames;
+	ErrorFrame568 frames [MAX_FRAMES];
+
+	inline auto isSet() const -> bool {
+		return code != ErrorCode568::NONE;
+	}
+
+	auto clear() -> void;
+	auto set(ErrorCode568, const char * = nullptr, long long = 0, long long = 0, const char * = nullptr) -> void;
+	auto wrap(ErrorContext568, int, int, int, int, const char * = nullptr, int = 0) -> void;
+
+	auto render() const -> std::string;
+};
+
+#endif //LANGUAGE568_ENGINEERROR568_H
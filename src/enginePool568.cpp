@@ -0,0 +1,57 @@
+
+#include "enginePool568.h"
+
+EnginePool568::EnginePool568(std::shared_ptr<const Program568> program) :
+	program(std::move(program)),
+	mutex(),
+	idle(),
+	created(0)
+{
+
+}
+
+/**
+ * @return an engine reset and ready for inputs, an idle one if there is any
+ */
+auto EnginePool568::acquire() -> std::unique_ptr<Engine568> {
+	{
+		auto lock = std::lock_guard(mutex);
+
+		if (!idle.empty()) {
+			auto engine = std::move(idle.back());
+			idle.pop_back();
+
+			return engine;
+		}
+
+		++created;
+	}
+
+	return std::make_unique<Engine568>(program);
+}
+
+/**
+ * takes an engine back, resetting it before it is handed out again
+ */
+auto EnginePool568::release(std::unique_ptr<Engine568> engine) -> void {
+	/* only engines running this pool's program belong in it */
+	if (engine == nullptr || engine->getProgram() != program) return;
+
+	engine->reset();
+
+	auto lock = std::lock_guard(mutex);
+	idle.push_back(std::move(engine));
+}
+
+auto EnginePool568::getProgram() -> const std::shared_ptr<const Program568> & {
+	return program;
+}
+
+/**
+ * @return how many engines the pool has had to make, at most one per thread using it at once
+ */
+auto EnginePool568::getCreated() -> unsigned long long {
+	auto lock = std::lock_guard(mutex);
+
+	return created;
+}
@@ -0,0 +1,36 @@
+
+#ifndef LANGUAGE568_ENGINEPOOL568_H
+#define LANGUAGE568_ENGINEPOOL568_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "engine568.h"
+
+/**
+ * engines for one program kept around between runs,
+ * so a server handing out a run per request reuses their registers and array storage
+ *
+ * engines can be taken and given back from any thread
+ */
+class EnginePool568 {
+private:
+	std::shared_ptr<const Program568> program;
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<Engine568>> idle;
+
+	unsigned long long created;
+
+public:
+	explicit EnginePool568(std::shared_ptr<const Program568>);
+
+	auto acquire() -> std::unique_ptr<Engine568>;
+	auto release(std::unique_ptr<Engine568>) -> void;
+
+	auto getProgram() -> const std::shared_ptr<const Program568> &;
+	auto getCreated() -> unsigned long long;
+};
+
+#endif //LANGUAGE568_ENGINEPOOL568_H
@@ -0,0 +1,75 @@
+
+#include "hugePages568.h"
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static auto enabled = std::atomic<bool>(true);
+
+auto HugePages568::setEnabled(bool on) -> void {
+	enabled = on;
+}
+
+auto HugePages568::isEnabled() -> bool {
+	return enabled;
+}
+
+/**
+ * maps more than asked for and trims it down to start on a huge page,
+ * since the kernel only backs whole aligned huge pages
+ */
+auto HugePages568::mapTransparent(std::size_t bytes, bool huge) -> void * {
+#ifdef __linux__
+	auto * mapped = mmap(nullptr, bytes + SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapped == MAP_FAILED) throw std::bad_alloc();
+
+	auto start = reinterpret_cast<std::uintptr_t>(mapped);
+	auto aligned = (start + SIZE - 1) & ~(SIZE - 1);
+
+	if (aligned != start) munmap(mapped, aligned - start);
+	munmap(reinterpret_cast<void *>(aligned + bytes), start + SIZE - aligned);
+
+	/* only a hint, a kernel without transparent huge pages still hands out small ones */
+	madvise(reinterpret_cast<void *>(aligned), bytes, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+
+	return reinterpret_cast<void *>(aligned);
+#else
+	return nullptr;
+#endif
+}
+
+/**
+ * @return memory for bytes, untouched so the first thread to write it decides which node it lives on
+ */
+auto HugePages568::allocate(std::size_t bytes) -> void * {
+#ifdef __linux__
+	if (bytes < SIZE) return ::operator new(bytes);
+
+	auto rounded = (bytes + SIZE - 1) & ~(SIZE - 1);
+
+	if (enabled) {
+		/* fails straight away unless huge pages were reserved up front */
+		auto * mapped = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (mapped != MAP_FAILED) return mapped;
+	}
+
+	return mapTransparent(rounded, enabled);
+#else
+	return ::operator new(bytes);
+#endif
+}
+
+auto HugePages568::deallocate(void * pointer, std::size_t bytes) -> void {
+#ifdef __linux__
+	if (bytes < SIZE) return ::operator delete(pointer);
+
+	munmap(pointer, (bytes + SIZE - 1) & ~(SIZE - 1));
+#else
+	::operator delete(pointer);
+#endif
+}
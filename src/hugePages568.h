@@ -0,0 +1,58 @@
+
+#ifndef LANGUAGE568_HUGEPAGES568_H
+#define LANGUAGE568_HUGEPAGES568_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * memory for program storage backed by huge pages where the system has them,
+ * so walking down a column of a large program does not miss the TLB on every row
+ *
+ * anything of a huge page or more is mapped on its own, from the explicit huge page pool if one is reserved,
+ * otherwise aligned to huge pages and marked for transparent huge pages,
+ * smaller blocks and everything off linux come from new
+ */
+class HugePages568 {
+private:
+	static auto mapTransparent(std::size_t, bool) -> void *;
+
+public:
+	constexpr static std::size_t SIZE = std::size_t(2) << 20u;
+
+	static auto allocate(std::size_t) -> void *;
+	static auto deallocate(void *, std::size_t) -> void;
+
+	/* on by default, off still maps large blocks on their own but asks for small pages, to compare against */
+	static auto setEnabled(bool) -> void;
+	static auto isEnabled() -> bool;
+};
+
+template <typename T>
+class HugePageAllocator568 {
+public:
+	using value_type = T;
+
+	HugePageAllocator568() = default;
+
+	template <typename U>
+	HugePageAllocator568(const HugePageAllocator568<U> &) {}
+
+	auto allocate(std::size_t count) -> T * {
+		return static_cast<T *>(HugePages568::allocate(count * sizeof(T)));
+	}
+
+	auto deallocate(T * pointer, std::size_t count) -> void {
+		HugePages568::deallocate(pointer, count * sizeof(T));
+	}
+
+	template <typename U>
+	auto operator==(const HugePageAllocator568<U> &) const -> bool {
+		return true;
+	}
+};
+
+/* one 0xRRGGBB color per codel */
+using ProgramImage568 = std::vector<unsigned int, HugePageAllocator568<unsigned int>>;
+
+#endif //LANGUAGE568_HUGEPAGES568_H
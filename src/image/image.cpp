@@ -1,14 +1,14 @@
 
 #include <iostream>
+#include <fstream>
 #include <stdio.h>
 #include <memory>
 #include <setjmp.h>
 
 #include "image.h"
 
-#include "libpng16/png.h"
-
 #include "imageUtil.h"
+#include "pngReader.h"
 
 namespace CNGE {
 	Image::Image(): pixels(nullptr) {}
@@ -34,67 +34,42 @@ namespace CNGE {
 	}
 
 	auto Image::fromPNG(const char *filepath) -> std::unique_ptr<Image> {
-		auto* file = static_cast<FILE*>(nullptr);
-
-		/* open the file of the image */
-		fopen_s(&file, filepath, "rb");
+		return decode(PNGReader::open(filepath));
+	}
 
-		if (!file) return nullptr;
+	/**
+	 * @param data a whole png in memory, only read while decoding
+	 */
+	auto Image::fromPNG(const u8* data, u64 size) -> std::unique_ptr<Image> {
+		return decode(PNGReader::open(data, size));
+	}
 
-		auto* png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-		auto* info = png_create_info_struct(png);
+	/**
+	 * @param fd a png file open for reading, mapped rather than read in and left open
+	 */
+	auto Image::fromPNGDescriptor(int fd) -> std::unique_ptr<Image> {
+		return decode(PNGReader::open(fd));
+	}
 
-		png_init_io(png, file);
-		png_read_info(png, info);
+	/**
+	 * reads every row of a png straight into a new image
+	 *
+	 * @return nullptr if the reader could not be opened or the image data is broken
+	 */
+	auto Image::decode(std::unique_ptr<PNGReader>&& reader) -> std::unique_ptr<Image> {
+		if (!reader) return nullptr;
 
-		auto width = png_get_image_width(png, info);
-		auto height = png_get_image_height(png, info);
+		auto width = reader->getWidth();
+		auto height = reader->getHeight();
 		auto* pixels = new u8[u64(width) * height * 4];
 
-		/* convert the image into 8 bit rgba */
-		const auto colorType = png_get_color_type(png, info);
-		const auto bitDepth = png_get_bit_depth(png, info);
-
-		if (bitDepth == 16)
-			png_set_strip_16(png);
-
-		if (colorType == PNG_COLOR_TYPE_PALETTE)
-			png_set_palette_to_rgb(png);
-
-		if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
-			png_set_expand_gray_1_2_4_to_8(png);
-
-		if (png_get_valid(png, info, PNG_INFO_tRNS))
-			png_set_tRNS_to_alpha(png);
-
-		if (colorType == PNG_COLOR_TYPE_RGB || colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_PALETTE)
-			png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
-
-		if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
-			png_set_gray_to_rgb(png);
-
-		png_read_update_info(png, info);
-
-		/* cache the row so we can convert it */
-		auto* pngRow = new u8[width * 4llu];
-
-		/* read each row into the 1d array */
 		for (auto j = 0u; j < height; ++j) {
-			png_read_row(png, pngRow, nullptr);
-
-			for (auto i = 0u; i < width; ++i) {
-				pixels[(j * width + i) * 4    ] = pngRow[i * 4    ];
-				pixels[(j * width + i) * 4 + 1] = pngRow[i * 4 + 1];
-				pixels[(j * width + i) * 4 + 2] = pngRow[i * 4 + 2];
-				pixels[(j * width + i) * 4 + 3] = pngRow[i * 4 + 3];
+			if (!reader->readRow(pixels + u64(j) * width * 4)) {
+				delete[] pixels;
+				return nullptr;
 			}
 		}
 
-		delete[] pngRow;
-
-		png_destroy_read_struct(&png, &info, nullptr);
-		fclose(file);
-
 		return std::make_unique<Image>(width, height, pixels);
 	}
 
@@ -126,46 +101,26 @@ namespace CNGE {
 		return pixels;
 	}
 
-	auto Image::write(std::filesystem::path& path) const -> void {
-		auto* file = static_cast<FILE*>(nullptr);
-		
-		_wfopen_s(&file, path.c_str(), L"wb");
-
-		auto* png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-		auto* info = png_create_info_struct(png);
-
-		png_init_io(png, file);
-
-		png_set_IHDR(
-			png,
-			info,
-			width, height,
-			8,
-			PNG_COLOR_TYPE_RGBA,
-			PNG_INTERLACE_NONE,
-			PNG_COMPRESSION_TYPE_DEFAULT,
-			PNG_FILTER_TYPE_DEFAULT
-		);
-
-		png_write_info(png, info);
-
-		auto* row = new u8[png_get_rowbytes(png, info)];
-		
-		/* convert image back into bytes */
-		for (auto j = 0u; j < height; ++j) {
-			for (auto i = 0u; i < width * 4; ++i)
-				row[i]  = pixels[j * width * 4 + i];
+	/**
+	 * encodes the image as an rgba png in memory, on as many threads as the options allow
+	 *
+	 * @return empty if the image has no pixels
+	 */
+	auto Image::toPNG(const PNGWriteOptions& options) const -> std::vector<u8> {
+		return PNGWriter::encode(width, height, pixels, options);
+	}
 
-			png_write_row(png, row);
-		}
-		
-		delete[] row;
-		
-		png_write_end(png, nullptr);
+	/**
+	 * @return false if the image has no pixels or the file could not be written
+	 */
+	auto Image::write(const std::filesystem::path& path, const PNGWriteOptions& options) const -> bool {
+		auto png = toPNG(options);
+		if (png.empty()) return false;
 
-		png_destroy_write_struct(&png, &info);
+		auto file = std::ofstream(path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(png.data()), std::streamsize(png.size()));
 
-		fclose(file);
+		return bool(file.flush());
 	}
 
 	auto Image::isValid() -> bool {
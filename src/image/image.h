@@ -6,17 +6,24 @@
 #include <memory>
 
 #include "types.h"
+#include "pngWriter.h"
 
 namespace CNGE {
+	class PNGReader;
+
 	class Image {
 	private:
 		u32 width;
 		u32 height;
 		
 		u8* pixels;
+
+		static auto decode(std::unique_ptr<PNGReader>&&) -> std::unique_ptr<Image>;
 		
 	public:
 		static auto fromPNG(const char *) -> std::unique_ptr<Image>;
+		static auto fromPNG(const u8*, u64) -> std::unique_ptr<Image>;
+		static auto fromPNGDescriptor(int) -> std::unique_ptr<Image>;
 
 		static auto makeSheet(u32, u32) -> Image;
 		static auto makeEmpty() -> Image;
@@ -35,7 +42,8 @@ namespace CNGE {
 		
 		auto getPixels() const -> u8*;
 
-		auto write(std::filesystem::path&) const -> void;
+		auto toPNG(const PNGWriteOptions& = PNGWriteOptions()) const -> std::vector<u8>;
+		auto write(const std::filesystem::path&, const PNGWriteOptions& = PNGWriteOptions()) const -> bool;
 
 		auto isValid() -> bool;
 		auto invalidate() -> void;
@@ -0,0 +1,81 @@
+#include <fstream>
+#include <iterator>
+
+#include "mappedFile.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace CNGE {
+	MappedFile::MappedFile(void* address, u64 size) : address(address), size(size), bytes() {}
+
+	/**
+	 * @return nullptr if the file could not be opened
+	 */
+	auto MappedFile::open(const char* filepath) -> std::unique_ptr<MappedFile> {
+#ifdef __unix__
+		auto fd = ::open(filepath, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) return nullptr;
+
+		auto mapped = open(fd);
+		close(fd);
+
+		return mapped;
+#else
+		auto file = std::ifstream(filepath, std::ios::binary);
+		if (!file.is_open()) return nullptr;
+
+		auto mapped = std::unique_ptr<MappedFile>(new MappedFile(nullptr, 0));
+		mapped->bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		mapped->size = mapped->bytes.size();
+
+		return mapped;
+#endif
+	}
+
+	/**
+	 * maps a file already open for reading, the caller still owns the descriptor
+	 * and can close it straight away
+	 *
+	 * @return nullptr if it is not a regular file that can be mapped
+	 */
+	auto MappedFile::open(int fd) -> std::unique_ptr<MappedFile> {
+#ifdef __unix__
+		struct stat status;
+		if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) return nullptr;
+
+		auto size = u64(status.st_size);
+
+		/* nothing to map, reads as empty */
+		if (size == 0) return std::unique_ptr<MappedFile>(new MappedFile(nullptr, 0));
+
+		auto* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) return nullptr;
+
+		/* decoding reads straight through once */
+		madvise(address, size, MADV_SEQUENTIAL);
+
+		return std::unique_ptr<MappedFile>(new MappedFile(address, size));
+#else
+		return nullptr;
+#endif
+	}
+
+	MappedFile::~MappedFile() {
+#ifdef __unix__
+		if (address) munmap(address, size);
+#endif
+	}
+
+	auto MappedFile::getData() const -> const u8* {
+		return address ? static_cast<const u8*>(address) : bytes.data();
+	}
+
+	auto MappedFile::getSize() const -> u64 {
+		return size;
+	}
+}
@@ -0,0 +1,38 @@
+
+#ifndef CNGE_MAPPED_FILE
+#define CNGE_MAPPED_FILE
+
+#include <memory>
+#include <vector>
+
+#include "types.h"
+
+namespace CNGE {
+	/**
+	 * the whole of a file readable in memory without copying it in,
+	 * mapped where mmap is available, read into a buffer otherwise
+	 */
+	class MappedFile {
+	private:
+		void* address;
+		u64 size;
+
+		/* only used without mmap */
+		std::vector<u8> bytes;
+
+		MappedFile(void*, u64);
+
+	public:
+		static auto open(const char *) -> std::unique_ptr<MappedFile>;
+		static auto open(int) -> std::unique_ptr<MappedFile>;
+
+		MappedFile(const MappedFile&) = delete;
+		auto operator=(const MappedFile&) -> MappedFile& = delete;
+		~MappedFile();
+
+		auto getData() const -> const u8*;
+		auto getSize() const -> u64;
+	};
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include "pngReader.h"
+
+#include "libpng16/png.h"
+
+namespace CNGE {
+	PNGReader::PNGReader()
+		: data(nullptr), size(0), offset(0), mapping(), png(nullptr), info(nullptr), width(0), height(0), row(nullptr) {}
+
+	/**
+	 * reads the header of a png file and sets it up to decode rows,
+	 * the file is mapped and decoded from memory like an open descriptor is
+	 *
+	 * @return nullptr if the file could not be opened or is not a png
+	 */
+	auto PNGReader::open(const char* filepath) -> std::unique_ptr<PNGReader> {
+		auto mapping = MappedFile::open(filepath);
+		if (!mapping) return nullptr;
+
+		auto reader = open(mapping->getData(), mapping->getSize());
+		if (reader) reader->mapping = std::move(mapping);
+
+		return reader;
+	}
+
+	/**
+	 * decodes a png already in memory, like one received over the network or a mapped file,
+	 * without copying it anywhere first
+	 *
+	 * @param data has to stay valid for as long as the reader
+	 *
+	 * @return nullptr if the data is not a png
+	 */
+	auto PNGReader::open(const u8* data, u64 size) -> std::unique_ptr<PNGReader> {
+		if (size < SIGNATURE_BYTES || png_sig_cmp(data, 0, SIGNATURE_BYTES) != 0) return nullptr;
+
+		auto reader = std::unique_ptr<PNGReader>(new PNGReader());
+		reader->data = data;
+		reader->size = size;
+		reader->offset = SIGNATURE_BYTES;
+
+		return start(std::move(reader));
+	}
+
+	/**
+	 * decodes a png file already open, mapping it instead of reading it in,
+	 * the caller still owns the descriptor
+	 *
+	 * @return nullptr if the file cannot be mapped or is not a png
+	 */
+	auto PNGReader::open(int fd) -> std::unique_ptr<PNGReader> {
+		auto mapping = MappedFile::open(fd);
+		if (!mapping) return nullptr;
+
+		auto reader = open(mapping->getData(), mapping->getSize());
+		if (reader) reader->mapping = std::move(mapping);
+
+		return reader;
+	}
+
+	/**
+	 * hands libpng the next bytes of a png in memory
+	 */
+	auto PNGReader::readMemory(png_struct_def* png, u8* out, size_t length) -> void {
+		auto* reader = static_cast<PNGReader*>(png_get_io_ptr(png));
+
+		if (length > reader->size - reader->offset)
+			png_error(png, "Read past end of data");
+
+		memcpy(out, reader->data + reader->offset, length);
+		reader->offset += length;
+	}
+
+	/**
+	 * reads the header of a png whose signature has been checked, and sets up its conversion to rgba
+	 *
+	 * @return nullptr if the header is broken
+	 */
+	auto PNGReader::start(std::unique_ptr<PNGReader>&& reader) -> std::unique_ptr<PNGReader> {
+		auto* png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		auto* info = png_create_info_struct(png);
+
+		/* owned by the reader from here on */
+		reader->png = png;
+		reader->info = info;
+
+		/* libpng jumps back here on a broken header */
+		if (setjmp(png_jmpbuf(png))) return nullptr;
+
+		png_set_read_fn(png, reader.get(), readMemory);
+
+		png_set_sig_bytes(png, SIGNATURE_BYTES);
+		png_read_info(png, info);
+
+		/* convert the image into 8 bit rgba */
+		const auto colorType = png_get_color_type(png, info);
+		const auto bitDepth = png_get_bit_depth(png, info);
+
+		if (bitDepth == 16)
+			png_set_strip_16(png);
+
+		if (colorType == PNG_COLOR_TYPE_PALETTE)
+			png_set_palette_to_rgb(png);
+
+		if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+			png_set_expand_gray_1_2_4_to_8(png);
+
+		if (png_get_valid(png, info, PNG_INFO_tRNS))
+			png_set_tRNS_to_alpha(png);
+
+		if (colorType == PNG_COLOR_TYPE_RGB || colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_PALETTE)
+			png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+
+		if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+			png_set_gray_to_rgb(png);
+
+		png_read_update_info(png, info);
+
+		reader->width = png_get_image_width(png, info);
+		reader->height = png_get_image_height(png, info);
+		reader->row = new u8[reader->width * 4llu];
+
+		return std::move(reader);
+	}
+
+	PNGReader::~PNGReader() {
+		delete[] row;
+
+		if (png) png_destroy_read_struct(&png, &info, nullptr);
+	}
+
+	auto PNGReader::getWidth() const -> u32 {
+		return width;
+	}
+
+	auto PNGReader::getHeight() const -> u32 {
+		return height;
+	}
+
+	/**
+	 * @return the next row, valid until the next call, or nullptr if the image data is broken
+	 */
+	auto PNGReader::readRow() -> const u8* {
+		return readRow(row) ? row : nullptr;
+	}
+
+	/**
+	 * decodes the next row straight into the caller's buffer, width * 4 bytes
+	 *
+	 * @return false if the image data is broken
+	 */
+	auto PNGReader::readRow(u8* destination) -> bool {
+		if (setjmp(png_jmpbuf(png))) return false;
+
+		png_read_row(png, destination, nullptr);
+
+		return true;
+	}
+}
@@ -0,0 +1,61 @@
+
+#ifndef CNGE_PNG_READER
+#define CNGE_PNG_READER
+
+#include <memory>
+
+#include "types.h"
+#include "mappedFile.h"
+
+struct png_struct_def;
+struct png_info_def;
+
+namespace CNGE {
+	/**
+	 * decodes a png one row at a time as 8 bit rgba,
+	 * so rows can be used before the rest of the image is read
+	 *
+	 * reads straight out of memory through a read callback, files being mapped first,
+	 * so every source gets the same signature and header checks
+	 */
+	class PNGReader {
+	private:
+		constexpr static u64 SIGNATURE_BYTES = 8;
+
+		/* a span of memory, which may be a mapping of a file this reader owns */
+		const u8* data;
+		u64 size;
+		u64 offset;
+		std::unique_ptr<MappedFile> mapping;
+
+		png_struct_def* png;
+		png_info_def* info;
+
+		u32 width;
+		u32 height;
+
+		u8* row;
+
+		PNGReader();
+
+		static auto readMemory(png_struct_def*, u8*, size_t) -> void;
+		static auto start(std::unique_ptr<PNGReader>&&) -> std::unique_ptr<PNGReader>;
+
+	public:
+		static auto open(const char *) -> std::unique_ptr<PNGReader>;
+		static auto open(const u8*, u64) -> std::unique_ptr<PNGReader>;
+		static auto open(int) -> std::unique_ptr<PNGReader>;
+
+		PNGReader(const PNGReader&) = delete;
+		auto operator=(const PNGReader&) -> PNGReader& = delete;
+		~PNGReader();
+
+		auto getWidth() const -> u32;
+		auto getHeight() const -> u32;
+
+		auto readRow() -> const u8*;
+		auto readRow(u8*) -> bool;
+	};
+}
+
+#endif
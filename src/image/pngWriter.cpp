@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+#include "pngWriter.h"
+
+#include "zlib.h"
+
+namespace CNGE {
+	PNGWriteOptions::PNGWriteOptions()
+		: level(6), filter(PNGFilter::ADAPTIVE), threads(0), chunkBytes(128 * 1024) {}
+
+	/**
+	 * runs work on every index below count, spread over threads that each take the next one free
+	 */
+	auto PNGWriter::parallel(u64 count, u32 threads, const std::function<void(u64)>& work) -> void {
+		if (threads <= 1 || count <= 1) {
+			for (auto i = 0_u64; i < count; ++i) work(i);
+			return;
+		}
+
+		auto next = std::atomic<u64>(0);
+		auto workers = std::vector<std::thread>();
+
+		for (auto t = 0u; t < std::min<u64>(threads, count); ++t) {
+			workers.emplace_back([&next, count, &work]() {
+				for (auto i = next++; i < count; i = next++) work(i);
+			});
+		}
+
+		for (auto& worker : workers) worker.join();
+	}
+
+	static auto paeth(u8 left, u8 up, u8 upLeft) -> u8 {
+		auto toLeft = std::abs(i32(up) - upLeft);
+		auto toUp = std::abs(i32(left) - upLeft);
+		auto toUpLeft = std::abs(i32(left) + up - 2 * upLeft);
+
+		if (toLeft <= toUp && toLeft <= toUpLeft) return left;
+		return toUp <= toUpLeft ? up : upLeft;
+	}
+
+	/**
+	 * filters one row, its filter type byte first
+	 *
+	 * each filter gets its own loop with the first pixel, which has nothing to its left, taken out,
+	 * so the loops have nothing to decide per byte
+	 *
+	 * @param prior the row above, nullptr for the first row, which is filtered as if under a row of zeros
+	 * @param out has room for the row and the byte before it
+	 * @param scratch as much room again, only used to try filters out when adaptive
+	 */
+	auto PNGWriter::filterRow(PNGFilter filter, const u8* row, const u8* prior, u64 rowBytes, u8* out, u8* scratch) -> void {
+		/* libpng's heuristic, the filter whose bytes taken as signed add up smallest, the first of any tied */
+		if (filter == PNGFilter::ADAPTIVE) {
+			auto* best = static_cast<u8*>(nullptr);
+			auto bestSum = ~0_u64;
+
+			for (auto candidate : { PNGFilter::NONE, PNGFilter::SUB, PNGFilter::UP, PNGFilter::AVERAGE, PNGFilter::PAETH }) {
+				auto* into = best == out ? scratch : out;
+				filterRow(candidate, row, prior, rowBytes, into, nullptr);
+
+				auto sum = 0_u64;
+				for (auto i = 1_u64; i <= rowBytes; ++i) sum += u8(std::abs(i32(i8(into[i]))));
+
+				if (sum < bestSum) {
+					bestSum = sum;
+					best = into;
+				}
+			}
+
+			if (best != out) memcpy(out, best, rowBytes + 1);
+
+			return;
+		}
+
+		out[0] = u8(filter);
+		++out;
+
+		auto first = std::min<u64>(BYTES_PER_PIXEL, rowBytes);
+
+		/* under a row of zeros up is none, average halves the left, and paeth always picks the left */
+		if (prior == nullptr) {
+			switch (filter) {
+				case PNGFilter::UP: filter = PNGFilter::NONE; break;
+				case PNGFilter::PAETH: filter = PNGFilter::SUB; break;
+				case PNGFilter::AVERAGE: {
+					memcpy(out, row, first);
+					for (auto i = first; i < rowBytes; ++i) out[i] = row[i] - (row[i - BYTES_PER_PIXEL] >> 1u);
+					return;
+				}
+				default: break;
+			}
+		}
+
+		switch (filter) {
+			case PNGFilter::NONE: {
+				memcpy(out, row, rowBytes);
+				break;
+			}
+			case PNGFilter::SUB: {
+				memcpy(out, row, first);
+				for (auto i = first; i < rowBytes; ++i) out[i] = row[i] - row[i - BYTES_PER_PIXEL];
+				break;
+			}
+			case PNGFilter::UP: {
+				for (auto i = 0_u64; i < rowBytes; ++i) out[i] = row[i] - prior[i];
+				break;
+			}
+			case PNGFilter::AVERAGE: {
+				for (auto i = 0_u64; i < first; ++i) out[i] = row[i] - (prior[i] >> 1u);
+				for (auto i = first; i < rowBytes; ++i) out[i] = row[i] - u8((u32(row[i - BYTES_PER_PIXEL]) + prior[i]) >> 1u);
+				break;
+			}
+			case PNGFilter::PAETH: {
+				/* with nothing to the left paeth picks up */
+				for (auto i = 0_u64; i < first; ++i) out[i] = row[i] - prior[i];
+				for (auto i = first; i < rowBytes; ++i) out[i] = row[i] - paeth(row[i - BYTES_PER_PIXEL], prior[i], prior[i - BYTES_PER_PIXEL]);
+				break;
+			}
+			case PNGFilter::ADAPTIVE: break;
+		}
+	}
+
+	/**
+	 * deflates one run of filtered rows as raw deflate, carrying on from the window before it
+	 *
+	 * @param filtered all the filtered rows, the run starts at offset
+	 * @param last finishes the stream, otherwise it ends on a sync flush so the next run can follow on
+	 *
+	 * @return false if zlib could not be set up
+	 */
+	auto PNGWriter::deflateRun(const u8* filtered, u64 offset, u64 length, i32 level, PNGFilter filter, bool last, std::vector<u8>& out) -> bool {
+		auto stream = z_stream();
+
+		/* libpng's choice too, filtered rows compress better weighted towards matches */
+		auto strategy = filter == PNGFilter::NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+
+		if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy) != Z_OK) return false;
+
+		auto window = std::min(offset, WINDOW_BYTES);
+		if (window > 0) deflateSetDictionary(&stream, filtered + offset - window, uInt(window));
+
+		auto start = out.size();
+
+		/* a sync flush adds an empty stored block, and a bound is only a bound with every flush counted */
+		out.resize(start + deflateBound(&stream, uLong(length)) + 16);
+
+		stream.next_in = const_cast<u8*>(filtered + offset);
+		stream.avail_in = uInt(length);
+
+		auto flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+		for (;;) {
+			stream.next_out = out.data() + start;
+			stream.avail_out = uInt(out.size() - start);
+
+			auto result = deflate(&stream, flush);
+			start = out.size() - stream.avail_out;
+
+			if (last ? result == Z_STREAM_END : stream.avail_in == 0 && stream.avail_out != 0) break;
+
+			out.resize(out.size() * 2);
+		}
+
+		out.resize(start);
+		deflateEnd(&stream);
+
+		return true;
+	}
+
+	auto PNGWriter::appendChunk(std::vector<u8>& out, const char* type, const u8* data, u64 length) -> void {
+		for (auto shift : { 24u, 16u, 8u, 0u }) out.push_back(u8(length >> shift));
+
+		auto start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data, data + length);
+
+		auto crc = crc32(crc32(0, nullptr, 0), out.data() + start, uInt(out.size() - start));
+		for (auto shift : { 24u, 16u, 8u, 0u }) out.push_back(u8(crc >> shift));
+	}
+
+	/**
+	 * @param pixels rows of 8 bit rgba, top first
+	 *
+	 * @return the whole png, empty if the image has no pixels or zlib could not be set up
+	 */
+	auto PNGWriter::encode(u32 width, u32 height, const u8* pixels, const PNGWriteOptions& options) -> std::vector<u8> {
+		if (width == 0 || height == 0) return {};
+
+		auto level = std::clamp(options.level, 0, 9);
+		auto threads = options.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+
+		auto rowBytes = u64(width) * BYTES_PER_PIXEL;
+		auto filteredBytes = rowBytes + 1;
+		auto rowsPerRun = std::max(1_u64, options.chunkBytes / filteredBytes);
+		auto runs = (height + rowsPerRun - 1) / rowsPerRun;
+
+		/* every row filters against the original row above, so all of them can go at once */
+		auto filtered = std::vector<u8>(filteredBytes * height);
+
+		parallel(runs, threads, [&](u64 run) {
+			auto scratch = std::vector<u8>(options.filter == PNGFilter::ADAPTIVE ? filteredBytes : 0);
+
+			for (auto j = run * rowsPerRun; j < std::min<u64>(height, (run + 1) * rowsPerRun); ++j) {
+				auto* row = pixels + j * rowBytes;
+				filterRow(options.filter, row, j == 0 ? nullptr : row - rowBytes, rowBytes, filtered.data() + j * filteredBytes, scratch.data());
+			}
+		});
+
+		auto compressed = std::vector<std::vector<u8>>(runs);
+		auto checksums = std::vector<uLong>(runs);
+		auto failed = std::atomic<bool>(false);
+
+		parallel(runs, threads, [&](u64 run) {
+			auto offset = run * rowsPerRun * filteredBytes;
+			auto length = std::min(filtered.size(), offset + rowsPerRun * filteredBytes) - offset;
+
+			if (!deflateRun(filtered.data(), offset, length, level, options.filter, run == runs - 1, compressed[run])) failed = true;
+			checksums[run] = adler32(adler32(0, nullptr, 0), filtered.data() + offset, uInt(length));
+		});
+
+		if (failed) return {};
+
+		/* deflate with a 32 KiB window, and how hard it was compressed the way zlib would mark it */
+		constexpr u8 METHOD = 0x78;
+		auto levelFlag = u8(level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3) << 6u;
+		levelFlag += (31 - (METHOD * 256 + levelFlag) % 31) % 31;
+
+		compressed.front().insert(compressed.front().begin(), { METHOD, u8(levelFlag) });
+
+		auto adler = checksums[0];
+		for (auto run = 1_u64; run < runs; ++run) {
+			auto length = std::min(filtered.size(), (run + 1) * rowsPerRun * filteredBytes) - run * rowsPerRun * filteredBytes;
+			adler = adler32_combine(adler, checksums[run], z_off_t(length));
+		}
+
+		for (auto shift : { 24u, 16u, 8u, 0u }) compressed.back().push_back(u8(adler >> shift));
+
+		auto png = std::vector<u8>({ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' });
+
+		/* width, height, 8 bit, rgba, deflate, adaptive filtering, not interlaced */
+		u8 header[13] = {};
+		for (auto i = 0u; i < 4; ++i) {
+			header[i] = u8(width >> (24 - i * 8));
+			header[4 + i] = u8(height >> (24 - i * 8));
+		}
+		header[8] = 8;
+		header[9] = 6;
+
+		appendChunk(png, "IHDR", header, sizeof(header));
+
+		for (auto& piece : compressed)
+			for (auto offset = 0_u64; offset < piece.size(); offset += MAX_IDAT_BYTES)
+				appendChunk(png, "IDAT", piece.data() + offset, std::min(MAX_IDAT_BYTES, piece.size() - offset));
+
+		appendChunk(png, "IEND", nullptr, 0);
+
+		return png;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef CNGE_PNG_WRITER
+#define CNGE_PNG_WRITER
+
+#include <functional>
+#include <vector>
+
+#include "types.h"
+
+namespace CNGE {
+	/* the png row filters, or adaptive to pick whichever suits each row best */
+	enum class PNGFilter : u8 {
+		NONE,
+		SUB,
+		UP,
+		AVERAGE,
+		PAETH,
+		ADAPTIVE,
+	};
+
+	class PNGWriteOptions {
+	public:
+		PNGWriteOptions();
+
+		/* 0 only stores, 1 through 9 as in zlib from fastest to smallest */
+		i32 level;
+		PNGFilter filter;
+
+		/* 0 for one per hardware thread */
+		u32 threads;
+
+		/* about how many filtered bytes are deflated as one piece, the output only depends on this and not on threads */
+		u64 chunkBytes;
+	};
+
+	/**
+	 * encodes 8 bit rgba as a png, filtering rows and deflating runs of them on several threads at once
+	 *
+	 * each run of rows is deflated on its own, primed with the 32 KiB before it so little is lost to splitting,
+	 * and ends on a byte boundary with a sync flush, the way pigz does,
+	 * so the pieces join into one zlib stream as they are, with their checksums combined at the end
+	 */
+	class PNGWriter {
+	private:
+		constexpr static u32 BYTES_PER_PIXEL = 4;
+		constexpr static u64 WINDOW_BYTES = 32768;
+
+		/* a chunk may be up to 2^31 - 1 bytes, kept far under so a reader never has to hold much of one */
+		constexpr static u64 MAX_IDAT_BYTES = 1_u64 << 24u;
+
+		static auto parallel(u64, u32, const std::function<void(u64)>&) -> void;
+		static auto filterRow(PNGFilter, const u8*, const u8*, u64, u8*, u8*) -> void;
+		static auto deflateRun(const u8*, u64, u64, i32, PNGFilter, bool, std::vector<u8>&) -> bool;
+		static auto appendChunk(std::vector<u8>&, const char*, const u8*, u64) -> void;
+
+	public:
+		static auto encode(u32, u32, const u8*, const PNGWriteOptions&) -> std::vector<u8>;
+	};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #ifndef CNGE_TYPES
 #define CNGE_TYPES
 
+#include <stddef.h>
 #include <stdint.h>
 
 using u8   = uint8_t;
@@ -0,0 +1,663 @@
+
+#include "lockstep568.h"
+
+static auto colorIndex(unsigned int color) -> int {
+	switch (color) {
+		case Engine568::RED: return 0;
+		case Engine568::YELLOW: return 1;
+		case Engine568::GREEN: return 2;
+		case Engine568::CYAN: return 3;
+		case Engine568::BLUE: return 4;
+		case Engine568::MAGENTA: return 5;
+		default: return -1;
+	}
+}
+
+static const char * colorNames [6] = {
+	"red",
+	"yellow",
+	"green",
+	"cyan",
+	"blue",
+	"magenta"
+};
+
+LaneResult568::LaneResult568() : integers(), arrayIndices(), arrays(), output(), error(), x(0), y(0) {
+	for (auto & index : arrayIndices) index = -1;
+}
+
+LockstepStats568::LockstepStats568() : lanes(0), groupSteps(0), laneSteps(0), splits(0) {}
+
+/**
+ * @return the average fraction of lanes doing useful work per instruction
+ */
+auto LockstepStats568::occupancy() -> double {
+	if (groupSteps == 0) return 0.0;
+
+	return double(laneSteps) / (double(groupSteps) * lanes);
+}
+
+template <unsigned int Lanes>
+LockstepEngine568<Lanes>::Group::Group() :
+	active(),
+	count(0),
+	lanes(),
+	x(-1), y(0),
+	dx(1), dy(0),
+	color(0),
+	steps(0),
+	turns(0),
+	op(NONE),
+	lastKind(REF_NONE),
+	lastIndex(0),
+	lastValue(),
+	lastArray(),
+	lastElement(),
+	integers(),
+	arrayIndices(),
+	arrays(),
+	output()
+{
+	for (auto & reg : arrayIndices) for (auto & index : reg) index = -1;
+}
+
+/**
+ * @param engine a loaded engine, only verified programs run in lockstep
+ */
+template <unsigned int Lanes>
+LockstepEngine568<Lanes>::LockstepEngine568(Engine568 & engine) :
+	image(engine.getImage().data()),
+	width(int(engine.getLoadStats().width)),
+	height(int(engine.getLoadStats().height)),
+	verified(engine.getLoadStats().verified),
+	stepLimit(engine.getStepLimit() == 0 ? ~0ull : engine.getStepLimit()),
+	groups(),
+	results(nullptr),
+	stats()
+{
+	stats.lanes = Lanes;
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::outOfBounds(Group & group) -> bool {
+	return group.x < 0 || group.y < 0 || group.x >= width || group.y >= height;
+}
+
+/**
+ * moves a group onto the next colored pixel
+ *
+ * @return the color there, or 0 out of bounds
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::next(Group & group) -> unsigned int {
+	while (true) {
+		group.x += group.dx;
+		group.y += group.dy;
+
+		if (outOfBounds(group)) return 0;
+
+		auto current = image[group.y * width + group.x];
+		if (colorIndex(current) != -1) return current;
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::turn(Group & group, unsigned int rgb) -> void {
+	switch (rgb) {
+		case Engine568::RED: group.dx = 1; group.dy = 0; break;
+		case Engine568::YELLOW: group.dx = 0; group.dy = -1; break;
+		case Engine568::GREEN: group.dx = -1; group.dy = 0; break;
+		case Engine568::CYAN: group.dx = 0; group.dy = 1; break;
+	}
+}
+
+/**
+ * retires a lane, handing its state over to its result
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::finish(Group & group, unsigned int lane) -> void {
+	auto & result = (*results)[group.lanes[lane]];
+
+	for (auto i = 0; i < NUM_REGISTERS; ++i) {
+		result.integers[i] = group.integers[i][lane];
+		result.arrayIndices[i] = group.arrayIndices[i][lane];
+		result.arrays[i] = std::move(group.arrays[lane][i]);
+	}
+
+	result.output = std::move(group.output[lane]);
+	result.x = group.x;
+	result.y = group.y;
+
+	group.active[lane] = false;
+	--group.count;
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::fail(Group & group, unsigned int lane, std::string && message) -> void {
+	auto color = outOfBounds(group) ? nullptr : colorNames[colorIndex(image[group.y * width + group.x])];
+
+	(*results)[group.lanes[lane]].error = Engine568::formatError(group.x, group.y, group.dx, group.dy, color, message);
+
+	finish(group, lane);
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::failAll(Group & group, const std::string & message) -> void {
+	for (auto lane = 0u; lane < Lanes; ++lane)
+		if (group.active[lane]) fail(group, lane, std::string(message));
+}
+
+/**
+ * takes a turn inside a switch or an array's elements, which the engine holds to its step limit
+ *
+ * @return false if the group ran out and every lane failed
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::turnInside(Group & group) -> bool {
+	if (++group.turns >= stepLimit) {
+		failAll(group, "Ran out of steps (" + std::to_string(stepLimit) + ")");
+		return false;
+	}
+
+	turn(group, next(group));
+	return true;
+}
+
+/**
+ * moves the lanes in the mask out of a group into a new group at the same position
+ *
+ * @return the new group, valid until the next split
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::split(Group & group, bool * leaving) -> Group & {
+	auto & other = groups.emplace_back(group);
+	other.count = 0;
+
+	for (auto lane = 0u; lane < Lanes; ++lane) {
+		other.active[lane] = group.active[lane] && leaving[lane];
+
+		if (other.active[lane]) {
+			++other.count;
+			group.active[lane] = false;
+			--group.count;
+
+		} else {
+			for (auto & array : other.arrays[lane]) array = std::vector<int>();
+			other.output[lane] = std::string();
+		}
+	}
+
+	++stats.splits;
+
+	return other;
+}
+
+/**
+ * moves onto the next instruction, retiring every lane if the program runs out of bounds
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::advance(Group & group) -> void {
+	group.color = next(group);
+
+	if (group.color == 0)
+		for (auto lane = 0u; lane < Lanes; ++lane)
+			if (group.active[lane]) finish(group, lane);
+}
+
+/**
+ * fixed width loops the compiler can turn into vector instructions,
+ * the results of inactive lanes are thrown away so only division needs masking
+ */
+template <unsigned int Lanes>
+static auto combine(int op, const int * last, int * values, const bool * active) -> void {
+	switch (op) {
+		case 1: case 10: for (auto l = 0u; l < Lanes; ++l) values[l] = int(unsigned(last[l]) + unsigned(values[l])); break;
+		case 2: case 11: for (auto l = 0u; l < Lanes; ++l) values[l] = int(unsigned(last[l]) - unsigned(values[l])); break;
+		case 3: case 12: for (auto l = 0u; l < Lanes; ++l) values[l] = int(unsigned(last[l]) * unsigned(values[l])); break;
+		/* the engine's default checks, zero for a zero divisor and wrapping for -1 */
+		case 4: case 13: for (auto l = 0u; l < Lanes; ++l) if (active[l]) values[l] = values[l] == 0 ? 0 : values[l] == -1 ? int(0u - unsigned(last[l])) : last[l] / values[l]; break;
+		case 5: case 14: for (auto l = 0u; l < Lanes; ++l) if (active[l]) values[l] = values[l] == 0 || values[l] == -1 ? 0 : last[l] % values[l]; break;
+		case 6: for (auto l = 0u; l < Lanes; ++l) values[l] = last[l] == values[l]; break;
+		case 7: for (auto l = 0u; l < Lanes; ++l) values[l] = last[l] < values[l]; break;
+		case 8: for (auto l = 0u; l < Lanes; ++l) values[l] = last[l] > values[l]; break;
+	}
+}
+
+/**
+ * parses an operand and loads it for the lanes in the mask,
+ * lanes that fail to dereference are retired
+ *
+ * @param prefix put in front of error messages
+ * @param pendingOperator the engine applies a waiting assignment even to a value that failed, replacing the error
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::load(Group & group, Operand & operand, const bool * mask, const std::string & prefix, bool pendingOperator) -> void {
+	auto value = 1;
+
+	while (true) {
+		switch (next(group)) {
+			case Engine568::RED: {
+				operand.kind = REF_REGISTER;
+				operand.index = colorIndex(next(group));
+
+				for (auto l = 0u; l < Lanes; ++l) operand.values[l] = group.integers[operand.index][l];
+				return;
+			}
+			case Engine568::YELLOW: {
+				operand.kind = REF_ELEMENT;
+				operand.index = colorIndex(next(group));
+
+				auto index = operand.index;
+				auto name = std::string(colorNames[index]);
+
+				for (auto l = 0u; l < Lanes; ++l) {
+					if (!mask[l] || !group.active[l]) continue;
+
+					auto array = group.arrayIndices[index][l];
+					auto message = std::string();
+
+					if (array == -1) {
+						message = "Register " + name + " does not point to an array";
+
+					} else {
+						auto & elements = group.arrays[l][array];
+						auto element = group.integers[index][l];
+
+						if (static_cast<std::size_t>(element) >= elements.size()) {
+							message = "Trying to access array " + name + " out of bounds (" + std::to_string(element) + " out of " + std::to_string(elements.size()) + ")";
+
+						} else {
+							operand.values[l] = elements[element];
+							operand.arrays[l] = array;
+							operand.elements[l] = element;
+							continue;
+						}
+					}
+
+					if (pendingOperator && group.op == ASSIGN) message = "Trying to assign to value";
+					else if (pendingOperator && group.op >= COMPOUND_ADD) message = "Trying to compound assign to value";
+					else message = prefix + message;
+
+					fail(group, l, std::move(message));
+				}
+
+				return;
+			}
+			case Engine568::GREEN: value = (value << 1) + 1; break;
+			case Engine568::CYAN: value <<= 1; break;
+			case Engine568::BLUE: {
+				operand.kind = REF_NONE;
+				for (auto & lane : operand.values) lane = value;
+				return;
+			}
+			default: {
+				operand.kind = REF_NONE;
+				for (auto & lane : operand.values) lane = 0;
+				return;
+			}
+		}
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::applyOperator(Group & group, Operand & operand) -> void {
+	auto op = group.op;
+	group.op = NONE;
+
+	/* lanes dividing by zero stop after the operator is done, like the engine */
+	bool byZero [Lanes] = {};
+	if (op == DIVIDE || op == MODULO || op == COMPOUND_DIVIDE || op == COMPOUND_MODULO)
+		for (auto l = 0u; l < Lanes; ++l) byZero[l] = group.active[l] && operand.values[l] == 0;
+
+	switch (op) {
+		case NONE: return;
+		case ASSIGN: {
+			if (operand.kind == REF_REGISTER) {
+				auto i = operand.index;
+
+				if (group.lastKind == REF_REGISTER) {
+					auto j = group.lastIndex;
+
+					for (auto l = 0u; l < Lanes; ++l) {
+						group.integers[i][l] = group.integers[j][l];
+						group.arrayIndices[i][l] = group.arrayIndices[j][l];
+					}
+
+				} else {
+					for (auto l = 0u; l < Lanes; ++l) group.integers[i][l] = group.lastValue[l];
+				}
+
+			} else if (operand.kind == REF_ELEMENT) {
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l]) group.arrays[l][operand.arrays[l]][operand.elements[l]] = group.lastValue[l];
+
+			} else {
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l]) fail(group, l, "Trying to assign to value");
+			}
+
+			return;
+		}
+		case COMPOUND_ADD:
+		case COMPOUND_SUBTRACT:
+		case COMPOUND_MULTIPLY:
+		case COMPOUND_DIVIDE:
+		case COMPOUND_MODULO: {
+			if (operand.kind == REF_NONE) {
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l]) fail(group, l, "Trying to compound assign to value");
+
+				return;
+			}
+
+			combine<Lanes>(op, group.lastValue, operand.values, group.active);
+
+			if (operand.kind == REF_REGISTER) {
+				for (auto l = 0u; l < Lanes; ++l) group.integers[operand.index][l] = operand.values[l];
+
+			} else {
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l]) group.arrays[l][operand.arrays[l]][operand.elements[l]] = operand.values[l];
+			}
+
+			for (auto l = 0u; l < Lanes; ++l)
+				if (byZero[l]) fail(group, l, "Division by zero");
+
+			return;
+		}
+		default: {
+			combine<Lanes>(op, group.lastValue, operand.values, group.active);
+
+			for (auto l = 0u; l < Lanes; ++l)
+				if (byZero[l]) fail(group, l, "Division by zero");
+
+			return;
+		}
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::parseBranch(Group & group) -> void {
+	auto direction = next(group);
+
+	if (direction == Engine568::BLUE) return parseSwitch(group);
+
+	bool taken [Lanes];
+	auto numTaken = 0u;
+
+	for (auto l = 0u; l < Lanes; ++l) {
+		taken[l] = group.active[l] && group.lastValue[l] != 0;
+		numTaken += taken[l];
+	}
+
+	if (numTaken == group.count) {
+		turn(group, direction);
+
+	} else if (numTaken > 0) {
+		auto & other = split(group, taken);
+		turn(other, direction);
+		advance(other);
+	}
+}
+
+/**
+ * lanes leave a switch at the first case they match,
+ * each case that only some lanes match splits them off
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::parseSwitch(Group & group) -> void {
+	while (true) {
+		switch (next(group)) {
+			case Engine568::RED: {
+				if (!turnInside(group)) return;
+				break;
+			}
+			case Engine568::GREEN: {
+				auto operand = Operand();
+				load(group, operand, group.active, "while parsing switch case: ", false);
+
+				auto direction = next(group);
+
+				bool matched [Lanes];
+				auto numMatched = 0u;
+
+				for (auto l = 0u; l < Lanes; ++l) {
+					matched[l] = group.active[l] && operand.values[l] == group.lastValue[l];
+					numMatched += matched[l];
+				}
+
+				if (numMatched == 0) break;
+
+				if (numMatched == group.count) {
+					turn(group, direction);
+					return;
+				}
+
+				auto & other = split(group, matched);
+				turn(other, direction);
+				advance(other);
+				break;
+			}
+			case Engine568::CYAN: {
+				turn(group, next(group));
+				return;
+			}
+			default: return;
+		}
+
+		if (group.count == 0) return;
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::parseHeap(Group & group) -> void {
+	auto index = colorIndex(next(group));
+	auto name = std::string(colorNames[index]);
+
+	auto size = Operand();
+	load(group, size, group.active, "While parsing array size for register " + name + ": ", false);
+
+	for (auto l = 0u; l < Lanes; ++l) {
+		if (!group.active[l]) continue;
+
+		if (size.values[l] < 0) {
+			fail(group, l, "Trying to allocate array of negative size (" + std::to_string(size.values[l]) + ") for register " + name);
+			continue;
+		}
+
+		group.arrays[l][index].assign(size.values[l], 0);
+		group.integers[index][l] = 0;
+		group.arrayIndices[index][l] = index;
+	}
+
+	for (auto element = 0; group.count > 0;) {
+		switch (next(group)) {
+			case Engine568::RED: {
+				if (!turnInside(group)) return;
+				break;
+			}
+			case Engine568::GREEN: {
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l] && element == size.values[l])
+						fail(group, l, "Trying to initialize more array elements than array size (" + std::to_string(size.values[l]) + ") for register " + name);
+
+				auto value = Operand();
+				load(group, value, group.active, "While parsing array initializer value " + std::to_string(element + 1) + " for register " + name + ": ", false);
+
+				for (auto l = 0u; l < Lanes; ++l)
+					if (group.active[l]) group.arrays[l][index][element] = value.values[l];
+
+				++element;
+				break;
+			}
+			default: return;
+		}
+	}
+}
+
+/**
+ * not, written through the last reference
+ *
+ * @param compound which of the engine's two errors a missing reference is reported as
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::unaryNot(Group & group, bool compound) -> void {
+	switch (group.lastKind) {
+		case REF_NONE: {
+			for (auto l = 0u; l < Lanes; ++l)
+				if (group.active[l]) fail(group, l, compound ? "Trying to compound assign to value" : "Trying to negate value");
+
+			break;
+		}
+		case REF_REGISTER: {
+			for (auto l = 0u; l < Lanes; ++l) group.integers[group.lastIndex][l] = !group.lastValue[l];
+			break;
+		}
+		case REF_ELEMENT: {
+			for (auto l = 0u; l < Lanes; ++l)
+				if (group.active[l]) group.arrays[l][group.lastArray[l]][group.lastElement[l]] = !group.lastValue[l];
+
+			break;
+		}
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::parseOperator1(Group & group, unsigned int rgb) -> void {
+	switch (rgb) {
+		case Engine568::RED: group.op = ADD; break;
+		case Engine568::YELLOW: group.op = SUBTRACT; break;
+		case Engine568::GREEN: group.op = MULTIPLY; break;
+		case Engine568::CYAN: group.op = DIVIDE; break;
+		case Engine568::BLUE: group.op = MODULO; break;
+		case Engine568::MAGENTA: unaryNot(group, false); break;
+	}
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::parseOperator2(Group & group) -> void {
+	switch (next(group)) {
+		case Engine568::RED: group.op = EQUAL; break;
+		case Engine568::YELLOW: group.op = LESS; break;
+		case Engine568::GREEN: group.op = GREATER; break;
+		case Engine568::CYAN: {
+			for (auto l = 0u; l < Lanes; ++l)
+				if (group.active[l]) group.output[l] += char(group.lastValue[l]);
+
+			break;
+		}
+		case Engine568::BLUE: group.op = ASSIGN; break;
+		case Engine568::MAGENTA: {
+			auto rgb = next(group);
+
+			if (rgb == Engine568::MAGENTA) {
+				unaryNot(group, true);
+
+			} else {
+				parseOperator1(group, rgb);
+				group.op = static_cast<Operator>(group.op - ADD + COMPOUND_ADD);
+			}
+
+			break;
+		}
+	}
+}
+
+/**
+ * @return false once every lane in the group has finished
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::execute(Group & group) -> bool {
+	if (group.count == 0) return false;
+
+	if (group.steps >= stepLimit) {
+		failAll(group, "Ran out of steps (" + std::to_string(stepLimit) + ")");
+		return false;
+	}
+
+	++group.steps;
+	++stats.groupSteps;
+	stats.laneSteps += group.count;
+
+	switch (group.color) {
+		case Engine568::RED: turn(group, next(group)); break;
+		case Engine568::YELLOW: parseBranch(group); break;
+		case Engine568::GREEN: {
+			auto operand = Operand();
+			load(group, operand, group.active, "", true);
+			applyOperator(group, operand);
+
+			group.lastKind = operand.kind;
+			group.lastIndex = operand.index;
+
+			for (auto l = 0u; l < Lanes; ++l) {
+				group.lastValue[l] = operand.values[l];
+				group.lastArray[l] = operand.arrays[l];
+				group.lastElement[l] = operand.elements[l];
+			}
+
+			break;
+		}
+		case Engine568::CYAN: parseHeap(group); break;
+		case Engine568::BLUE: parseOperator1(group, next(group)); break;
+		case Engine568::MAGENTA: parseOperator2(group); break;
+	}
+
+	if (group.count > 0) advance(group);
+
+	return group.count > 0;
+}
+
+/**
+ * runs the program once per input list, each list is pushed like pushInt in order
+ *
+ * printed characters go into each lane's output rather than standard out
+ */
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::run(const std::vector<std::vector<int>> & inputs) -> std::vector<LaneResult568> {
+	auto laneResults = std::vector<LaneResult568>(inputs.size());
+	results = &laneResults;
+
+	if (!verified) {
+		for (auto & result : laneResults) result.error = "Only verified programs run in lockstep";
+		return laneResults;
+	}
+
+	for (auto base = 0u; base < inputs.size(); base += Lanes) {
+		auto group = Group();
+
+		for (auto l = 0u; l < Lanes && base + l < inputs.size(); ++l) {
+			auto & laneInputs = inputs[base + l];
+			auto numInputs = std::min<std::size_t>(laneInputs.size(), NUM_REGISTERS - 1);
+
+			/* first register enters as number of registers */
+			group.integers[0][l] = int(numInputs);
+			for (auto i = 0u; i < numInputs; ++i) group.integers[i + 1][l] = laneInputs[i];
+
+			group.active[l] = true;
+			group.lanes[l] = base + l;
+			++group.count;
+		}
+
+		advance(group);
+		groups.push_back(std::move(group));
+
+		while (!groups.empty()) {
+			auto current = std::move(groups.back());
+			groups.pop_back();
+
+			while (execute(current));
+		}
+	}
+
+	results = nullptr;
+	return laneResults;
+}
+
+template <unsigned int Lanes>
+auto LockstepEngine568<Lanes>::getStats() -> LockstepStats568 & {
+	return stats;
+}
+
+template class LockstepEngine568<8>;
+template class LockstepEngine568<16>;
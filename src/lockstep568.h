@@ -0,0 +1,164 @@
+
+#ifndef LANGUAGE568_LOCKSTEP568_H
+#define LANGUAGE568_LOCKSTEP568_H
+
+#include <vector>
+#include <string>
+
+#include "engine568.h"
+
+/**
+ * what one lane of a lockstep run ended with, the same things an engine reports
+ */
+class LaneResult568 {
+public:
+	LaneResult568();
+
+	int integers [6];
+	/* which of the lane's arrays each register points to, -1 for none */
+	int arrayIndices [6];
+	std::vector<int> arrays [6];
+
+	std::string output;
+	std::string error;
+	int x, y;
+};
+
+class LockstepStats568 {
+public:
+	LockstepStats568();
+
+	unsigned int lanes;
+
+	/* instructions executed by lane groups, and the same summed over their active lanes */
+	unsigned long long groupSteps;
+	unsigned long long laneSteps;
+
+	/* times a branch or switch sent lanes different ways */
+	unsigned long long splits;
+
+	auto occupancy() -> double;
+};
+
+/**
+ * runs one verified program over many inputs at once,
+ * one input per lane, with every lane of a group sharing the instruction pointer
+ *
+ * fetching and decoding happen once per group and values are held lane by lane
+ * in fixed width arrays, so operators compile to vector instructions as wide as the target allows
+ *
+ * when a branch or switch sends lanes different ways the group splits in two
+ * and the lanes that left carry on as their own narrower group, down to one lane each
+ *
+ * groups stop at the engine's step limit with the engine's error, so one lane that never ends cannot hold up the rest
+ */
+template <unsigned int Lanes>
+class LockstepEngine568 {
+private:
+	constexpr static int NUM_REGISTERS = 6;
+
+	enum Operator : int {
+		NONE,
+		ADD,
+		SUBTRACT,
+		MULTIPLY,
+		DIVIDE,
+		MODULO,
+		EQUAL,
+		LESS,
+		GREATER,
+		ASSIGN,
+		COMPOUND_ADD,
+		COMPOUND_SUBTRACT,
+		COMPOUND_MULTIPLY,
+		COMPOUND_DIVIDE,
+		COMPOUND_MODULO,
+	};
+
+	/* what the last value came from, the same for every lane since operands are part of the program */
+	enum RefKind : int {
+		REF_NONE,
+		REF_REGISTER,
+		REF_ELEMENT,
+	};
+
+	class Group {
+	public:
+		Group();
+
+		bool active [Lanes];
+		unsigned int count;
+		/* index into the results of each lane */
+		unsigned int lanes [Lanes];
+
+		int x, y;
+		int dx, dy;
+		unsigned int color;
+
+		/* counted as the engine counts them, carried into the groups split off */
+		unsigned long long steps;
+		unsigned long long turns;
+
+		Operator op;
+		RefKind lastKind;
+		int lastIndex;
+		int lastValue [Lanes];
+		int lastArray [Lanes];
+		int lastElement [Lanes];
+
+		int integers [NUM_REGISTERS][Lanes];
+		int arrayIndices [NUM_REGISTERS][Lanes];
+		std::vector<int> arrays [Lanes][NUM_REGISTERS];
+		std::string output [Lanes];
+	};
+
+	/* a loaded operand, lane by lane */
+	class Operand {
+	public:
+		RefKind kind;
+		int index;
+		int values [Lanes];
+		int arrays [Lanes];
+		int elements [Lanes];
+	};
+
+	const unsigned int * image;
+	int width, height;
+	bool verified;
+	/* the engine's, as high as it goes for none */
+	unsigned long long stepLimit;
+
+	std::vector<Group> groups;
+	std::vector<LaneResult568> * results;
+
+	LockstepStats568 stats;
+
+	auto outOfBounds(Group &) -> bool;
+	auto next(Group &) -> unsigned int;
+	auto turn(Group &, unsigned int) -> void;
+	auto fail(Group &, unsigned int, std::string &&) -> void;
+	auto failAll(Group &, const std::string &) -> void;
+	auto turnInside(Group &) -> bool;
+	auto finish(Group &, unsigned int) -> void;
+	auto split(Group &, bool *) -> Group &;
+	auto advance(Group &) -> void;
+
+	auto load(Group &, Operand &, const bool *, const std::string &, bool) -> void;
+	auto applyOperator(Group &, Operand &) -> void;
+	auto parseBranch(Group &) -> void;
+	auto parseSwitch(Group &) -> void;
+	auto parseHeap(Group &) -> void;
+	auto parseOperator1(Group &, unsigned int) -> void;
+	auto parseOperator2(Group &) -> void;
+	auto unaryNot(Group &, bool) -> void;
+	auto execute(Group &) -> bool;
+
+public:
+	explicit LockstepEngine568(Engine568 &);
+
+	auto run(const std::vector<std::vector<int>> &) -> std::vector<LaneResult568>;
+
+	auto getStats() -> LockstepStats568 &;
+};
+
+#endif //LANGUAGE568_LOCKSTEP568_H
@@ -0,0 +1,379 @@
+
+#include "loops568.h"
+
+#include <utility>
+
+#include "engine568.h"
+
+LoopOp::LoopOp(LoopOpKind kind, int value, LoopOperator op, int x, int y, int dx, int dy, unsigned int color) :
+	kind(kind), value(value), op(op), x(x), y(y), dx(dx), dy(dy), color(color) {}
+
+LoopStatement::LoopStatement(LoopIdiom idiom, int target, int source, int value, bool literal) :
+	idiom(idiom), target(target), source(source), value(value), literal(literal) {}
+
+Loop568::Loop568() :
+	whenTaken(true),
+	ops(),
+	counted(false),
+	counter(0),
+	bound(0),
+	boundLiteral(false),
+	statements() {}
+
+LoopStats568::LoopStats568() : loops(0), entries(0), iterations(0), bulkIterations(0) {}
+
+static auto registerIndex(unsigned int color) -> int {
+	switch (color) {
+		case Engine568::RED: return 0;
+		case Engine568::YELLOW: return 1;
+		case Engine568::GREEN: return 2;
+		case Engine568::CYAN: return 3;
+		case Engine568::BLUE: return 4;
+		case Engine568::MAGENTA: return 5;
+		default: return -1;
+	}
+}
+
+/* the operator an arithmetic color stands for after a blue, or after a magenta magenta */
+static auto arithmetic(unsigned int color, bool compound) -> LoopOperator {
+	auto offset = compound ? int(LoopOperator::COMPOUND_ADD) - int(LoopOperator::ADD) : 0;
+
+	switch (color) {
+		case Engine568::RED: return LoopOperator(int(LoopOperator::ADD) + offset);
+		case Engine568::YELLOW: return LoopOperator(int(LoopOperator::SUBTRACT) + offset);
+		case Engine568::GREEN: return LoopOperator(int(LoopOperator::MULTIPLY) + offset);
+		case Engine568::CYAN: return LoopOperator(int(LoopOperator::DIVIDE) + offset);
+		case Engine568::BLUE: return LoopOperator(int(LoopOperator::MODULO) + offset);
+		default: return LoopOperator::NONE;
+	}
+}
+
+static auto isValue(const LoopOp & op) -> bool {
+	return op.kind == LoopOpKind::LITERAL || op.kind == LoopOpKind::REGISTER || op.kind == LoopOpKind::ELEMENT;
+}
+
+LoopFinder568::LoopFinder568(const unsigned int * image, unsigned int width, unsigned int height) :
+	image(image),
+	grid(nullptr),
+	width(int(width)),
+	height(int(height)),
+	branchX(0), branchY(0),
+	branchDX(0), branchDY(0),
+	x(0), y(0),
+	dx(0), dy(0) {}
+
+LoopFinder568::LoopFinder568(const PackedGrid568 & grid) :
+	image(nullptr),
+	grid(&grid),
+	width(int(grid.getWidth())),
+	height(int(grid.getHeight())),
+	branchX(0), branchY(0),
+	branchDX(0), branchDY(0),
+	x(0), y(0),
+	dx(0), dy(0) {}
+
+/**
+ * moves the cursor onto the next colored pixel
+ *
+ * @return its color, or 0 if it went out of bounds first
+ */
+auto LoopFinder568::next() -> unsigned int {
+	while (true) {
+		x += dx;
+		y += dy;
+
+		if (x < 0 || y < 0 || x >= width || y >= height) return 0;
+
+		auto current = grid != nullptr ? grid->rgb(x, y) : image[y * width + x];
+		if (registerIndex(current) != -1) return current;
+	}
+}
+
+/**
+ * @return false if the color is not a direction
+ */
+auto LoopFinder568::turn(unsigned int color) -> bool {
+	switch (color) {
+		case Engine568::RED: dx = 1; dy = 0; return true;
+		case Engine568::YELLOW: dx = 0; dy = -1; return true;
+		case Engine568::GREEN: dx = -1; dy = 0; return true;
+		case Engine568::CYAN: dx = 0; dy = 1; return true;
+		default: return false;
+	}
+}
+
+auto LoopFinder568::decodeValue(Loop568 & loop, int instructionX, int instructionY, int instructionDX, int instructionDY) -> bool {
+	auto value = 1;
+
+	auto add = [&](LoopOpKind kind, int operand) {
+		loop.ops.emplace_back(kind, operand, LoopOperator::NONE, instructionX, instructionY, instructionDX, instructionDY, Engine568::GREEN);
+		return true;
+	};
+
+	while (true) {
+		switch (next()) {
+			case Engine568::RED: {
+				auto index = registerIndex(next());
+				return index != -1 && add(LoopOpKind::REGISTER, index);
+			}
+			case Engine568::YELLOW: {
+				auto index = registerIndex(next());
+				return index != -1 && add(LoopOpKind::ELEMENT, index);
+			}
+			case Engine568::GREEN: {
+				value <<= 1;
+				value += 1;
+				break;
+			}
+			case Engine568::CYAN: {
+				value <<= 1;
+				break;
+			}
+			case Engine568::BLUE: return add(LoopOpKind::LITERAL, value);
+			case Engine568::MAGENTA: return add(LoopOpKind::LITERAL, 0);
+			default: return false;
+		}
+	}
+}
+
+/**
+ * decodes instructions from a starting cursor until they lead back into the branch
+ *
+ * @return true if they did, with no operator left waiting across the branch
+ */
+auto LoopFinder568::walk(int startX, int startY, int startDX, int startDY, Loop568 & loop) -> bool {
+	x = startX;
+	y = startY;
+	dx = startDX;
+	dy = startDY;
+
+	auto pending = false;
+
+	while (loop.ops.size() < MAX_OPS) {
+		auto rgb = next();
+
+		auto instructionX = x, instructionY = y;
+		auto instructionDX = dx, instructionDY = dy;
+
+		auto add = [&](LoopOpKind kind, LoopOperator op) {
+			loop.ops.emplace_back(kind, 0, op, instructionX, instructionY, instructionDX, instructionDY, rgb);
+		};
+
+		switch (rgb) {
+			case Engine568::RED: {
+				if (!turn(next())) return false;
+				add(LoopOpKind::TURN, LoopOperator::NONE);
+				break;
+			}
+			case Engine568::YELLOW: {
+				return !pending && x == branchX && y == branchY && dx == branchDX && dy == branchDY;
+			}
+			case Engine568::GREEN: {
+				if (!decodeValue(loop, instructionX, instructionY, instructionDX, instructionDY)) return false;
+				pending = false;
+				break;
+			}
+			case Engine568::BLUE: {
+				auto color = next();
+
+				if (color == Engine568::MAGENTA) {
+					add(LoopOpKind::NOT, LoopOperator::NONE);
+
+				} else {
+					auto op = arithmetic(color, false);
+					if (op == LoopOperator::NONE) return false;
+
+					add(LoopOpKind::OPERATOR, op);
+					pending = true;
+				}
+
+				break;
+			}
+			case Engine568::MAGENTA: {
+				switch (next()) {
+					case Engine568::RED: add(LoopOpKind::OPERATOR, LoopOperator::EQUAL); pending = true; break;
+					case Engine568::YELLOW: add(LoopOpKind::OPERATOR, LoopOperator::LESS); pending = true; break;
+					case Engine568::GREEN: add(LoopOpKind::OPERATOR, LoopOperator::GREATER); pending = true; break;
+					case Engine568::CYAN: add(LoopOpKind::PRINT, LoopOperator::NONE); break;
+					case Engine568::BLUE: add(LoopOpKind::OPERATOR, LoopOperator::ASSIGN); pending = true; break;
+					case Engine568::MAGENTA: {
+						auto color = next();
+
+						if (color == Engine568::MAGENTA) {
+							add(LoopOpKind::COMPOUND_NOT, LoopOperator::NONE);
+
+						} else {
+							auto op = arithmetic(color, true);
+							if (op == LoopOperator::NONE) return false;
+
+							add(LoopOpKind::OPERATOR, op);
+							pending = true;
+						}
+
+						break;
+					}
+					default: return false;
+				}
+
+				break;
+			}
+			/* heap instructions and anything out of bounds */
+			default: return false;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * splits the body into value operator value statements and
+ * marks the loop counted if every one of them is an idiom, the last one being counter < bound
+ *
+ * registers an idiom indexes arrays with must step by a constant every iteration,
+ * and registers it reads values from must not change at all, so the iteration count
+ * and every array range are known when the loop is entered
+ */
+auto LoopFinder568::findIdioms(Loop568 & loop) -> void {
+	auto ops = std::vector<const LoopOp *>();
+	for (auto & op : loop.ops) if (op.kind != LoopOpKind::TURN) ops.push_back(&op);
+
+	if (!loop.whenTaken) return;
+
+	auto statements = std::vector<LoopStatement>();
+	auto counter = -1, bound = 0;
+	auto boundLiteral = false;
+
+	auto condition = [&](const LoopOp & value, const LoopOp & less, const LoopOp & limit) {
+		if (value.kind != LoopOpKind::REGISTER || less.op != LoopOperator::LESS || limit.kind == LoopOpKind::ELEMENT) return false;
+
+		counter = value.value;
+		bound = limit.value;
+		boundLiteral = limit.kind == LoopOpKind::LITERAL;
+		return true;
+	};
+
+	for (auto i = 0u; i < ops.size();) {
+		auto remaining = ops.size() - i;
+		if (remaining < 3) return;
+
+		auto & a = *ops[i];
+		auto & op = *ops[i + 1];
+		auto & b = *ops[i + 2];
+
+		if (!isValue(a) || op.kind != LoopOpKind::OPERATOR || !isValue(b)) return;
+
+		/* last statement, counter < bound */
+		if (remaining == 3) {
+			if (!condition(a, op, b)) return;
+			break;
+		}
+
+		auto kind = std::make_pair(a.kind, b.kind);
+
+		if (op.op == LoopOperator::COMPOUND_ADD && kind == std::make_pair(LoopOpKind::LITERAL, LoopOpKind::REGISTER)) {
+			statements.emplace_back(LoopIdiom::INDUCTION, b.value, -1, a.value, true);
+
+		} else if (op.op == LoopOperator::ASSIGN && a.kind != LoopOpKind::ELEMENT && b.kind == LoopOpKind::ELEMENT) {
+			statements.emplace_back(LoopIdiom::FILL, b.value, a.kind == LoopOpKind::REGISTER ? a.value : -1, a.value, a.kind == LoopOpKind::LITERAL);
+
+		} else if (op.op == LoopOperator::ASSIGN && kind == std::make_pair(LoopOpKind::ELEMENT, LoopOpKind::ELEMENT)) {
+			statements.emplace_back(LoopIdiom::COPY, b.value, a.value, 0, false);
+
+		} else if (op.op == LoopOperator::COMPOUND_ADD && kind == std::make_pair(LoopOpKind::ELEMENT, LoopOpKind::REGISTER)) {
+			statements.emplace_back(LoopIdiom::REDUCE, b.value, a.value, 0, false);
+
+		} else {
+			return;
+		}
+
+		/* an induction that runs straight into the condition, counter += step < bound */
+		if (remaining == 5) {
+			if (statements.back().idiom != LoopIdiom::INDUCTION || !condition(b, *ops[i + 3], *ops[i + 4])) return;
+			break;
+		}
+
+		if (!isValue(*ops[i + 3])) return;
+		i += 3;
+	}
+
+	int steps [6] = {};
+	bool induced [6] = {}, indexed [6] = {}, read [6] = {}, reduced [6] = {};
+
+	for (auto & statement : statements) {
+		switch (statement.idiom) {
+			case LoopIdiom::INDUCTION: {
+				if (induced[statement.target]) return;
+				induced[statement.target] = true;
+				steps[statement.target] = statement.value;
+				break;
+			}
+			case LoopIdiom::FILL: {
+				indexed[statement.target] = true;
+				if (!statement.literal) read[statement.source] = true;
+				break;
+			}
+			case LoopIdiom::COPY: {
+				indexed[statement.target] = true;
+				indexed[statement.source] = true;
+				break;
+			}
+			case LoopIdiom::REDUCE: {
+				if (reduced[statement.target]) return;
+				reduced[statement.target] = true;
+				indexed[statement.source] = true;
+				break;
+			}
+		}
+	}
+
+	if (counter == -1 || !induced[counter] || steps[counter] <= 0) return;
+	if (!boundLiteral) read[bound] = true;
+
+	for (auto i = 0; i < 6; ++i) {
+		if (indexed[i] && !induced[i]) return;
+		if (read[i] && (induced[i] || reduced[i])) return;
+		if (reduced[i] && (induced[i] || indexed[i])) return;
+	}
+
+	loop.counted = true;
+	loop.counter = counter;
+	loop.bound = bound;
+	loop.boundLiteral = boundLiteral;
+	loop.statements = std::move(statements);
+}
+
+/**
+ * @param x, y, dx, dy the branch instruction and the direction it is entered in
+ * @return true if one side of the branch comes back around to it
+ */
+auto LoopFinder568::find(int x, int y, int dx, int dy, Loop568 & loop) -> bool {
+	branchX = this->x = x;
+	branchY = this->y = y;
+	branchDX = this->dx = dx;
+	branchDY = this->dy = dy;
+
+	auto direction = next();
+	auto codelX = this->x, codelY = this->y;
+
+	if (!turn(direction)) return false;
+
+	auto takenDX = this->dx, takenDY = this->dy;
+
+	loop.ops.clear();
+
+	if (walk(codelX, codelY, takenDX, takenDY, loop)) {
+		loop.whenTaken = true;
+		findIdioms(loop);
+		return true;
+	}
+
+	loop.ops.clear();
+
+	if (walk(codelX, codelY, dx, dy, loop)) {
+		loop.whenTaken = false;
+		findIdioms(loop);
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,164 @@
+
+#ifndef LANGUAGE568_LOOPS568_H
+#define LANGUAGE568_LOOPS568_H
+
+#include <vector>
+
+#include "packedGrid568.h"
+
+enum class LoopOpKind : unsigned char {
+	/* red, only moves the cursor */
+	TURN,
+	/* green values */
+	LITERAL,
+	REGISTER,
+	ELEMENT,
+	/* blue or magenta, sets the operator waiting for the next value */
+	OPERATOR,
+	/* blue magenta and magenta magenta magenta, written through the last reference */
+	NOT,
+	COMPOUND_NOT,
+	PRINT,
+};
+
+enum class LoopOperator : unsigned char {
+	NONE,
+	ADD,
+	SUBTRACT,
+	MULTIPLY,
+	DIVIDE,
+	MODULO,
+	EQUAL,
+	LESS,
+	GREATER,
+	ASSIGN,
+	COMPOUND_ADD,
+	COMPOUND_SUBTRACT,
+	COMPOUND_MULTIPLY,
+	COMPOUND_DIVIDE,
+	COMPOUND_MODULO,
+};
+
+/**
+ * one decoded instruction of a loop body,
+ * with where it starts so the engine can pick up from it
+ */
+class LoopOp {
+public:
+	LoopOp(LoopOpKind, int, LoopOperator, int, int, int, int, unsigned int);
+
+	LoopOpKind kind;
+	/* literal value or register index */
+	int value;
+	LoopOperator op;
+
+	int x, y;
+	int dx, dy;
+	unsigned int color;
+};
+
+enum class LoopIdiom : unsigned char {
+	/* register += literal */
+	INDUCTION,
+	/* array element = literal or register */
+	FILL,
+	/* array element = other array element */
+	COPY,
+	/* register = array element + register */
+	REDUCE,
+};
+
+/**
+ * a statement of a loop body the engine can run for many iterations at once,
+ * arrays are always indexed by their own register's integer
+ */
+class LoopStatement {
+public:
+	LoopStatement(LoopIdiom, int, int, int, bool);
+
+	LoopIdiom idiom;
+	/* register written, the array register for fill and copy */
+	int target;
+	/* register read, the array register for copy and reduce */
+	int source;
+	/* induction step or filled literal */
+	int value;
+	bool literal;
+};
+
+/**
+ * a cycle through the program that starts and ends at one yellow branch,
+ * with nothing but straight line instructions in between
+ */
+class Loop568 {
+public:
+	Loop568();
+
+	/* the loop continues while the branch is taken, otherwise while it is not */
+	bool whenTaken;
+
+	/* the body from the instruction after the branch back around to it */
+	std::vector<LoopOp> ops;
+
+	/*
+	 * set when the whole body is idiom statements ending in counter < bound,
+	 * so iteration counts and array ranges can be worked out up front
+	 */
+	bool counted;
+	int counter;
+	int bound;
+	bool boundLiteral;
+	std::vector<LoopStatement> statements;
+};
+
+class LoopStats568 {
+public:
+	LoopStats568();
+
+	/* loops the engine has found in its program, and times it ran one */
+	unsigned int loops;
+	unsigned long long entries;
+
+	/* iterations run op by op, and all at once by a counted loop kernel */
+	unsigned long long iterations;
+	unsigned long long bulkIterations;
+};
+
+/**
+ * looks for a loop at a yellow branch by walking both ways out of it
+ * until the walk comes back around to the branch
+ *
+ * only meant for verified programs, walks give up at anything they cannot follow
+ * like other branches and switches, heap instructions, or running out of bounds
+ */
+class LoopFinder568 {
+private:
+	constexpr static unsigned int MAX_OPS = 256;
+
+	/* one or the other */
+	const unsigned int * image;
+	const PackedGrid568 * grid;
+	int width, height;
+
+	/* where the branch starts and the direction it is entered in */
+	int branchX, branchY;
+	int branchDX, branchDY;
+
+	/* cursor */
+	int x, y;
+	int dx, dy;
+
+	auto next() -> unsigned int;
+	auto turn(unsigned int) -> bool;
+	auto walk(int, int, int, int, Loop568 &) -> bool;
+	auto decodeValue(Loop568 &, int, int, int, int) -> bool;
+	auto findIdioms(Loop568 &) -> void;
+
+public:
+	LoopFinder568(const unsigned int *, unsigned int, unsigned int);
+	explicit LoopFinder568(const PackedGrid568 &);
+
+	auto find(int, int, int, int, Loop568 &) -> bool;
+};
+
+#endif //LANGUAGE568_LOOPS568_H
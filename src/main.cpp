@@ -1,26 +1,386 @@
 
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <sstream>
 #include "image/image.h"
 #include "engine568.h"
+#include "trace568.h"
+#include "programProfile568.h"
+#include "perfCounters568.h"
+#include "server568.h"
+#include "supervisor568.h"
+#include "timeline568.h"
 
-int main(int argc, char ** argv) {
-	if (argc != 2) {
-		std::cout << "need 1 argument" << std::endl;
+#ifdef __unix__
+#include <csignal>
+#include <unistd.h>
+#endif
+
+/**
+ * writes the timeline if one was asked for
+ *
+ * @return false if the file could not be written
+ */
+static auto writeTimeline(const char * path) -> bool {
+	if (path == nullptr) return true;
+
+	auto file = std::ofstream(path);
+	Timeline568::write(file);
+
+	if (!file) std::cout << "Could not write timeline to " << path << std::endl;
+
+	return bool(file);
+}
+
+/**
+ * language568 --serve <socket> [--workers <n>] [--cache-mb <n>] [--result-cache-mb <n>] [--result-cache-file <file>] [--timeline <file>] [--steps <n>]
+ */
+static auto serve(int argc, char ** argv) -> int {
+	auto workers = std::max(1u, std::thread::hardware_concurrency());
+	auto cacheMegabytes = 256ull;
+	auto resultMegabytes = 0ull;
+	auto resultPath = std::string();
+	auto timelinePath = static_cast<const char *>(nullptr);
+	/* instructions a run may execute, 0 for no limit */
+	auto stepLimit = 100000000ull;
+
+	for (auto i = 3; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+
+		if (arg == "--workers" && i + 1 < argc) {
+			workers = static_cast<unsigned int>(std::stoul(argv[++i]));
+		} else if (arg == "--cache-mb" && i + 1 < argc) {
+			cacheMegabytes = std::stoull(argv[++i]);
+		} else if (arg == "--result-cache-mb" && i + 1 < argc) {
+			resultMegabytes = std::stoull(argv[++i]);
+		} else if (arg == "--result-cache-file" && i + 1 < argc) {
+			resultPath = argv[++i];
+		} else if (arg == "--timeline" && i + 1 < argc) {
+			timelinePath = argv[++i];
+		} else if (arg == "--steps" && i + 1 < argc) {
+			stepLimit = std::stoull(argv[++i]);
+		} else {
+			argc = 0;
+		}
+	}
+
+	if (argc < 3) {
+		std::cout << "usage: language568 --serve <socket> [--workers <n>] [--cache-mb <n>] [--result-cache-mb <n>] [--result-cache-file <file>] [--timeline <file>] [--steps <n>]" << std::endl;
+		return 2;
+	}
+
+	/* a file to keep results in implies keeping them */
+	if (!resultPath.empty() && resultMegabytes == 0) resultMegabytes = 64;
+
+	Timeline568::enable(timelinePath != nullptr);
+
+	auto server = Server568(argv[2], workers, cacheMegabytes << 20u, resultMegabytes << 20u, stepLimit);
+
+	/* a damaged file only loses the results past the damage, and is written over on shutdown */
+	auto resultError = std::string();
+	if (!resultPath.empty() && !server.getResults().load(resultPath, resultError)) std::cout << resultError << std::endl;
+
+#ifdef __unix__
+	/* interrupts and terminations stop the server cleanly, so the timeline still gets written */
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	auto stopper = std::thread([&server, &signals]() {
+		auto signal = 0;
+		sigwait(&signals, &signal);
+		server.stop();
+	});
+#endif
+
+	std::cout << "Serving on " << argv[2] << " with " << workers << " workers" << std::endl;
+
+	auto served = server.serve();
+
+#ifdef __unix__
+	/* wakes the stopper if no signal came */
+	kill(getpid(), SIGTERM);
+	stopper.join();
+#endif
+
+	if (!served) {
+		std::cout << server.getError() << std::endl;
+		return 1;
+	}
+
+	auto saved = resultPath.empty() || server.getResults().save(resultPath, resultError);
+	if (!saved) std::cout << resultError << std::endl;
+
+	return writeTimeline(timelinePath) && saved ? 0 : 1;
+}
+
+/**
+ * language568 --batch <program.png> [--processes <n>] [--steps <n>] [--timeout-ms <n>] [--no-codels]
+ *
+ * runs the program once per line of integer inputs on standard input, in worker processes,
+ * and writes up each run the way the server does, without the hash line
+ *
+ * a run past the step limit ends with an error, and one past the timeout has its worker killed,
+ * either 0 for no limit
+ *
+ * upscaled images are collapsed to one pixel per codel and positions written up in codels,
+ * --no-codels runs every pixel as a codel
+ */
+static auto batch(int argc, char ** argv) -> int {
+	auto processes = std::max(1u, std::thread::hardware_concurrency());
+	auto stepLimit = 0ull;
+	auto timeoutMilliseconds = 10000u;
+	auto detectCodels = true;
+
+	for (auto i = 3; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+
+		if (arg == "--processes" && i + 1 < argc) {
+			processes = static_cast<unsigned int>(std::stoul(argv[++i]));
+		} else if (arg == "--steps" && i + 1 < argc) {
+			stepLimit = std::stoull(argv[++i]);
+		} else if (arg == "--timeout-ms" && i + 1 < argc) {
+			timeoutMilliseconds = static_cast<unsigned int>(std::stoul(argv[++i]));
+		} else if (arg == "--no-codels") {
+			detectCodels = false;
+		} else {
+			argc = 0;
+		}
+	}
+
+	if (argc < 3) {
+		std::cout << "usage: language568 --batch <program.png> [--processes <n>] [--steps <n>] [--timeout-ms <n>] [--no-codels] < inputs" << std::endl;
 		return 2;
 	}
 
-	auto image = CNGE::Image::fromPNG(argv[1]);
+	auto image = CNGE::Image::fromPNG(argv[2]);
 
 	if (image == nullptr || !image->isValid()) {
 		std::cout << "invalid filename" << std::endl;
 		return 2;
 	}
 
+	auto jobs = std::vector<std::vector<int>>();
+
+	for (auto line = std::string(); std::getline(std::cin, line);) {
+		auto words = std::istringstream(line);
+		auto & inputs = jobs.emplace_back();
+
+		for (auto value = 0; words >> value;) inputs.push_back(value);
+
+		if (!words.eof() || inputs.size() > Supervisor568::MAX_INPUTS) {
+			std::cout << "Bad inputs on line " << jobs.size() << std::endl;
+			return 2;
+		}
+	}
+
+	auto program = Program568(image->getWidth(), image->getHeight(), image->getPixels(), detectCodels);
+	auto supervisor = Supervisor568(program, processes, stepLimit, timeoutMilliseconds);
+
+	if (!supervisor.isRunning()) {
+		std::cout << supervisor.getError() << std::endl;
+		return 1;
+	}
+
+	for (auto & result : supervisor.run(jobs)) {
+		if (result.timedOut) {
+			std::cout << "timed out" << std::endl;
+			continue;
+		}
+
+		if (result.crashed) {
+			std::cout << "crashed " << result.attempts << std::endl;
+			continue;
+		}
+
+		std::cout << "exit " << result.x << " " << result.y << " " << result.steps << std::endl << "registers";
+		for (auto value : result.registers) std::cout << " " << value;
+		std::cout << std::endl;
+
+		if (result.error[0] != '\0') std::cout << "error " << result.error << std::endl;
+
+		std::cout << "output " << result.outputLength << std::endl;
+		std::cout.write(result.output, result.outputLength);
+	}
+
+	if (supervisor.getRestarts() > 0) std::cerr << "Restarted " << supervisor.getRestarts() << " workers" << std::endl;
+
+	return 0;
+}
+
+int main(int argc, char ** argv) {
+	if (argc > 1 && std::string(argv[1]) == "--serve") return serve(argc, argv);
+	if (argc > 1 && std::string(argv[1]) == "--batch") return batch(argc, argv);
+
+	auto tracePath = static_cast<const char *>(nullptr);
+	auto profile = false;
+	auto recordProfile = false;
+	auto verifyOnly = false;
+	auto packed = false;
+	auto progressive = false;
+	auto countersOn = false;
+	auto detectCodels = true;
+	auto timelinePath = static_cast<const char *>(nullptr);
+
+	for (auto i = 2; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+
+		if (arg == "--trace" && i + 1 < argc) {
+			tracePath = argv[++i];
+		} else if (arg == "--profile") {
+			profile = true;
+		} else if (arg == "--record-profile") {
+			recordProfile = true;
+		} else if (arg == "--verify") {
+			verifyOnly = true;
+		} else if (arg == "--packed") {
+			packed = true;
+		} else if (arg == "--progressive") {
+			progressive = true;
+		} else if (arg == "--counters") {
+			countersOn = true;
+		} else if (arg == "--no-codels") {
+			detectCodels = false;
+		} else if (arg == "--timeline" && i + 1 < argc) {
+			timelinePath = argv[++i];
+		} else {
+			argc = 0;
+		}
+	}
+
+	if (argc < 2) {
+		std::cout << "usage: language568 <program.png> [--trace <file>] [--profile] [--record-profile] [--verify] [--packed] [--progressive] [--counters] [--timeline <file>] [--no-codels]" << std::endl;
+		std::cout << "       language568 --serve <socket> [--workers <n>] [--cache-mb <n>] [--result-cache-mb <n>] [--result-cache-file <file>] [--timeline <file>] [--steps <n>]" << std::endl;
+		std::cout << "       language568 --batch <program.png> [--processes <n>] [--steps <n>] [--timeout-ms <n>] [--no-codels] < inputs" << std::endl;
+		return 2;
+	}
+
+	/* hardware counters around each phase, only opened when asked for */
+	auto counters = countersOn ? std::make_unique<PerfCounters568>() : nullptr;
+
+	/* and each phase as a span of the timeline */
+	Timeline568::enable(timelinePath != nullptr);
+	Timeline568::setThreadName("main");
+
+	auto phaseName = "";
+	auto phaseBegin = -1ll;
+
+	auto beginPhase = [&](const char * name) {
+		if (counters != nullptr) counters->begin(name);
+
+		phaseName = name;
+		phaseBegin = TIMELINE568_NOW();
+	};
+
+	auto endPhase = [&]() {
+		TIMELINE568_RECORD(phaseName, phaseBegin);
+
+		if (counters != nullptr) counters->end();
+	};
+
+	auto begin = std::chrono::steady_clock::now();
 	auto engine = Engine568();
-	engine.load(image->getWidth(), image->getHeight(), image->getPixels());
+
+	/* verifying needs the whole image up front */
+	if (progressive && !verifyOnly) {
+		beginPhase("decode header");
+		auto program = Program568::decodePNG(argv[1]);
+		endPhase();
+
+		if (program == nullptr) {
+			std::cout << "invalid filename" << std::endl;
+			return 2;
+		}
+
+		engine.attach(program);
+
+	} else {
+		beginPhase("decode");
+		auto image = CNGE::Image::fromPNG(argv[1]);
+		endPhase();
+
+		if (image == nullptr || !image->isValid()) {
+			std::cout << "invalid filename" << std::endl;
+			return 2;
+		}
+
+		engine.setPackedGrid(packed);
+
+		beginPhase("load");
+		engine.load(image->getWidth(), image->getHeight(), image->getPixels(), detectCodels);
+		endPhase();
+	}
+
+	/* every position reported from here on, exits and errors alike, is in codels of the collapsed image, --no-codels runs the image as drawn instead */
+	auto & stats = engine.getLoadStats();
+	if (stats.codelSize > 1) std::cout << "Detected codel size " << stats.codelSize << " (" << stats.sourceWidth << "x" << stats.sourceHeight << " -> " << stats.width << "x" << stats.height << "), positions are in codels" << std::endl;
+
+	if (verifyOnly) {
+		for (auto & error : engine.getVerifyErrors()) std::cout << error.toString() << std::endl;
+		std::cout << (stats.verified ? "Verified" : "Rejected") << std::endl;
+
+		writeTimeline(timelinePath);
+
+		return stats.verified ? 0 : 1;
+	}
 
 	engine.pushInt(5);
-	engine.run();
+
+	auto profiler = ProfileObserver568();
+
+	/* what happened to the recorded profile, reported after the run */
+	auto recorded = std::string();
+
+	beginPhase("run");
+
+	if (tracePath != nullptr) {
+		auto traceFile = std::ofstream(tracePath, std::ios::binary);
+		auto recorder = TraceRecorder(traceFile);
+		auto observer = TraceObserver568(recorder);
+
+		engine.run(observer);
+
+	} else if (profile) {
+		engine.run(profiler);
+
+	} else if (recordProfile) {
+		/* added to what earlier runs recorded, for transpile568 to pick up */
+		auto profilePath = ProgramProfile568::pathFor(argv[1]);
+		auto programProfile = ProgramProfile568();
+		auto profileError = std::string();
+
+		if (programProfile.load(profilePath, profileError)) {
+			auto observer = ProgramProfileObserver568(programProfile);
+			engine.run(observer);
+
+			if (programProfile.save(profilePath, profileError)) recorded = "Profile of " + std::to_string(programProfile.getRuns()) + " runs written to " + profilePath;
+		}
+
+		if (!profileError.empty()) recorded = profileError;
+
+	} else if (progressive) {
+		engine.start();
+		auto firstInstruction = std::chrono::steady_clock::now();
+
+		while (engine.step());
+		auto end = std::chrono::steady_clock::now();
+
+		std::cout << std::endl << "First instruction after " << std::chrono::duration<double, std::milli>(firstInstruction - begin).count()
+			<< " ms, finished after " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms";
+
+	} else {
+		engine.run();
+	}
+
+	endPhase();
+
 	std::cout << std::endl;
 
 	auto err = engine.getError();
@@ -28,5 +388,23 @@ int main(int argc, char ** argv) {
 
 	std::cout << "Exited at " << engine.getX() << ", " << engine.getY() << std::endl;
 
-	return 0;
+	if (engine.getProgram()->hasDecodeError()) std::cout << "Image could not be fully decoded" << std::endl;
+
+	if (!recorded.empty()) std::cout << recorded << std::endl;
+
+	if (profile && tracePath == nullptr) {
+		const char * names [6] = { "red", "yellow", "green", "cyan", "blue", "magenta" };
+
+		std::cout << "Instructions: " << engine.getSteps() << ", fetches: " << profiler.fetches << std::endl;
+		for (auto i = 0; i < 6; ++i) std::cout << "  " << names[i] << ": " << profiler.instructions[i] << std::endl;
+		std::cout << "Branches taken: " << profiler.branchesTaken << ", not taken: " << profiler.branchesNotTaken << ", switches: " << profiler.switches << std::endl;
+		std::cout << "Allocations: " << profiler.allocations << " (" << profiler.allocatedElements << " elements), printed: " << profiler.printed << std::endl;
+	}
+
+	if (counters != nullptr) {
+		std::cout << "Counters:" << std::endl;
+		counters->report(std::cout);
+	}
+
+	return writeTimeline(timelinePath) ? 0 : 1;
 }
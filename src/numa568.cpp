@@ -0,0 +1,125 @@
+
+#include "numa568.h"
+
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <exception>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* from the kernel's mempolicy.h, which only libnuma's numaif.h otherwise brings in */
+constexpr static int MPOL_PREFERRED_NODE = 1;
+#endif
+
+/**
+ * reads a sysfs list like 0-3,8-11
+ *
+ * @return every number in it, empty if the file is not there
+ */
+auto Numa568::readList(const char * path) -> std::vector<unsigned int> {
+	auto file = std::ifstream(path);
+	auto list = std::string();
+	auto numbers = std::vector<unsigned int>();
+
+	if (!std::getline(file, list)) return numbers;
+
+	for (auto begin = std::size_t(0); begin < list.size();) {
+		auto end = list.find(',', begin);
+		if (end == std::string::npos) end = list.size();
+
+		auto range = list.substr(begin, end - begin);
+		auto dash = range.find('-');
+
+		try {
+			auto first = std::stoul(range);
+			auto last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+			for (auto number = first; number <= last; ++number) numbers.push_back(static_cast<unsigned int>(number));
+
+		} catch (const std::exception &) {
+			return {};
+		}
+
+		begin = end + 1;
+	}
+
+	return numbers;
+}
+
+/**
+ * @return one more than the highest online node, at least 1
+ */
+auto Numa568::getNumNodes() -> unsigned int {
+	static auto numNodes = []() {
+		auto nodes = readList("/sys/devices/system/node/online");
+
+		auto highest = 0u;
+		for (auto node : nodes) highest = std::max(highest, node);
+
+		return highest + 1;
+	}();
+
+	return numNodes;
+}
+
+auto Numa568::getNodeCpus(unsigned int node) -> std::vector<unsigned int> {
+	auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+
+	return readList(path.c_str());
+}
+
+/**
+ * @return the node of the cpu the calling thread is on right now, 0 if it cannot be told
+ */
+auto Numa568::getCurrentNode() -> unsigned int {
+#ifdef __linux__
+	unsigned int cpu = 0, node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return node;
+#endif
+
+	return 0;
+}
+
+/**
+ * keeps the calling thread on the cpus of a node
+ *
+ * @return false if the node has no cpus listed or the affinity could not be set
+ */
+auto Numa568::pinToNode(unsigned int node) -> bool {
+#ifdef __linux__
+	auto cpus = getNodeCpus(node);
+	if (cpus.empty()) return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (auto cpu : cpus) if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+/**
+ * has memory the calling thread touches first come from a node while the node has room,
+ * the thread keeps this policy until it ends
+ *
+ * @return false if the policy could not be set, first touch on whichever node the thread runs on still applies
+ */
+auto Numa568::preferNode(unsigned int node) -> bool {
+#ifdef __linux__
+	auto mask = 0ul;
+	if (node >= sizeof(mask) * 8) return false;
+
+	mask = 1ul << node;
+
+	return syscall(SYS_set_mempolicy, MPOL_PREFERRED_NODE, &mask, sizeof(mask) * 8) == 0;
+#else
+	return false;
+#endif
+}
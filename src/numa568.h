@@ -0,0 +1,27 @@
+
+#ifndef LANGUAGE568_NUMA568_H
+#define LANGUAGE568_NUMA568_H
+
+#include <vector>
+
+/**
+ * which NUMA node a thread runs on and allocates from,
+ * read from sysfs and set through the system calls themselves so libnuma is not needed
+ *
+ * single node machines, containers that forbid it, and everything off linux
+ * see one node 0 and pinning and preferring do nothing
+ */
+class Numa568 {
+private:
+	static auto readList(const char *) -> std::vector<unsigned int>;
+
+public:
+	static auto getNumNodes() -> unsigned int;
+	static auto getNodeCpus(unsigned int) -> std::vector<unsigned int>;
+	static auto getCurrentNode() -> unsigned int;
+
+	static auto pinToNode(unsigned int) -> bool;
+	static auto preferNode(unsigned int) -> bool;
+};
+
+#endif //LANGUAGE568_NUMA568_H
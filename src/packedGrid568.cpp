@@ -0,0 +1,120 @@
+
+#include "packedGrid568.h"
+
+#include <bit>
+#include <algorithm>
+
+/* the bottom bit of every row of a tile */
+constexpr static std::uint64_t COLUMN = 0x0101010101010101ull;
+
+static auto code(unsigned int rgb) -> unsigned int {
+	switch (rgb) {
+		case 0xFF0000: return 1;
+		case 0xFFFF00: return 2;
+		case 0x00FF00: return 3;
+		case 0x00FFFF: return 4;
+		case 0x0000FF: return 5;
+		case 0xFF00FF: return 6;
+		default: return 0;
+	}
+}
+
+PackedGrid568::PackedGrid568() : width(0), height(0), tilesWide(0), tiles() {}
+
+PackedGrid568::PackedGrid568(const unsigned int * image, unsigned int width, unsigned int height) :
+	width(width),
+	height(height),
+	tilesWide((width + 7) / 8),
+	tiles(static_cast<std::size_t>(tilesWide) * ((height + 7) / 8), Tile { { 0, 0, 0 } })
+{
+	for (auto j = 0u; j < height; ++j) {
+		for (auto i = 0u; i < width; ++i) {
+			auto pixel = code(image[j * width + i]);
+			auto & planes = tiles[(j >> 3) * tilesWide + (i >> 3)].planes;
+			auto bit = ((j & 7) << 3) | (i & 7);
+
+			for (auto plane = 0; plane < 3; ++plane)
+				planes[plane] |= std::uint64_t((pixel >> plane) & 1u) << bit;
+		}
+	}
+}
+
+/**
+ * moves a cursor one pixel at a time in a direction until it lands on a color,
+ * the same as stepping through the unpacked image but skipping empty tile rows and columns whole
+ *
+ * @return the color landed on, or 0 with the cursor on the first pixel out of bounds
+ */
+auto PackedGrid568::next(int & x, int & y, int dx, int dy) const -> unsigned int {
+	auto lastX = int(width) - 1, lastY = int(height) - 1;
+
+	while (true) {
+		x += dx;
+		y += dy;
+
+		if (x < 0 || y < 0 || x > lastX || y > lastY) return 0;
+
+		auto & planes = tile(x, y).planes;
+		auto occupied = planes[0] | planes[1] | planes[2];
+		auto column = x & 7, row = y & 7;
+
+		if (dy == 0) {
+			auto bits = (occupied >> (row << 3)) & 0xffu;
+
+			if (dx > 0) {
+				auto ahead = bits >> column;
+				if (ahead != 0) return x += std::countr_zero(ahead), rgb(x, y);
+
+				/* the last pixel of this tile row, the next step leaves it */
+				x = std::min(x | 7, lastX);
+
+			} else {
+				auto behind = bits & ((2u << column) - 1u);
+				if (behind != 0) return x = (x & ~7) + 63 - std::countl_zero(behind), rgb(x, y);
+
+				x &= ~7;
+			}
+
+		} else {
+			auto bits = (occupied >> column) & COLUMN;
+
+			if (dy > 0) {
+				auto ahead = bits >> (row << 3);
+				if (ahead != 0) return y += std::countr_zero(ahead) >> 3, rgb(x, y);
+
+				y = std::min(y | 7, lastY);
+
+			} else {
+				auto behind = row == 7 ? bits : bits & ((std::uint64_t(1) << ((row + 1) << 3)) - 1u);
+				if (behind != 0) return y = (y & ~7) + ((63 - std::countl_zero(behind)) >> 3), rgb(x, y);
+
+				y &= ~7;
+			}
+		}
+	}
+}
+
+/**
+ * @return the image at 32 bits per pixel again, with all filler white
+ */
+auto PackedGrid568::unpack() const -> ProgramImage568 {
+	auto image = ProgramImage568(static_cast<std::size_t>(width) * height);
+
+	for (auto j = 0u; j < height; ++j)
+		for (auto i = 0u; i < width; ++i)
+			image[j * width + i] = rgb(int(i), int(j));
+
+	return image;
+}
+
+auto PackedGrid568::getWidth() const -> unsigned int {
+	return width;
+}
+
+auto PackedGrid568::getHeight() const -> unsigned int {
+	return height;
+}
+
+auto PackedGrid568::getBytes() const -> std::size_t {
+	return tiles.size() * sizeof(Tile);
+}
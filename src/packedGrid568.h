@@ -0,0 +1,71 @@
+
+#ifndef LANGUAGE568_PACKEDGRID568_H
+#define LANGUAGE568_PACKEDGRID568_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "hugePages568.h"
+
+/**
+ * a program image at 3 bits per pixel, only telling apart the six instruction colors and filler
+ *
+ * pixels are stored in 8 x 8 tiles as three bitplanes of one 64 bit word each,
+ * so a step in any direction usually stays in the same few words,
+ * and runs of filler are skipped a tile row or column at a time
+ */
+class PackedGrid568 {
+private:
+	class Tile {
+	public:
+		std::uint64_t planes [3];
+	};
+
+	unsigned int width, height;
+	unsigned int tilesWide;
+	std::vector<Tile, HugePageAllocator568<Tile>> tiles;
+
+	auto tile(int, int) const -> const Tile &;
+
+public:
+	/* rgb of each code, 0 for filler which comes back white, 7 is unused */
+	constexpr static unsigned int COLORS [8] = {
+		0xFFFFFF, 0xFF0000, 0xFFFF00, 0x00FF00, 0x00FFFF, 0x0000FF, 0xFF00FF, 0xFFFFFF
+	};
+
+	PackedGrid568();
+	PackedGrid568(const unsigned int *, unsigned int, unsigned int);
+
+	auto at(int, int) const -> unsigned int;
+	auto rgb(int, int) const -> unsigned int;
+	auto next(int &, int &, int, int) const -> unsigned int;
+
+	auto unpack() const -> ProgramImage568;
+
+	auto getWidth() const -> unsigned int;
+	auto getHeight() const -> unsigned int;
+	auto getBytes() const -> std::size_t;
+};
+
+/* hot, inline so the engine's fetch folds them in */
+
+inline auto PackedGrid568::tile(int x, int y) const -> const Tile & {
+	return tiles[(y >> 3) * tilesWide + (x >> 3)];
+}
+
+/**
+ * @return the code of a pixel, 0 for filler and 1 to 6 for red through magenta
+ */
+inline auto PackedGrid568::at(int x, int y) const -> unsigned int {
+	auto & planes = tile(x, y).planes;
+	auto bit = ((y & 7) << 3) | (x & 7);
+
+	return ((planes[0] >> bit) & 1u) | (((planes[1] >> bit) & 1u) << 1u) | (((planes[2] >> bit) & 1u) << 2u);
+}
+
+inline auto PackedGrid568::rgb(int x, int y) const -> unsigned int {
+	return COLORS[at(x, y)];
+}
+
+#endif //LANGUAGE568_PACKEDGRID568_H
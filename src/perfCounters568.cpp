@@ -0,0 +1,202 @@
+
+#include "perfCounters568.h"
+
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+PerfSample568::PerfSample568() : milliseconds(0.0), counts { -1, -1, -1, -1, -1 } {}
+
+auto PerfSample568::has(PerfCounter568 counter) const -> bool {
+	return counts[int(counter)] >= 0;
+}
+
+auto PerfSample568::get(PerfCounter568 counter) const -> long long {
+	return counts[int(counter)];
+}
+
+PerfPhase568::PerfPhase568(std::string && name, const PerfSample568 & sample) : name(name), sample(sample) {}
+
+const char * PerfCounters568::counterNames [PerfSample568::NUM_COUNTERS] = {
+	"cycles",
+	"instructions",
+	"branch misses",
+	"cache misses",
+	"dTLB misses"
+};
+
+#ifdef __linux__
+/**
+ * @return the counter's file descriptor, -1 if it cannot be opened here
+ */
+static auto openCounter(unsigned int type, unsigned long long config) -> int {
+	auto attributes = perf_event_attr();
+	std::memset(&attributes, 0, sizeof(attributes));
+
+	attributes.size = sizeof(attributes);
+	attributes.type = type;
+	attributes.config = config;
+	attributes.disabled = 1;
+
+	/* user space only, which is all the default paranoia level allows anyway */
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	/* to scale counts up if the counters had to share hardware */
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+#endif
+
+PerfCounters568::PerfCounters568() :
+	fds { -1, -1, -1, -1, -1 },
+	unavailable(),
+	phaseName(),
+	phaseBegin(),
+	phases()
+{
+#ifdef __linux__
+	constexpr static unsigned int types [PerfSample568::NUM_COUNTERS] = {
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HW_CACHE
+	};
+
+	constexpr static unsigned long long configs [PerfSample568::NUM_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_BRANCH_MISSES,
+		PERF_COUNT_HW_CACHE_MISSES,
+		/* cache, operation and result a byte each */
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+	};
+
+	for (auto i = 0u; i < PerfSample568::NUM_COUNTERS; ++i) {
+		fds[i] = openCounter(types[i], configs[i]);
+		if (fds[i] < 0 && unavailable.empty()) unavailable = std::string(counterNames[i]) + ": " + std::strerror(errno);
+	}
+
+	if (isAvailable()) unavailable.clear();
+#else
+	unavailable = "hardware counters are only read on linux";
+#endif
+}
+
+PerfCounters568::~PerfCounters568() {
+#ifdef __linux__
+	for (auto fd : fds) if (fd >= 0) close(fd);
+#endif
+}
+
+/**
+ * @return true if at least one counter could be opened
+ */
+auto PerfCounters568::isAvailable() -> bool {
+	for (auto fd : fds) if (fd >= 0) return true;
+
+	return false;
+}
+
+/**
+ * @return why the first counter that failed to open did, empty if they all opened
+ */
+auto PerfCounters568::getUnavailableReason() -> const std::string & {
+	return unavailable;
+}
+
+/**
+ * zeroes and starts every counter, phases do not nest
+ */
+auto PerfCounters568::begin(std::string && name) -> void {
+	phaseName = std::move(name);
+
+#ifdef __linux__
+	for (auto fd : fds) {
+		if (fd < 0) continue;
+
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+
+	/* last so the clock does not count setting up the counters */
+	phaseBegin = std::chrono::steady_clock::now();
+}
+
+/**
+ * stops the counters and records the phase begun last
+ *
+ * @return the phase's sample
+ */
+auto PerfCounters568::end() -> const PerfSample568 & {
+	auto phaseEnd = std::chrono::steady_clock::now();
+	auto sample = PerfSample568();
+
+#ifdef __linux__
+	for (auto i = 0u; i < PerfSample568::NUM_COUNTERS; ++i) {
+		if (fds[i] < 0) continue;
+
+		ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+		/* value, time enabled, time running */
+		unsigned long long values [3] = {};
+		if (read(fds[i], values, sizeof(values)) != sizeof(values) || values[2] == 0) continue;
+
+		sample.counts[i] = static_cast<long long>(values[2] < values[1] ? double(values[0]) * double(values[1]) / double(values[2]) : double(values[0]));
+	}
+#endif
+
+	sample.milliseconds = std::chrono::duration<double, std::milli>(phaseEnd - phaseBegin).count();
+	phases.emplace_back(std::move(phaseName), sample);
+
+	return phases.back().sample;
+}
+
+auto PerfCounters568::getPhases() -> const std::vector<PerfPhase568> & {
+	return phases;
+}
+
+auto PerfCounters568::clear() -> void {
+	phases.clear();
+}
+
+auto PerfCounters568::getCounterName(PerfCounter568 counter) -> const char * {
+	return counterNames[int(counter)];
+}
+
+/**
+ * writes one line per phase with its wall time, every counter that could be read,
+ * and instructions per cycle if both were
+ */
+auto PerfCounters568::report(std::ostream & out) -> void {
+	if (!isAvailable()) out << "Counters unavailable (" << unavailable << "), wall time only" << std::endl;
+
+	for (auto & phase : phases) {
+		auto & sample = phase.sample;
+
+		out << "  " << phase.name << ": " << sample.milliseconds << " ms";
+
+		for (auto i = 0u; i < PerfSample568::NUM_COUNTERS; ++i) {
+			if (fds[i] < 0) continue;
+
+			out << ", ";
+			if (sample.counts[i] >= 0) out << sample.counts[i];
+			else out << "n/a";
+			out << " " << counterNames[i];
+		}
+
+		if (sample.has(PerfCounter568::CYCLES) && sample.has(PerfCounter568::INSTRUCTIONS) && sample.get(PerfCounter568::CYCLES) > 0)
+			out << ", " << double(sample.get(PerfCounter568::INSTRUCTIONS)) / double(sample.get(PerfCounter568::CYCLES)) << " IPC";
+
+		out << std::endl;
+	}
+}
@@ -0,0 +1,82 @@
+
+#ifndef LANGUAGE568_PERFCOUNTERS568_H
+#define LANGUAGE568_PERFCOUNTERS568_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ostream>
+
+enum class PerfCounter568 : unsigned char {
+	CYCLES,
+	INSTRUCTIONS,
+	BRANCH_MISSES,
+	CACHE_MISSES,
+	/* data reads that missed the TLB, what huge pages bring down */
+	TLB_MISSES,
+};
+
+/**
+ * what the counters read over one phase, with its wall time
+ */
+class PerfSample568 {
+public:
+	constexpr static unsigned int NUM_COUNTERS = 5;
+
+	PerfSample568();
+
+	double milliseconds;
+
+	/* -1 for counters that could not be opened or never got scheduled */
+	long long counts [NUM_COUNTERS];
+
+	auto has(PerfCounter568) const -> bool;
+	auto get(PerfCounter568) const -> long long;
+};
+
+class PerfPhase568 {
+public:
+	PerfPhase568(std::string &&, const PerfSample568 &);
+
+	std::string name;
+	PerfSample568 sample;
+};
+
+/**
+ * hardware counters of the calling thread around named phases, through perf_event_open on linux
+ *
+ * every counter is opened on its own, so hosts that only allow some of them still report those,
+ * and where none can be opened, in containers or off linux, phases still get their wall time
+ */
+class PerfCounters568 {
+private:
+	static const char * counterNames [PerfSample568::NUM_COUNTERS];
+
+	int fds [PerfSample568::NUM_COUNTERS];
+	std::string unavailable;
+
+	std::string phaseName;
+	std::chrono::steady_clock::time_point phaseBegin;
+	std::vector<PerfPhase568> phases;
+
+public:
+	PerfCounters568();
+	~PerfCounters568();
+
+	PerfCounters568(const PerfCounters568 &) = delete;
+	auto operator=(const PerfCounters568 &) -> PerfCounters568 & = delete;
+
+	auto isAvailable() -> bool;
+	auto getUnavailableReason() -> const std::string &;
+
+	auto begin(std::string &&) -> void;
+	auto end() -> const PerfSample568 &;
+
+	auto getPhases() -> const std::vector<PerfPhase568> &;
+	auto clear() -> void;
+
+	static auto getCounterName(PerfCounter568) -> const char *;
+	auto report(std::ostream &) -> void;
+};
+
+#endif //LANGUAGE568_PERFCOUNTERS568_H
@@ -0,0 +1,403 @@
+
+#include "program568.h"
+
+#include <numeric>
+#include <algorithm>
+
+#include "image/imageUtil.h"
+#include "image/pngReader.h"
+#include "timeline568.h"
+
+/**
+ * converts, collapses, verifies and optionally packs a program image
+ *
+ * @param rgba the source image, 4 bytes per pixel, only read while constructing
+ * @param detectCodels when true, images drawn at a uniform scale
+ * are collapsed down to one pixel per codel, and every position engines report after,
+ * exits, errors and verify errors alike, is then in codels rather than source pixels
+ * @param packed when true the program is kept as a 3 bit per pixel grid
+ */
+Program568::Program568(unsigned int width, unsigned int height, const unsigned char * rgba, bool detectCodels, bool packed) :
+	image(static_cast<std::size_t>(width) * height),
+	grid(),
+	pixels(nullptr),
+	storage(),
+	width(width),
+	height(height),
+	loadStats(),
+	verifyErrors(),
+	loopMutex(),
+	loops(),
+	loopAt(),
+	rowsReady(),
+	cancelDecode(false),
+	decodeFailed(false),
+	decoder(),
+	unpackOnce(),
+	unpacked()
+{
+	for (auto i = 0u; i < width * height; ++i)
+		image[i] = (rgba[i * 4] << 16u) | (rgba[i * 4 + 1] << 8u) | rgba[i * 4 + 2];
+
+	loadStats.sourceWidth = width;
+	loadStats.sourceHeight = height;
+
+	if (detectCodels) {
+		TIMELINE568_SPAN("detect codels");
+
+		auto codelSize = detectCodelSize();
+		if (codelSize > 1) downscale(codelSize);
+	}
+
+	loadStats.width = this->width;
+	loadStats.height = this->height;
+
+	{
+		TIMELINE568_SPAN("verify");
+
+		auto verifier = Verifier568(image.data(), this->width, this->height);
+		loadStats.verified = verifier.verify();
+		verifyErrors = std::move(verifier.getErrors());
+	}
+
+	loadStats.packed = packed;
+	rowsReady = this->height;
+
+	if (packed) {
+		TIMELINE568_SPAN("pack");
+
+		grid = PackedGrid568(image.data(), this->width, this->height);
+
+		/* the grid stands in for the image from here on */
+		image = ProgramImage568();
+	}
+
+	pixels = packed ? nullptr : image.data();
+}
+
+/**
+ * an empty program of the size of an image about to be decoded into it
+ */
+Program568::Program568(unsigned int width, unsigned int height) :
+	image(static_cast<std::size_t>(width) * height, 0xFFFFFF),
+	grid(),
+	pixels(image.data()),
+	storage(),
+	width(width),
+	height(height),
+	loadStats(),
+	verifyErrors(),
+	loopMutex(),
+	loops(),
+	loopAt(),
+	rowsReady(0),
+	cancelDecode(false),
+	decodeFailed(false),
+	decoder(),
+	unpackOnce(),
+	unpacked()
+{
+	loadStats.sourceWidth = width;
+	loadStats.sourceHeight = height;
+	loadStats.width = width;
+	loadStats.height = height;
+}
+
+Program568::~Program568() {
+	if (decoder.joinable()) {
+		cancelDecode = true;
+		decoder.join();
+	}
+}
+
+/**
+ * reads the header of a png and decodes the rest of it on another thread,
+ * so engines can start running the top of a tall program straight away
+ * and only wait when they reach a row that is not decoded yet
+ *
+ * the image is taken as drawn at one pixel per codel, and as nothing is known
+ * about the rows below until they arrive the program is never verified or packed
+ *
+ * @return nullptr if the file could not be opened
+ */
+auto Program568::decodePNG(const char * path) -> std::shared_ptr<const Program568> {
+	auto reader = CNGE::PNGReader::open(path);
+	if (reader == nullptr) return nullptr;
+
+	auto program = std::shared_ptr<Program568>(new Program568(reader->getWidth(), reader->getHeight()));
+
+	/* the program joins the decoder before it goes, so the decoder can hold on to it by pointer */
+	program->decoder = std::thread([program = program.get(), reader = std::move(reader)]() {
+		Timeline568::setThreadName("png decoder");
+		TIMELINE568_SPAN("decode rows");
+
+		for (auto j = 0u; j < program->height && !program->cancelDecode; ++j) {
+			auto * rgba = reader->readRow();
+
+			/* what could not be decoded is left as filler */
+			if (rgba == nullptr) {
+				program->decodeFailed = true;
+				program->rowsReady.store(program->height, std::memory_order_release);
+				program->rowsReady.notify_all();
+				return;
+			}
+
+			auto * row = program->image.data() + static_cast<std::size_t>(j) * program->width;
+
+			for (auto i = 0u; i < program->width; ++i)
+				row[i] = (rgba[i * 4] << 16u) | (rgba[i * 4 + 1] << 8u) | rgba[i * 4 + 2];
+
+			program->rowsReady.store(j + 1, std::memory_order_release);
+			program->rowsReady.notify_all();
+		}
+	});
+
+	return program;
+}
+
+/**
+ * copies the program into storage first touched by the calling thread,
+ * so a thread running on a NUMA node makes a replica that lives on that node
+ *
+ * a replica finds loops again for itself as its engines reach them
+ */
+auto Program568::replicate() const -> std::shared_ptr<const Program568> {
+	waitForRows(height);
+
+	auto replica = std::shared_ptr<Program568>(new Program568(0, 0));
+
+	if (pixels != nullptr) replica->image.assign(pixels, pixels + static_cast<std::size_t>(width) * height);
+	replica->pixels = pixels != nullptr ? replica->image.data() : nullptr;
+	replica->grid = grid;
+	replica->width = width;
+	replica->height = height;
+	replica->loadStats = loadStats;
+	replica->verifyErrors = verifyErrors;
+	replica->rowsReady = height;
+	replica->decodeFailed = decodeFailed.load();
+
+	return replica;
+}
+
+/**
+ * a program over an image someone else loaded, like one mapped from shared memory,
+ * that is neither copied nor verified again
+ *
+ * @param pixels one 0xRRGGBB color per codel, as wide and tall as the load stats say
+ * @param storage kept for as long as the program is, whatever keeps pixels valid
+ */
+auto Program568::view(const unsigned int * pixels, const LoadStats & loadStats, std::shared_ptr<const void> storage) -> std::shared_ptr<const Program568> {
+	auto program = std::shared_ptr<Program568>(new Program568(0, 0));
+
+	program->pixels = pixels;
+	program->storage = std::move(storage);
+	program->width = loadStats.width;
+	program->height = loadStats.height;
+	program->loadStats = loadStats;
+	program->loadStats.packed = false;
+	program->rowsReady = loadStats.height;
+
+	return program;
+}
+
+/**
+ * finds the largest block size that every run of color in the image,
+ * both along rows and down columns, is a multiple of
+ *
+ * @return the detected codel size, or 1 if the image is not uniformly scaled
+ */
+auto Program568::detectCodelSize() -> unsigned int {
+	if (width == 0 || height == 0) return 1;
+
+	auto codelSize = 0u;
+
+	/* horizontal runs */
+	for (auto j = 0u; j < height && codelSize != 1; ++j) {
+		auto * row = image.data() + j * width;
+		auto runStart = 0u;
+
+		for (auto i = 1u; i < width; ++i) {
+			if (row[i] != row[i - 1]) {
+				codelSize = std::gcd(codelSize, i - runStart);
+				runStart = i;
+			}
+		}
+
+		codelSize = std::gcd(codelSize, width - runStart);
+	}
+
+	/* vertical runs, tracked for every column at once so we scan row by row */
+	auto runStarts = std::vector<unsigned int>(width, 0);
+
+	for (auto j = 1u; j < height && codelSize != 1; ++j) {
+		auto * row = image.data() + j * width;
+		auto * above = row - width;
+
+		for (auto i = 0u; i < width; ++i) {
+			if (row[i] != above[i]) {
+				codelSize = std::gcd(codelSize, j - runStarts[i]);
+				runStarts[i] = j;
+			}
+		}
+	}
+
+	for (auto i = 0u; i < width && codelSize != 1; ++i)
+		codelSize = std::gcd(codelSize, height - runStarts[i]);
+
+	if (codelSize <= 1) return 1;
+
+	/* every block must be one solid color for the collapse to be lossless */
+	for (auto j = 0u; j < height; ++j) {
+		auto * blockRow = image.data() + (j - j % codelSize) * width;
+		auto * row = image.data() + j * width;
+
+		for (auto i = 0u; i < width; ++i)
+			if (row[i] != blockRow[i - i % codelSize]) return 1;
+	}
+
+	return codelSize;
+}
+
+/**
+ * collapses every codelSize x codelSize block of the image into a single pixel
+ */
+auto Program568::downscale(unsigned int codelSize) -> void {
+	auto scaledWidth = width / codelSize;
+	auto scaledHeight = height / codelSize;
+
+	auto scaled = ProgramImage568(scaledWidth * scaledHeight);
+
+	for (auto j = 0u; j < scaledHeight; ++j)
+		for (auto i = 0u; i < scaledWidth; ++i)
+			scaled[j * scaledWidth + i] = CNGE::Util::sample::nearest(image.data(), float(i * codelSize), float(j * codelSize), width, height, 0);
+
+	image = std::move(scaled);
+	width = scaledWidth;
+	height = scaledHeight;
+
+	loadStats.codelSize = codelSize;
+}
+
+/**
+ * @return the program as loaded, one 0xRRGGBB color per codel,
+ * unpacked from the grid with filler turned white if the program is packed,
+ * or copied out of memory a viewed program does not own
+ */
+auto Program568::getImage() const -> const ProgramImage568 & {
+	waitForRows(height);
+
+	if (!loadStats.packed && storage == nullptr) return image;
+
+	std::call_once(unpackOnce, [this]() {
+		if (loadStats.packed) unpacked = grid.unpack();
+		else unpacked.assign(pixels, pixels + static_cast<std::size_t>(width) * height);
+	});
+
+	return unpacked;
+}
+
+/**
+ * @return the unpacked image for the engine to fetch from, null when packed
+ */
+auto Program568::getPixels() const -> const unsigned int * {
+	return pixels;
+}
+
+auto Program568::getGrid() const -> const PackedGrid568 & {
+	return grid;
+}
+
+auto Program568::getWidth() const -> unsigned int {
+	return width;
+}
+
+auto Program568::getHeight() const -> unsigned int {
+	return height;
+}
+
+auto Program568::getLoadStats() const -> const LoadStats & {
+	return loadStats;
+}
+
+/**
+ * @return why the program could not be verified at load time
+ */
+auto Program568::getVerifyErrors() const -> const std::vector<VerifyError> & {
+	return verifyErrors;
+}
+
+/**
+ * @return roughly how much memory the program holds on to, for caches to budget by
+ */
+auto Program568::getBytes() const -> std::size_t {
+	return sizeof(Program568) + image.capacity() * sizeof(unsigned int) + grid.getBytes();
+}
+
+/**
+ * @return how many rows from the top can be read, all of them unless still decoding
+ */
+auto Program568::getRowsReady() const -> unsigned int {
+	return rowsReady.load(std::memory_order_acquire);
+}
+
+/**
+ * @return true if the png turned out to be broken partway, the rows after that are filler
+ */
+auto Program568::hasDecodeError() const -> bool {
+	return decodeFailed;
+}
+
+/**
+ * blocks until at least count rows from the top are decoded, safe to call from any thread
+ *
+ * @return how many rows are ready, which may already be more
+ */
+auto Program568::waitForRows(unsigned int count) const -> unsigned int {
+	count = std::min(count, height);
+
+	auto ready = rowsReady.load(std::memory_order_acquire);
+
+	while (ready < count) {
+		rowsReady.wait(ready, std::memory_order_acquire);
+		ready = rowsReady.load(std::memory_order_acquire);
+	}
+
+	return ready;
+}
+
+/**
+ * looks for a loop at a branch the first time any engine asks, safe to call from any thread
+ *
+ * @return the loop entered at this branch position and direction, or null if there is none
+ */
+auto Program568::findLoop(int x, int y, int dx, int dy) const -> const Loop568 * {
+	auto direction = dx > 0 ? 0 : dy < 0 ? 1 : dx < 0 ? 2 : 3;
+	auto key = (static_cast<unsigned long long>(y) * width + x) * 4 + direction;
+
+	auto lock = std::lock_guard(loopMutex);
+
+	auto [entry, unseen] = loopAt.try_emplace(key, nullptr);
+
+	if (unseen) {
+		TIMELINE568_SPAN("find loop");
+
+		auto loop = Loop568();
+		auto finder = loadStats.packed ? LoopFinder568(grid) : LoopFinder568(pixels, width, height);
+
+		if (finder.find(x, y, dx, dy, loop)) {
+			loops.push_back(std::move(loop));
+			entry->second = &loops.back();
+		}
+	}
+
+	return entry->second;
+}
+
+/**
+ * @return how many loops have been found in the program so far
+ */
+auto Program568::getNumLoops() const -> unsigned int {
+	auto lock = std::lock_guard(loopMutex);
+
+	return static_cast<unsigned int>(loops.size());
+}
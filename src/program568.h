@@ -0,0 +1,94 @@
+
+#ifndef LANGUAGE568_PROGRAM568_H
+#define LANGUAGE568_PROGRAM568_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+#include "engine568Types.h"
+#include "verifier568.h"
+#include "loops568.h"
+#include "packedGrid568.h"
+#include "hugePages568.h"
+
+/**
+ * everything loading a program works out, shared by every engine running it
+ *
+ * nothing about a program changes after it is built, except rows arriving when it is decoded progressively,
+ * so any number of engines on any number of threads can run one at once
+ * and only have to keep their own registers and cursor
+ */
+class Program568 {
+private:
+	/* one or the other, the image is empty when packed */
+	ProgramImage568 image;
+	PackedGrid568 grid;
+
+	/* what engines fetch from, the image or memory the program views without owning, null when packed */
+	const unsigned int * pixels;
+	std::shared_ptr<const void> storage;
+	unsigned int width, height;
+
+	LoadStats loadStats;
+	std::vector<VerifyError> verifyErrors;
+
+	/*
+	 * loops are only looked for at branches some run reaches, then kept for all of them,
+	 * the deque keeps every loop in place as more are added
+	 */
+	mutable std::mutex loopMutex;
+	mutable std::deque<Loop568> loops;
+	mutable std::unordered_map<unsigned long long, const Loop568 *> loopAt;
+
+	/*
+	 * rows decoded so far of a program still being decoded in the background, all of them otherwise,
+	 * only ever goes up and rows below it never change again
+	 */
+	std::atomic<unsigned int> rowsReady;
+	std::atomic<bool> cancelDecode;
+	std::atomic<bool> decodeFailed;
+	std::thread decoder;
+
+	/* the image of a packed program, only unpacked if asked for */
+	mutable std::once_flag unpackOnce;
+	mutable ProgramImage568 unpacked;
+
+	auto detectCodelSize() -> unsigned int;
+	auto downscale(unsigned int) -> void;
+
+	Program568(unsigned int, unsigned int);
+
+public:
+	Program568(unsigned int, unsigned int, const unsigned char *, bool = true, bool = false);
+	~Program568();
+
+	static auto decodePNG(const char *) -> std::shared_ptr<const Program568>;
+	auto replicate() const -> std::shared_ptr<const Program568>;
+	static auto view(const unsigned int *, const LoadStats &, std::shared_ptr<const void>) -> std::shared_ptr<const Program568>;
+
+	Program568(const Program568 &) = delete;
+	auto operator=(const Program568 &) -> Program568 & = delete;
+
+	auto getImage() const -> const ProgramImage568 &;
+	auto getPixels() const -> const unsigned int *;
+	auto getGrid() const -> const PackedGrid568 &;
+	auto getWidth() const -> unsigned int;
+	auto getHeight() const -> unsigned int;
+	auto getLoadStats() const -> const LoadStats &;
+	auto getVerifyErrors() const -> const std::vector<VerifyError> &;
+	auto getBytes() const -> std::size_t;
+
+	auto getRowsReady() const -> unsigned int;
+	auto waitForRows(unsigned int) const -> unsigned int;
+	auto hasDecodeError() const -> bool;
+
+	auto findLoop(int, int, int, int) const -> const Loop568 *;
+	auto getNumLoops() const -> unsigned int;
+};
+
+#endif //LANGUAGE568_PROGRAM568_H
@@ -0,0 +1,89 @@
+
+#include "programCache568.h"
+
+ProgramCacheStats568::ProgramCacheStats568() : hits(0), misses(0), evictions(0), entries(0), bytes(0) {}
+
+ProgramCache568::Entry::Entry(unsigned long long hash, std::shared_ptr<const Program568> && program) :
+	hash(hash),
+	program(std::move(program)),
+	bytes(this->program->getBytes()) {}
+
+/**
+ * @param budget how many bytes of programs to keep, the most recent one is kept even if it is larger
+ */
+ProgramCache568::ProgramCache568(std::size_t budget) :
+	budget(budget),
+	mutex(),
+	entries(),
+	index(),
+	stats() {}
+
+/**
+ * 64 bit fnv-1a, enough to tell program files apart, not to stand up to anyone making collisions on purpose
+ */
+auto ProgramCache568::hash(const unsigned char * data, std::size_t length) -> unsigned long long {
+	auto hash = 0xcbf29ce484222325ull;
+
+	for (auto i = std::size_t(0); i < length; ++i) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+/**
+ * @return the program with this hash, marked as just used, or null if it is not cached
+ */
+auto ProgramCache568::find(unsigned long long hash) -> std::shared_ptr<const Program568> {
+	auto lock = std::lock_guard(mutex);
+
+	auto found = index.find(hash);
+
+	if (found == index.end()) {
+		++stats.misses;
+		return nullptr;
+	}
+
+	++stats.hits;
+	entries.splice(entries.begin(), entries, found->second);
+
+	return found->second->program;
+}
+
+/**
+ * adds a program, or replaces the one with the same hash if two loaded it at once,
+ * then evicts from the back until the cache is within budget
+ */
+auto ProgramCache568::insert(unsigned long long hash, std::shared_ptr<const Program568> program) -> void {
+	auto lock = std::lock_guard(mutex);
+
+	auto found = index.find(hash);
+
+	if (found != index.end()) {
+		stats.bytes -= found->second->bytes;
+		entries.erase(found->second);
+	}
+
+	entries.emplace_front(hash, std::move(program));
+	index[hash] = entries.begin();
+	stats.bytes += entries.front().bytes;
+
+	while (stats.bytes > budget && entries.size() > 1) {
+		auto & last = entries.back();
+
+		stats.bytes -= last.bytes;
+		index.erase(last.hash);
+		entries.pop_back();
+
+		++stats.evictions;
+	}
+
+	stats.entries = static_cast<unsigned int>(entries.size());
+}
+
+auto ProgramCache568::getStats() -> ProgramCacheStats568 {
+	auto lock = std::lock_guard(mutex);
+
+	return stats;
+}
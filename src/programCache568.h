@@ -0,0 +1,58 @@
+
+#ifndef LANGUAGE568_PROGRAMCACHE568_H
+#define LANGUAGE568_PROGRAMCACHE568_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstddef>
+
+#include "program568.h"
+
+class ProgramCacheStats568 {
+public:
+	ProgramCacheStats568();
+
+	unsigned long long hits, misses, evictions;
+	unsigned int entries;
+	std::size_t bytes;
+};
+
+/**
+ * loaded programs keyed by a hash of the file they came from,
+ * the least recently used ones dropped once they hold more than a byte budget
+ *
+ * safe to use from any thread, engines keep running programs that get evicted under them
+ */
+class ProgramCache568 {
+private:
+	class Entry {
+	public:
+		Entry(unsigned long long, std::shared_ptr<const Program568> &&);
+
+		unsigned long long hash;
+		std::shared_ptr<const Program568> program;
+		std::size_t bytes;
+	};
+
+	std::size_t budget;
+
+	std::mutex mutex;
+	/* most recently used first */
+	std::list<Entry> entries;
+	std::unordered_map<unsigned long long, std::list<Entry>::iterator> index;
+	ProgramCacheStats568 stats;
+
+public:
+	explicit ProgramCache568(std::size_t);
+
+	static auto hash(const unsigned char *, std::size_t) -> unsigned long long;
+
+	auto find(unsigned long long) -> std::shared_ptr<const Program568>;
+	auto insert(unsigned long long, std::shared_ptr<const Program568>) -> void;
+
+	auto getStats() -> ProgramCacheStats568;
+};
+
+#endif //LANGUAGE568_PROGRAMCACHE568_H
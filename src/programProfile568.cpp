@@ -0,0 +1,199 @@
+#include "programProfile568.h"
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include "engine568Run.h"
+
+constexpr static auto PROFILE_HEADER = "language568 profile 2";
+/* the first version also kept how often each color followed another, which loading reads past */
+constexpr static auto PROFILE_HEADER_1 = "language568 profile 1";
+constexpr static unsigned int PROFILE_1_PAIRS = 36;
+
+ProfileCounts568::ProfileCounts568() : count(0), taken(0), notTaken(0) {}
+
+ProgramProfile568::ProgramProfile568() :
+	runs(0),
+	instructions(0),
+	hottest(0),
+	states() {}
+
+/* positions are in codels, directions one of the four unit steps */
+auto ProgramProfile568::key(int x, int y, int dx, int dy) -> unsigned long long {
+	return (static_cast<unsigned long long>(static_cast<unsigned int>(x)) << 32u)
+		| (static_cast<unsigned long long>(static_cast<unsigned int>(y) & 0x0fffffffu) << 4u)
+		| static_cast<unsigned int>((dx + 1) << 2 | (dy + 1));
+}
+
+/**
+ * @return where the profile of the program at a path is kept
+ */
+auto ProgramProfile568::pathFor(const std::string & program) -> std::string {
+	return program + ".profile";
+}
+
+/**
+ * counts one run of the instruction entered at a position in a direction
+ *
+ * @return its counts, for a branch to add which way it went
+ */
+auto ProgramProfile568::visit(int x, int y, int dx, int dy) -> ProfileCounts568 & {
+	auto & counts = states[key(x, y, dx, dy)];
+
+	++instructions;
+	hottest = std::max(hottest, ++counts.count);
+
+	return counts;
+}
+
+auto ProgramProfile568::endRun() -> void {
+	++runs;
+}
+
+/**
+ * @return the counts of an instruction, null if it never ran
+ */
+auto ProgramProfile568::find(int x, int y, int dx, int dy) const -> const ProfileCounts568 * {
+	auto found = states.find(key(x, y, dx, dy));
+
+	return found == states.end() ? nullptr : &found->second;
+}
+
+auto ProgramProfile568::isHot(int x, int y, int dx, int dy) const -> bool {
+	auto * counts = find(x, y, dx, dy);
+
+	return counts != nullptr && counts->count * HOT_FRACTION >= hottest;
+}
+
+auto ProgramProfile568::getRuns() const -> unsigned long long {
+	return runs;
+}
+
+auto ProgramProfile568::getInstructions() const -> unsigned long long {
+	return instructions;
+}
+
+/**
+ * adds the counts in a file to this profile, a file that does not exist adds nothing
+ *
+ * @param error set to why the file could not be read
+ */
+auto ProgramProfile568::load(const std::string & path, std::string & error) -> bool {
+	auto in = std::ifstream(path);
+	if (!in) return true;
+
+	auto header = std::string();
+	std::getline(in, header);
+
+	auto word = std::string();
+	auto fileRuns = 0ull, numStates = 0ull;
+
+	auto first = header == PROFILE_HEADER_1;
+
+	if ((header != PROFILE_HEADER && !first) || !(in >> word >> fileRuns) || word != "runs" || (first && (!(in >> word) || word != "pairs"))) {
+		error = path + " is not a profile";
+		return false;
+	}
+
+	auto skipped = 0ull;
+	if (first) for (auto i = 0u; i < PROFILE_1_PAIRS; ++i) in >> skipped;
+
+	if (!in || !(in >> word >> numStates) || word != "states") {
+		error = path + " is not a profile";
+		return false;
+	}
+
+	/* read whole before any of it is added, so a damaged file leaves the profile as it was */
+	auto fileStates = std::vector<std::pair<unsigned long long, ProfileCounts568>>();
+
+	for (auto i = 0ull; i < numStates; ++i) {
+		auto x = 0, y = 0, dx = 0, dy = 0;
+		auto counts = ProfileCounts568();
+
+		if (!(in >> x >> y >> dx >> dy >> counts.count >> counts.taken >> counts.notTaken)) {
+			error = path + " is cut short after " + std::to_string(i) + " instructions";
+			return false;
+		}
+
+		fileStates.emplace_back(key(x, y, dx, dy), counts);
+	}
+
+	runs += fileRuns;
+
+	for (auto & [stateKey, fileCounts] : fileStates) {
+		auto & counts = states[stateKey];
+
+		counts.count += fileCounts.count;
+		counts.taken += fileCounts.taken;
+		counts.notTaken += fileCounts.notTaken;
+
+		instructions += fileCounts.count;
+		hottest = std::max(hottest, counts.count);
+	}
+
+	return true;
+}
+
+/**
+ * writes the profile out, instructions in order of position so files of two runs can be diffed
+ *
+ * @param error set to why the file could not be written
+ */
+auto ProgramProfile568::save(const std::string & path, std::string & error) const -> bool {
+	auto out = std::ofstream(path);
+
+	if (!out) {
+		error = "Could not write profile to " + path;
+		return false;
+	}
+
+	out << PROFILE_HEADER << "\n";
+	out << "runs " << runs << "\n";
+
+	auto sorted = std::vector<std::pair<unsigned long long, ProfileCounts568>>(states.begin(), states.end());
+	std::sort(sorted.begin(), sorted.end(), [](auto & left, auto & right) { return left.first < right.first; });
+
+	out << "states " << sorted.size() << "\n";
+
+	for (auto & [stateKey, counts] : sorted) {
+		auto x = static_cast<int>(stateKey >> 32u);
+		auto y = static_cast<int>((stateKey >> 4u) & 0x0fffffffu);
+		auto dx = static_cast<int>((stateKey >> 2u) & 3u) - 1;
+		auto dy = static_cast<int>(stateKey & 3u) - 1;
+
+		out << x << " " << y << " " << dx << " " << dy << " " << counts.count << " " << counts.taken << " " << counts.notTaken << "\n";
+	}
+
+	if (!out.flush()) {
+		error = "Could not write profile to " + path;
+		return false;
+	}
+
+	return true;
+}
+
+ProgramProfileObserver568::ProgramProfileObserver568(ProgramProfile568 & profile) :
+	profile(profile),
+	current(nullptr) {}
+
+auto ProgramProfileObserver568::onStart(Engine568 &) -> void {
+	current = nullptr;
+}
+
+auto ProgramProfileObserver568::onInstruction(Engine568 & engine, unsigned int) -> void {
+	current = &profile.visit(engine.getX(), engine.getY(), engine.getDX(), engine.getDY());
+}
+
+auto ProgramProfileObserver568::onBranch(Engine568 &, bool taken) -> void {
+	if (current == nullptr) return;
+
+	if (taken) ++current->taken;
+	else ++current->notTaken;
+}
+
+auto ProgramProfileObserver568::onEnd(Engine568 &) -> void {
+	profile.endRun();
+}
+
+template auto Engine568::run(ProgramProfileObserver568 &) -> void;
@@ -0,0 +1,78 @@
+#ifndef LANGUAGE568_PROGRAMPROFILE568_H
+#define LANGUAGE568_PROGRAMPROFILE568_H
+
+#include <string>
+#include <unordered_map>
+
+#include "engine568Observer.h"
+
+class ProfileCounts568 {
+public:
+	ProfileCounts568();
+
+	/* times the instruction ran, and for branches which way they went */
+	unsigned long long count;
+	unsigned long long taken, notTaken;
+};
+
+/**
+ * how often each instruction of a program ran, keyed by its position and the direction it was entered in
+ * the way transpile568 labels its blocks, and which way each branch went
+ *
+ * kept in a text file next to the program, see pathFor, and added to by every profiling run,
+ * so transpile568 can fuse the hot paths and lay them out together
+ *
+ * a hot sequence is a run of hot instructions one after another, so their counts are all fusing needs
+ */
+class ProgramProfile568 {
+public:
+	/* an instruction is hot when it ran at least this fraction of as often as the hottest one */
+	constexpr static unsigned int HOT_FRACTION = 100;
+
+private:
+	unsigned long long runs;
+	unsigned long long instructions;
+	unsigned long long hottest;
+
+	std::unordered_map<unsigned long long, ProfileCounts568> states;
+
+	static auto key(int, int, int, int) -> unsigned long long;
+
+public:
+	ProgramProfile568();
+
+	static auto pathFor(const std::string &) -> std::string;
+
+	auto visit(int, int, int, int) -> ProfileCounts568 &;
+	auto endRun() -> void;
+
+	auto find(int, int, int, int) const -> const ProfileCounts568 *;
+	auto isHot(int, int, int, int) const -> bool;
+
+	auto getRuns() const -> unsigned long long;
+	auto getInstructions() const -> unsigned long long;
+
+	auto load(const std::string &, std::string &) -> bool;
+	auto save(const std::string &, std::string &) const -> bool;
+};
+
+/**
+ * adds what an observed run does to a profile
+ */
+class ProgramProfileObserver568 : public NullObserver568 {
+private:
+	ProgramProfile568 & profile;
+
+	/* the instruction running, which a branch is counted against */
+	ProfileCounts568 * current;
+
+public:
+	explicit ProgramProfileObserver568(ProgramProfile568 &);
+
+	auto onStart(Engine568 &) -> void;
+	auto onInstruction(Engine568 &, unsigned int) -> void;
+	auto onBranch(Engine568 &, bool) -> void;
+	auto onEnd(Engine568 &) -> void;
+};
+
+#endif //LANGUAGE568_PROGRAMPROFILE568_H
@@ -0,0 +1,57 @@
+
+#include "programReplicas568.h"
+
+#include <thread>
+
+#include "numa568.h"
+
+/**
+ * @param replicate when false every node runs the original, to compare against
+ */
+ProgramReplicas568::ProgramReplicas568(const std::shared_ptr<const Program568> & program, bool replicate) :
+	replicas(Numa568::getNumNodes(), program),
+	replicated(replicate && replicas.size() > 1)
+{
+	if (!replicated) return;
+
+	for (auto node = 0u; node < replicas.size(); ++node) {
+		/* a thread of its own so the pinning and memory policy go away with it */
+		auto builder = std::thread([this, &program, node]() {
+			/* nodes without cpus, like memory only nodes, keep the original */
+			if (!Numa568::pinToNode(node)) return;
+
+			Numa568::preferNode(node);
+			replicas[node] = program->replicate();
+		});
+
+		builder.join();
+	}
+}
+
+/**
+ * pins the calling thread to the node for a worker, spreading workers evenly across nodes
+ *
+ * @return the node to get the worker's replica of
+ */
+auto ProgramReplicas568::pinWorker(unsigned int worker) const -> unsigned int {
+	auto node = worker % getNumNodes();
+
+	if (getNumNodes() > 1) Numa568::pinToNode(node);
+
+	return node;
+}
+
+auto ProgramReplicas568::get(unsigned int node) const -> const std::shared_ptr<const Program568> & {
+	return replicas[node % replicas.size()];
+}
+
+auto ProgramReplicas568::getNumNodes() const -> unsigned int {
+	return static_cast<unsigned int>(replicas.size());
+}
+
+/**
+ * @return true if there is more than one node and each has its own copy
+ */
+auto ProgramReplicas568::isReplicated() const -> bool {
+	return replicated;
+}
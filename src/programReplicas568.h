@@ -0,0 +1,34 @@
+
+#ifndef LANGUAGE568_PROGRAMREPLICAS568_H
+#define LANGUAGE568_PROGRAMREPLICAS568_H
+
+#include <vector>
+#include <memory>
+
+#include "program568.h"
+
+/**
+ * one copy of a program on every NUMA node, for batches running it from threads on all of them
+ *
+ * each replica is made by a thread pinned to its node that prefers that node's memory,
+ * and workers pin themselves to a node and only fetch from the replica there,
+ * so no fetch crosses between sockets
+ *
+ * with a single node, or replication turned off, every node shares the one program
+ */
+class ProgramReplicas568 {
+private:
+	std::vector<std::shared_ptr<const Program568>> replicas;
+	bool replicated;
+
+public:
+	explicit ProgramReplicas568(const std::shared_ptr<const Program568> &, bool = true);
+
+	auto pinWorker(unsigned int) const -> unsigned int;
+
+	auto get(unsigned int) const -> const std::shared_ptr<const Program568> &;
+	auto getNumNodes() const -> unsigned int;
+	auto isReplicated() const -> bool;
+};
+
+#endif //LANGUAGE568_PROGRAMREPLICAS568_H
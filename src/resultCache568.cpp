@@ -0,0 +1,354 @@
+#include "resultCache568.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+ResultKey568::ResultKey568() : program(0), stepLimit(0), inputs(), isArray() {}
+
+/**
+ * fnv-1a over the program hash, the step limit and each input with its kind and length,
+ * so pushing 1,2 as an array and 1 then 2 as integers are different keys
+ */
+auto ResultKey568::hash() const -> unsigned long long {
+	auto hash = 0xcbf29ce484222325ull;
+
+	auto mix = [&hash](unsigned long long value, unsigned int bytes) {
+		for (auto i = 0u; i < bytes; ++i) {
+			hash ^= (value >> (i * 8u)) & 0xffu;
+			hash *= 0x100000001b3ull;
+		}
+	};
+
+	mix(program, 8);
+	mix(stepLimit, 8);
+
+	for (auto i = std::size_t(0); i < inputs.size(); ++i) {
+		mix(isArray[i] ? 1 : 0, 1);
+		mix(inputs[i].size(), 4);
+
+		for (auto value : inputs[i]) mix(static_cast<unsigned int>(value), 4);
+	}
+
+	return hash;
+}
+
+auto ResultKey568::operator==(const ResultKey568 & other) const -> bool {
+	return program == other.program && stepLimit == other.stepLimit && inputs == other.inputs && isArray == other.isArray;
+}
+
+RunResult568::RunResult568() : x(0), y(0), steps(0), registers(), arrays(), error(), output() {}
+
+/**
+ * takes what an engine's last run left behind
+ *
+ * @param output what the run printed
+ */
+RunResult568::RunResult568(Engine568 & engine, std::string && output) :
+	x(engine.getX()),
+	y(engine.getY()),
+	steps(engine.getSteps()),
+	registers(),
+	arrays(),
+	error(engine.getError()),
+	output(std::move(output))
+{
+	for (auto i = 0u; i < NUM_REGISTERS; ++i) {
+		auto & reg = engine.getRegister(i);
+
+		registers[i] = reg.integer;
+		if (reg.array != nullptr) arrays[i] = *reg.array;
+	}
+}
+
+ResultCacheStats568::ResultCacheStats568() : hits(0), misses(0), evictions(0), entries(0), bytes(0) {}
+
+/**
+ * @return the fraction of lookups that hit, 0 before any
+ */
+auto ResultCacheStats568::hitRate() const -> double {
+	auto lookups = hits + misses;
+	return lookups == 0 ? 0.0 : double(hits) / double(lookups);
+}
+
+/* roughly what an entry holds on to, the containers' own overhead included */
+static auto entryBytes(const ResultKey568 & key, const RunResult568 & result) -> std::size_t {
+	auto bytes = sizeof(ResultKey568) + sizeof(RunResult568) + result.error.size() + result.output.size();
+
+	for (auto & input : key.inputs) bytes += sizeof(input) + input.size() * sizeof(int);
+	for (auto & array : result.arrays) bytes += array.size() * sizeof(int);
+
+	return bytes;
+}
+
+ResultCache568::Entry::Entry(ResultKey568 && key, std::shared_ptr<const RunResult568> && result) :
+	key(std::move(key)),
+	result(std::move(result)),
+	bytes(entryBytes(this->key, *this->result)) {}
+
+/**
+ * @param budget how many bytes of results to keep, 0 turns the cache off
+ */
+ResultCache568::ResultCache568(std::size_t budget) :
+	budget(budget),
+	mutex(),
+	entries(),
+	index(),
+	stats() {}
+
+auto ResultCache568::isEnabled() const -> bool {
+	return budget > 0;
+}
+
+auto ResultCache568::findEntry(const ResultKey568 & key, unsigned long long hash) -> std::list<Entry>::iterator {
+	auto [begin, end] = index.equal_range(hash);
+
+	for (auto found = begin; found != end; ++found) {
+		if (found->second->key == key) return found->second;
+	}
+
+	return entries.end();
+}
+
+/**
+ * drops from the back until the cache is within budget
+ */
+auto ResultCache568::evict() -> void {
+	while (stats.bytes > budget && !entries.empty()) {
+		auto last = std::prev(entries.end());
+		auto [begin, end] = index.equal_range(last->key.hash());
+
+		for (auto found = begin; found != end; ++found) {
+			if (found->second == last) {
+				index.erase(found);
+				break;
+			}
+		}
+
+		stats.bytes -= last->bytes;
+		entries.erase(last);
+
+		++stats.evictions;
+	}
+
+	stats.entries = static_cast<unsigned int>(entries.size());
+}
+
+/**
+ * @return the result of an earlier run with this key, marked as just used, or null if it is not cached
+ */
+auto ResultCache568::find(const ResultKey568 & key) -> std::shared_ptr<const RunResult568> {
+	if (!isEnabled()) return nullptr;
+
+	auto hash = key.hash();
+	auto lock = std::lock_guard(mutex);
+
+	auto found = findEntry(key, hash);
+
+	if (found == entries.end()) {
+		++stats.misses;
+		return nullptr;
+	}
+
+	++stats.hits;
+	entries.splice(entries.begin(), entries, found);
+
+	return found->result;
+}
+
+/**
+ * adds a result, or replaces the one with the same key if two ran it at once,
+ * a result larger than the whole budget is not kept
+ */
+auto ResultCache568::insert(ResultKey568 key, std::shared_ptr<const RunResult568> result) -> void {
+	if (!isEnabled()) return;
+
+	auto hash = key.hash();
+	auto lock = std::lock_guard(mutex);
+
+	auto found = findEntry(key, hash);
+
+	if (found != entries.end()) {
+		stats.bytes -= found->bytes;
+		found->result = std::move(result);
+		found->bytes = entryBytes(found->key, *found->result);
+		stats.bytes += found->bytes;
+
+		entries.splice(entries.begin(), entries, found);
+	} else {
+		entries.emplace_front(std::move(key), std::move(result));
+		index.emplace(hash, entries.begin());
+		stats.bytes += entries.front().bytes;
+	}
+
+	evict();
+}
+
+constexpr static unsigned int FILE_MAGIC = 0x52383635;
+/* 2 added the step limit to keys, files from before are not loaded */
+constexpr static unsigned int FILE_VERSION = 2;
+
+template <typename T>
+static auto writeValue(std::ostream & out, T value) -> void {
+	out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static auto readValue(std::istream & in, T & value) -> bool {
+	return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+static auto writeInts(std::ostream & out, const std::vector<int> & values) -> void {
+	writeValue(out, static_cast<unsigned int>(values.size()));
+	out.write(reinterpret_cast<const char *>(values.data()), std::streamsize(values.size() * sizeof(int)));
+}
+
+static auto writeString(std::ostream & out, const std::string & text) -> void {
+	writeValue(out, static_cast<unsigned int>(text.size()));
+	out.write(text.data(), std::streamsize(text.size()));
+}
+
+/* lengths are bounded by what is left of the file, so a damaged one cannot ask for huge allocations */
+static auto readInts(std::istream & in, std::vector<int> & values, std::size_t remaining) -> bool {
+	auto length = 0u;
+	if (!readValue(in, length) || std::size_t(length) * sizeof(int) > remaining) return false;
+
+	values.resize(length);
+	return bool(in.read(reinterpret_cast<char *>(values.data()), std::streamsize(length * sizeof(int))));
+}
+
+static auto readString(std::istream & in, std::string & text, std::size_t remaining) -> bool {
+	auto length = 0u;
+	if (!readValue(in, length) || length > remaining) return false;
+
+	text.resize(length);
+	return bool(in.read(text.data(), std::streamsize(length)));
+}
+
+/**
+ * writes every result out, least recently used first, to a temporary file moved over the path,
+ * so a crash partway through leaves the old file whole
+ *
+ * @param error set to why the file could not be written
+ */
+auto ResultCache568::save(const std::string & path, std::string & error) -> bool {
+	auto temporary = path + ".tmp";
+
+	{
+		auto out = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+
+		if (!out) {
+			error = "Could not write result cache to " + temporary;
+			return false;
+		}
+
+		auto lock = std::lock_guard(mutex);
+
+		writeValue(out, FILE_MAGIC);
+		writeValue(out, FILE_VERSION);
+		writeValue(out, static_cast<unsigned int>(entries.size()));
+
+		for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+			auto & key = entry->key;
+			auto & result = *entry->result;
+
+			writeValue(out, key.program);
+			writeValue(out, key.stepLimit);
+			writeValue(out, static_cast<unsigned int>(key.inputs.size()));
+
+			for (auto i = std::size_t(0); i < key.inputs.size(); ++i) {
+				writeValue(out, static_cast<unsigned char>(key.isArray[i]));
+				writeInts(out, key.inputs[i]);
+			}
+
+			writeValue(out, result.x);
+			writeValue(out, result.y);
+			writeValue(out, result.steps);
+
+			for (auto i = 0u; i < RunResult568::NUM_REGISTERS; ++i) {
+				writeValue(out, result.registers[i]);
+				writeInts(out, result.arrays[i]);
+			}
+
+			writeString(out, result.error);
+			writeString(out, result.output);
+		}
+
+		if (!out.flush()) {
+			error = "Could not write result cache to " + temporary;
+			return false;
+		}
+	}
+
+	auto renameError = std::error_code();
+	std::filesystem::rename(temporary, path, renameError);
+
+	if (renameError) {
+		error = "Could not replace " + path + ": " + renameError.message();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * adds the results saved in a file, as if they had just been inserted in the order saved,
+ * so the most recently used when saved stay the most recently used
+ *
+ * a file that does not exist is an empty cache rather than an error
+ *
+ * @param error set to why the file could not be read
+ * @return false if the file is not a result cache or is cut short, the results before the damage are kept
+ */
+auto ResultCache568::load(const std::string & path, std::string & error) -> bool {
+	auto in = std::ifstream(path, std::ios::binary);
+	if (!in) return true;
+
+	auto fileBytes = std::filesystem::file_size(path);
+
+	auto magic = 0u, version = 0u, count = 0u;
+
+	if (!readValue(in, magic) || !readValue(in, version) || !readValue(in, count) || magic != FILE_MAGIC || version != FILE_VERSION) {
+		error = path + " is not a result cache";
+		return false;
+	}
+
+	for (auto e = 0u; e < count; ++e) {
+		auto key = ResultKey568();
+		auto result = std::make_shared<RunResult568>();
+		auto numInputs = 0u;
+
+		auto remaining = [&]() { return std::size_t(fileBytes) - std::size_t(in.tellg()); };
+		auto good = readValue(in, key.program) && readValue(in, key.stepLimit) && readValue(in, numInputs) && numInputs <= remaining();
+
+		for (auto i = 0u; good && i < numInputs; ++i) {
+			auto isArray = static_cast<unsigned char>(0);
+
+			good = readValue(in, isArray) && readInts(in, key.inputs.emplace_back(), remaining());
+			key.isArray.push_back(isArray != 0);
+		}
+
+		good = good && readValue(in, result->x) && readValue(in, result->y) && readValue(in, result->steps);
+
+		for (auto i = 0u; good && i < RunResult568::NUM_REGISTERS; ++i) {
+			good = readValue(in, result->registers[i]) && readInts(in, result->arrays[i], remaining());
+		}
+
+		good = good && readString(in, result->error, remaining()) && readString(in, result->output, remaining());
+
+		if (!good) {
+			error = path + " is cut short after " + std::to_string(e) + " results";
+			return false;
+		}
+
+		insert(std::move(key), std::move(result));
+	}
+
+	return true;
+}
+
+auto ResultCache568::getStats() -> ResultCacheStats568 {
+	auto lock = std::lock_guard(mutex);
+
+	return stats;
+}
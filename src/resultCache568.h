@@ -0,0 +1,113 @@
+#ifndef LANGUAGE568_RESULTCACHE568_H
+#define LANGUAGE568_RESULTCACHE568_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "engine568.h"
+
+/**
+ * a program, everything pushed to it before it ran and how far it was let run, which is all a run depends on
+ */
+class ResultKey568 {
+public:
+	ResultKey568();
+
+	/* the hash of the program's file, as the program cache has it */
+	unsigned long long program;
+	/* the engine's, 0 for none */
+	unsigned long long stepLimit;
+	/* in the order pushed, with whether each went in as an array */
+	std::vector<std::vector<int>> inputs;
+	std::vector<bool> isArray;
+
+	auto hash() const -> unsigned long long;
+	auto operator==(const ResultKey568 &) const -> bool;
+};
+
+/**
+ * what a finished run left behind
+ */
+class RunResult568 {
+public:
+	constexpr static unsigned int NUM_REGISTERS = 6;
+
+	RunResult568();
+	explicit RunResult568(Engine568 &, std::string &&);
+
+	int x, y;
+	unsigned long long steps;
+	int registers [NUM_REGISTERS];
+	/* the array each register points to, empty if it holds an integer */
+	std::vector<int> arrays [NUM_REGISTERS];
+
+	std::string error;
+	std::string output;
+};
+
+class ResultCacheStats568 {
+public:
+	ResultCacheStats568();
+
+	unsigned long long hits, misses, evictions;
+	unsigned int entries;
+	std::size_t bytes;
+
+	auto hitRate() const -> double;
+};
+
+/**
+ * results of earlier runs keyed by their program and inputs, so a repeated request skips running,
+ * the least recently used ones dropped once they hold more than a byte budget
+ *
+ * keys are compared in full on a hit, so two keys whose own hashes collide never give back each other's result,
+ * but a program is only known by the 64 bit fnv hash of its file, as it is to the program cache and to clients,
+ * so two files that hash the same would share results just as they already share a loaded program
+ *
+ * the cache can be saved to a file and loaded back into a later process,
+ * in this machine's byte order, it is not meant to be moved between machines
+ *
+ * safe to use from any thread
+ */
+class ResultCache568 {
+private:
+	class Entry {
+	public:
+		Entry(ResultKey568 &&, std::shared_ptr<const RunResult568> &&);
+
+		ResultKey568 key;
+		std::shared_ptr<const RunResult568> result;
+		std::size_t bytes;
+	};
+
+	std::size_t budget;
+
+	std::mutex mutex;
+	/* most recently used first */
+	std::list<Entry> entries;
+	std::unordered_multimap<unsigned long long, std::list<Entry>::iterator> index;
+	ResultCacheStats568 stats;
+
+	auto findEntry(const ResultKey568 &, unsigned long long) -> std::list<Entry>::iterator;
+	auto evict() -> void;
+
+public:
+	explicit ResultCache568(std::size_t);
+
+	auto isEnabled() const -> bool;
+
+	auto find(const ResultKey568 &) -> std::shared_ptr<const RunResult568>;
+	auto insert(ResultKey568, std::shared_ptr<const RunResult568>) -> void;
+
+	auto save(const std::string &, std::string &) -> bool;
+	auto load(const std::string &, std::string &) -> bool;
+
+	auto getStats() -> ResultCacheStats568;
+};
+
+#endif //LANGUAGE568_RESULTCACHE568_H
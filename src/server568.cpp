@@ -0,0 +1,361 @@
+
+#include "server568.h"
+
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <tuple>
+
+#include "image/image.h"
+#include "image/mappedFile.h"
+#include "timeline568.h"
+
+#ifdef __unix__
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/**
+ * @param cacheBytes how much memory loaded programs may take up between requests
+ * @param resultBytes how much memory results of runs may take up, 0 to always run
+ * @param stepLimit how many steps a run takes before it stops with an error, 0 for no limit
+ */
+Server568::Server568(std::string && socketPath, unsigned int numWorkers, std::size_t cacheBytes, std::size_t resultBytes, unsigned long long stepLimit) :
+	socketPath(socketPath),
+	numWorkers(std::max(1u, numWorkers)),
+	stepLimit(stepLimit),
+	cache(cacheBytes),
+	results(resultBytes),
+	listener(-1),
+	stopping(false),
+	queueMutex(),
+	queueReady(),
+	connections(),
+	error() {}
+
+/**
+ * listens on the socket and hands connections to the workers until stopped
+ *
+ * @return false if the socket could not be set up, see getError
+ */
+auto Server568::serve() -> bool {
+#ifdef __unix__
+	auto address = sockaddr_un();
+	address.sun_family = AF_UNIX;
+
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		error = "Socket path too long";
+		return false;
+	}
+
+	std::strcpy(address.sun_path, socketPath.c_str());
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	/* a socket file left behind by a server that did not shut down cleanly */
+	unlink(socketPath.c_str());
+
+	if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 128) != 0) {
+		error = std::string("Could not listen on ") + socketPath + ": " + std::strerror(errno);
+		if (listener >= 0) close(listener);
+		listener = -1;
+
+		return false;
+	}
+
+	auto workers = std::vector<std::thread>();
+	for (auto i = 0u; i < numWorkers; ++i) workers.emplace_back([this, i]() { work(i); });
+
+	while (!stopping) {
+		auto connection = accept(listener, nullptr, nullptr);
+
+		if (connection < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			break;
+		}
+
+		{
+			auto lock = std::lock_guard(queueMutex);
+			connections.emplace_back(connection, TIMELINE568_NOW());
+		}
+
+		queueReady.notify_one();
+	}
+
+	stopping = true;
+	queueReady.notify_all();
+
+	for (auto & worker : workers) worker.join();
+
+	close(listener);
+	listener = -1;
+	unlink(socketPath.c_str());
+
+	return true;
+#else
+	error = "Serving needs unix domain sockets";
+	return false;
+#endif
+}
+
+/**
+ * makes serve return once the connections being served close, callable from any thread
+ */
+auto Server568::stop() -> void {
+	stopping = true;
+
+#ifdef __unix__
+	/* wakes accept up */
+	if (listener >= 0) shutdown(listener, SHUT_RDWR);
+#endif
+
+	queueReady.notify_all();
+}
+
+/**
+ * one worker, with its own engine that is pointed at whichever program each request wants
+ */
+auto Server568::work(unsigned int index) -> void {
+	Timeline568::setThreadName("worker " + std::to_string(index));
+
+	auto engine = Engine568();
+	auto output = std::ostringstream();
+	engine.setOutput(output);
+	engine.setStepLimit(stepLimit);
+
+	while (true) {
+		auto connection = -1;
+		auto queued = -1ll;
+
+		{
+			auto lock = std::unique_lock(queueMutex);
+			queueReady.wait(lock, [this]() { return stopping || !connections.empty(); });
+
+			if (connections.empty()) return;
+
+			std::tie(connection, queued) = connections.front();
+			connections.pop_front();
+		}
+
+		TIMELINE568_RECORD("queued", queued);
+
+		serveConnection(connection, engine, output);
+	}
+}
+
+/**
+ * answers every request line on a connection until the client closes it
+ */
+auto Server568::serveConnection(int connection, Engine568 & engine, std::ostringstream & output) -> void {
+#ifdef __unix__
+	auto buffer = std::string();
+	char chunk [4096];
+
+	while (true) {
+		auto newline = buffer.find('\n');
+
+		if (newline == std::string::npos) {
+			if (buffer.size() > MAX_LINE) break;
+
+			auto received = recv(connection, chunk, sizeof(chunk), 0);
+			if (received <= 0) break;
+
+			buffer.append(chunk, received);
+			continue;
+		}
+
+		auto response = respond(buffer.substr(0, newline), engine, output);
+		buffer.erase(0, newline + 1);
+
+		auto sent = std::size_t(0);
+
+		while (sent < response.size()) {
+			auto count = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+			if (count <= 0) break;
+
+			sent += count;
+		}
+
+		if (sent < response.size()) break;
+	}
+
+	close(connection);
+#endif
+}
+
+/**
+ * runs the request on one line and writes up what happened
+ */
+auto Server568::respond(const std::string & line, Engine568 & engine, std::ostringstream & output) -> std::string {
+	TIMELINE568_SPAN("request");
+
+	auto words = std::istringstream(line);
+	auto command = std::string();
+	words >> command;
+
+	if (command == "stats") {
+		auto stats = cache.getStats();
+		auto resultStats = results.getStats();
+
+		char hitRate [16];
+		std::snprintf(hitRate, sizeof(hitRate), "%.4f", resultStats.hitRate());
+
+		return "stats " + std::to_string(stats.entries) + " programs " + std::to_string(stats.bytes) + " bytes "
+			+ std::to_string(stats.hits) + " hits " + std::to_string(stats.misses) + " misses "
+			+ std::to_string(stats.evictions) + " evictions, "
+			+ std::to_string(resultStats.entries) + " results " + std::to_string(resultStats.bytes) + " bytes "
+			+ std::to_string(resultStats.hits) + " hits " + std::to_string(resultStats.misses) + " misses "
+			+ std::to_string(resultStats.evictions) + " evictions " + hitRate + " hit rate\n";
+	}
+
+	if (command != "run") return "fail Unknown command\n";
+
+	auto name = std::string();
+	if (!(words >> name)) return "fail No program\n";
+
+	/* integers and arrays, parsed up front so a bad request never runs */
+	auto key = ResultKey568();
+	key.stepLimit = stepLimit;
+
+	for (auto word = std::string(); words >> word;) {
+		if (key.inputs.size() == MAX_INPUTS) return "fail Too many inputs\n";
+
+		auto & values = key.inputs.emplace_back();
+		key.isArray.push_back(word.find(',') != std::string::npos);
+
+		for (auto * start = word.c_str(); *start != '\0';) {
+			char * end = nullptr;
+			errno = 0;
+			auto value = std::strtol(start, &end, 10);
+
+			if (end == start || errno != 0 || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max() || (*end != ',' && *end != '\0'))
+				return "fail Bad input " + word + "\n";
+
+			values.push_back(int(value));
+			start = *end == ',' ? end + 1 : end;
+		}
+	}
+
+	auto failure = std::string();
+	auto program = findProgram(name, key.program, failure);
+
+	if (program == nullptr) return "fail " + failure + "\n";
+
+	char hex [17];
+	std::snprintf(hex, sizeof(hex), "%016llx", key.program);
+
+	auto result = results.find(key);
+
+	if (result == nullptr) {
+		result = runProgram(key, program, engine, output);
+		results.insert(std::move(key), result);
+	}
+
+	auto response = std::string("ok ") + hex + "\n"
+		+ "exit " + std::to_string(result->x) + " " + std::to_string(result->y) + " " + std::to_string(result->steps) + "\n"
+		+ "registers";
+
+	for (auto value : result->registers) response += " " + std::to_string(value);
+	response += "\n";
+
+	if (!result->error.empty()) response += "error " + result->error + "\n";
+
+	response += "output " + std::to_string(result->output.size()) + "\n" + result->output;
+
+	return response;
+}
+
+/**
+ * runs a program on the worker's engine with the inputs of a key
+ */
+auto Server568::runProgram(ResultKey568 & key, const std::shared_ptr<const Program568> & program, Engine568 & engine, std::ostringstream & output) -> std::shared_ptr<const RunResult568> {
+	if (engine.getProgram() == program) engine.reset();
+	else engine.attach(program);
+
+	for (auto i = 0u; i < key.inputs.size(); ++i) {
+		auto & values = key.inputs[i];
+
+		if (key.isArray[i]) engine.pushArray(static_cast<unsigned int>(values.size()), values.data());
+		else engine.pushInt(values[0]);
+	}
+
+	output.str("");
+
+	{
+		TIMELINE568_SPAN("run");
+		engine.run();
+	}
+
+	return std::make_shared<const RunResult568>(engine, output.str());
+}
+
+/**
+ * @param name a png path, or # and the hash of one loaded before
+ * @param hash set to the hash of the program's file
+ * @param failure set to why there is no program
+ */
+auto Server568::findProgram(const std::string & name, unsigned long long & hash, std::string & failure) -> std::shared_ptr<const Program568> {
+	if (name[0] == '#') {
+		char * end = nullptr;
+		hash = std::strtoull(name.c_str() + 1, &end, 16);
+
+		auto program = *end == '\0' ? cache.find(hash) : nullptr;
+		if (program == nullptr) failure = "Unknown program " + name;
+
+		return program;
+	}
+
+	/* mapped to be hashed, and decoded from the same mapping if it missed */
+	auto file = CNGE::MappedFile::open(name.c_str());
+
+	if (file == nullptr) {
+		failure = "Could not read " + name;
+		return nullptr;
+	}
+
+	{
+		TIMELINE568_SPAN("hash");
+		hash = ProgramCache568::hash(file->getData(), file->getSize());
+	}
+
+	auto program = cache.find(hash);
+	if (program != nullptr) return program;
+
+	auto image = std::unique_ptr<CNGE::Image>();
+
+	{
+		TIMELINE568_SPAN("decode");
+		image = CNGE::Image::fromPNG(file->getData(), file->getSize());
+	}
+
+	if (image == nullptr || !image->isValid()) {
+		failure = "Could not decode " + name;
+		return nullptr;
+	}
+
+	{
+		TIMELINE568_SPAN("load");
+		program = std::make_shared<const Program568>(image->getWidth(), image->getHeight(), image->getPixels());
+	}
+
+	cache.insert(hash, program);
+
+	return program;
+}
+
+auto Server568::getError() -> const std::string & {
+	return error;
+}
+
+auto Server568::getCache() -> ProgramCache568 & {
+	return cache;
+}
+
+auto Server568::getResults() -> ResultCache568 & {
+	return results;
+}
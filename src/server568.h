@@ -0,0 +1,84 @@
+
+#ifndef LANGUAGE568_SERVER568_H
+#define LANGUAGE568_SERVER568_H
+
+#include <string>
+#include <sstream>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <utility>
+
+#include "engine568.h"
+#include "programCache568.h"
+#include "resultCache568.h"
+
+/**
+ * runs programs for clients connecting over a unix domain socket,
+ * keeping loaded programs warm in a cache between requests,
+ * and optionally the results of runs, so a repeated request is answered without running
+ *
+ * each request is one line, a program and its inputs
+ *
+ *     run <path or #hash> [input ...]
+ *
+ * where each input is an integer, or integers separated by commas for an array,
+ * and a program is a png path or the hash an earlier response gave for it,
+ * the response is
+ *
+ *     ok <hash>
+ *     exit <x> <y> <steps>
+ *     registers <r0> ... <r5>
+ *     error <text>             only if the program errored
+ *     output <length>
+ *     <length bytes printed by the program>
+ *
+ * or a single line of fail <reason> if the request could not be run,
+ * and stats gets back one line of cache stats, with the result cache's after the program cache's
+ *
+ * a connection can send any number of requests, a worker serves it until it closes
+ *
+ * runs stop with an error past the step limit, so no request can keep a worker forever,
+ * and results are kept under the limit they ran with, so a server with another limit loading them does not reuse them
+ */
+class Server568 {
+private:
+	constexpr static unsigned int MAX_INPUTS = 5;
+	constexpr static std::size_t MAX_LINE = 1 << 16;
+
+	std::string socketPath;
+	unsigned int numWorkers;
+	unsigned long long stepLimit;
+	ProgramCache568 cache;
+	ResultCache568 results;
+
+	int listener;
+	std::atomic<bool> stopping;
+
+	/* accepted connections waiting for a worker, with when they were accepted for the timeline */
+	std::mutex queueMutex;
+	std::condition_variable queueReady;
+	std::deque<std::pair<int, long long>> connections;
+
+	std::string error;
+
+	auto work(unsigned int) -> void;
+	auto serveConnection(int, Engine568 &, std::ostringstream &) -> void;
+	auto respond(const std::string &, Engine568 &, std::ostringstream &) -> std::string;
+	auto runProgram(ResultKey568 &, const std::shared_ptr<const Program568> &, Engine568 &, std::ostringstream &) -> std::shared_ptr<const RunResult568>;
+	auto findProgram(const std::string &, unsigned long long &, std::string &) -> std::shared_ptr<const Program568>;
+
+public:
+	Server568(std::string &&, unsigned int, std::size_t, std::size_t = 0, unsigned long long = 0);
+
+	auto serve() -> bool;
+	auto stop() -> void;
+
+	auto getError() -> const std::string &;
+	auto getCache() -> ProgramCache568 &;
+	auto getResults() -> ResultCache568 &;
+};
+
+#endif //LANGUAGE568_SERVER568_H
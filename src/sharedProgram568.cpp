@@ -0,0 +1,164 @@
+
+#include "sharedProgram568.h"
+
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* ahead of the image, padded out so the image starts on a cache line */
+class SharedHeader {
+public:
+	unsigned int magic;
+	LoadStats loadStats;
+};
+
+constexpr static unsigned int MAGIC = 0x35363821;
+constexpr static std::size_t HEADER_BYTES = 64;
+
+static_assert(sizeof(SharedHeader) <= HEADER_BYTES);
+
+SharedProgram568::SharedProgram568(int fd, std::size_t bytes) : fd(fd), bytes(bytes) {}
+
+SharedProgram568::~SharedProgram568() {
+#ifdef __unix__
+	if (fd >= 0) close(fd);
+#endif
+}
+
+/**
+ * writes a program out to a new shared memory file
+ *
+ * @param error set to why the file could not be made
+ * @return nullptr on failure
+ */
+auto SharedProgram568::create(const Program568 & program, std::string & error) -> std::unique_ptr<SharedProgram568> {
+#ifdef __unix__
+	auto & image = program.getImage();
+
+	auto header = SharedHeader();
+	header.magic = MAGIC;
+	header.loadStats = program.getLoadStats();
+	header.loadStats.packed = false;
+
+	auto imageBytes = image.size() * sizeof(unsigned int);
+	auto bytes = HEADER_BYTES + imageBytes;
+
+	auto fd = -1;
+
+#ifdef __linux__
+	fd = memfd_create("language568 program", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#endif
+
+	if (fd < 0) {
+		/* named only for as long as it takes to open it */
+		static auto counter = std::atomic<unsigned int>(0);
+		auto name = "/language568-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+
+		fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd >= 0) shm_unlink(name.c_str());
+	}
+
+	if (fd < 0) {
+		error = std::string("Could not make shared memory: ") + std::strerror(errno);
+		return nullptr;
+	}
+
+	auto shared = std::unique_ptr<SharedProgram568>(new SharedProgram568(fd, bytes));
+
+	unsigned char padded [HEADER_BYTES] = {};
+	std::memcpy(padded, &header, sizeof(header));
+
+	auto writeAll = [fd](const void * data, std::size_t length, off_t offset) {
+		auto * bytes = static_cast<const char *>(data);
+
+		while (length > 0) {
+			auto written = pwrite(fd, bytes, length, offset);
+
+			if (written < 0 && errno == EINTR) continue;
+			if (written <= 0) return false;
+
+			bytes += written;
+			length -= written;
+			offset += written;
+		}
+
+		return true;
+	};
+
+	if (ftruncate(fd, off_t(bytes)) != 0 || !writeAll(padded, HEADER_BYTES, 0) || !writeAll(image.data(), imageBytes, HEADER_BYTES)) {
+		error = std::string("Could not write shared memory: ") + std::strerror(errno);
+		return nullptr;
+	}
+
+#ifdef __linux__
+	/* best effort, shm objects cannot be sealed */
+	fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+
+	return shared;
+#else
+	error = "Shared programs need unix shared memory";
+	return nullptr;
+#endif
+}
+
+/**
+ * maps a shared program read only, the descriptor can be closed afterwards
+ *
+ * @param error set to why it could not be mapped
+ * @return a program viewing the mapping, which lasts as long as the program, nullptr on failure
+ */
+auto SharedProgram568::map(int fd, std::string & error) -> std::shared_ptr<const Program568> {
+#ifdef __unix__
+	struct stat status;
+
+	if (fstat(fd, &status) != 0 || std::size_t(status.st_size) < HEADER_BYTES) {
+		error = "Not a shared program";
+		return nullptr;
+	}
+
+	auto bytes = std::size_t(status.st_size);
+	auto * address = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+
+	if (address == MAP_FAILED) {
+		error = std::string("Could not map shared program: ") + std::strerror(errno);
+		return nullptr;
+	}
+
+	auto storage = std::shared_ptr<const void>(address, [bytes](const void * mapped) {
+		munmap(const_cast<void *>(mapped), bytes);
+	});
+
+	auto header = SharedHeader();
+	std::memcpy(&header, address, sizeof(header));
+
+	auto & stats = header.loadStats;
+
+	if (header.magic != MAGIC || bytes != HEADER_BYTES + static_cast<std::size_t>(stats.width) * stats.height * sizeof(unsigned int)) {
+		error = "Not a shared program";
+		return nullptr;
+	}
+
+	auto * pixels = reinterpret_cast<const unsigned int *>(static_cast<const unsigned char *>(address) + HEADER_BYTES);
+
+	return Program568::view(pixels, stats, std::move(storage));
+#else
+	error = "Shared programs need unix shared memory";
+	return nullptr;
+#endif
+}
+
+auto SharedProgram568::getDescriptor() const -> int {
+	return fd;
+}
+
+auto SharedProgram568::getBytes() const -> std::size_t {
+	return bytes;
+}
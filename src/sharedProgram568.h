@@ -0,0 +1,37 @@
+
+#ifndef LANGUAGE568_SHAREDPROGRAM568_H
+#define LANGUAGE568_SHAREDPROGRAM568_H
+
+#include <memory>
+#include <string>
+
+#include "program568.h"
+
+/**
+ * a loaded program written once into an anonymous shared memory file,
+ * a memfd on linux or an unlinked shm object elsewhere,
+ * for other processes to map read only and run without decoding or copying it
+ *
+ * the file holds the load stats and then the image, one 0xRRGGBB color per codel,
+ * and on linux it is sealed so nothing can change it once written
+ */
+class SharedProgram568 {
+private:
+	int fd;
+	std::size_t bytes;
+
+	SharedProgram568(int, std::size_t);
+
+public:
+	static auto create(const Program568 &, std::string &) -> std::unique_ptr<SharedProgram568>;
+	static auto map(int, std::string &) -> std::shared_ptr<const Program568>;
+
+	SharedProgram568(const SharedProgram568 &) = delete;
+	auto operator=(const SharedProgram568 &) -> SharedProgram568 & = delete;
+	~SharedProgram568();
+
+	auto getDescriptor() const -> int;
+	auto getBytes() const -> std::size_t;
+};
+
+#endif //LANGUAGE568_SHAREDPROGRAM568_H
@@ -0,0 +1,438 @@
+
+#include "supervisor568.h"
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <new>
+
+#include "engine568.h"
+
+#ifdef __unix__
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+
+SupervisorResult568::SupervisorResult568() :
+	crashed(false),
+	timedOut(false),
+	attempts(0),
+	x(0),
+	y(0),
+	steps(0),
+	registers(),
+	error(),
+	outputLength(0),
+	output() {}
+
+enum class SlotState : unsigned int {
+	FREE,
+	QUEUED,
+	RUNNING,
+	DONE,
+};
+
+class SupervisorSlot568 {
+public:
+	SlotState state;
+	unsigned int numInputs;
+	int inputs [Supervisor568::MAX_INPUTS];
+	/* when a worker took it, on the monotonic clock */
+	long long started;
+	SupervisorResult568 result;
+};
+
+#ifdef __unix__
+static auto monotonicNanoseconds() -> long long {
+	auto now = timespec();
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+/**
+ * everything the supervisor and its workers share, mapped before the workers are forked
+ *
+ * the mutex is robust so a worker dying while holding it does not hang everyone else,
+ * and waiting is done on semaphores rather than condition variables,
+ * which a process dying partway through a wait can leave stuck
+ */
+class SupervisorShared568 {
+public:
+	constexpr static unsigned int SLOTS = 256;
+	constexpr static unsigned int MAX_WORKERS = 256;
+	constexpr static unsigned int LOW_WATER = SLOTS / 4;
+
+	pthread_mutex_t mutex;
+	/* posted once per queued job, spare posts just wake a worker to find the ring empty */
+	sem_t jobsReady;
+	/* posted by workers finishing a job with the ring running low */
+	sem_t resultsReady;
+
+	bool stopping;
+
+	/* slots waiting for a worker, taken from head and added at tail */
+	unsigned int head, tail;
+	unsigned int ring [SLOTS];
+
+	/* the slot each worker is running, -1 while it waits */
+	int running [MAX_WORKERS];
+
+	SupervisorSlot568 slots [SLOTS];
+
+	auto lock() -> void {
+		/* whoever held it died, nothing it guards is left half written for long enough to matter */
+		if (pthread_mutex_lock(&mutex) == EOWNERDEAD) pthread_mutex_consistent(&mutex);
+	}
+
+	auto unlock() -> void {
+		pthread_mutex_unlock(&mutex);
+	}
+
+	auto push(unsigned int slot) -> void {
+		slots[slot].state = SlotState::QUEUED;
+		ring[tail++ % SLOTS] = slot;
+	}
+};
+#else
+class SupervisorShared568 {};
+#endif
+
+/**
+ * @param numWorkers how many worker processes to keep running
+ * @param stepLimit how many steps a job runs before it stops with an error, 0 for no limit
+ * @param timeoutMilliseconds how long a job runs before its worker is killed, 0 for no limit
+ */
+Supervisor568::Supervisor568(const Program568 & source, unsigned int numWorkers, unsigned long long stepLimit, unsigned int timeoutMilliseconds) :
+	program(),
+	numWorkers(0),
+	stepLimit(stepLimit),
+	timeoutNanoseconds(timeoutMilliseconds * 1000000ull),
+	shared(nullptr),
+	workers(),
+	restarts(0),
+	error()
+{
+#ifdef __unix__
+	program = SharedProgram568::create(source, error);
+	if (program == nullptr) return;
+
+	auto * mapped = mmap(nullptr, sizeof(SupervisorShared568), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (mapped == MAP_FAILED) {
+		error = std::string("Could not map shared memory: ") + std::strerror(errno);
+		return;
+	}
+
+	shared = new (mapped) SupervisorShared568();
+
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+	pthread_mutex_init(&shared->mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	sem_init(&shared->jobsReady, 1, 0);
+	sem_init(&shared->resultsReady, 1, 0);
+
+	shared->stopping = false;
+	shared->head = shared->tail = 0;
+
+	for (auto & slot : shared->running) slot = -1;
+	for (auto & slot : shared->slots) slot.state = SlotState::FREE;
+
+	this->numWorkers = std::clamp(numWorkers, 1u, SupervisorShared568::MAX_WORKERS);
+	workers.assign(this->numWorkers, -1);
+
+	for (auto i = 0u; i < this->numWorkers; ++i) {
+		if (!spawn(i)) return;
+	}
+#else
+	error = "Supervising workers needs fork and shared memory";
+#endif
+}
+
+/**
+ * lets the workers finish what they are running and waits for them to exit
+ */
+Supervisor568::~Supervisor568() {
+#ifdef __unix__
+	if (shared == nullptr) return;
+
+	shared->lock();
+	shared->stopping = true;
+	shared->unlock();
+
+	for (auto i = 0u; i < numWorkers; ++i) sem_post(&shared->jobsReady);
+
+	for (auto pid : workers) {
+		if (pid > 0) waitpid(pid, nullptr, 0);
+	}
+
+	sem_destroy(&shared->jobsReady);
+	sem_destroy(&shared->resultsReady);
+	pthread_mutex_destroy(&shared->mutex);
+
+	munmap(shared, sizeof(SupervisorShared568));
+#endif
+}
+
+/**
+ * forks the worker with an index, which never returns into the caller
+ *
+ * @return false if the fork failed
+ */
+auto Supervisor568::spawn(unsigned int index) -> bool {
+#ifdef __unix__
+	auto pid = fork();
+
+	if (pid < 0) {
+		error = std::string("Could not fork a worker: ") + std::strerror(errno);
+		return false;
+	}
+
+	if (pid == 0) {
+		work(index);
+
+		/* skips the exit handlers and destructors of the supervisor's copy of the process */
+		_exit(0);
+	}
+
+	workers[index] = pid;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * the loop of a worker process, takes jobs off the ring until the supervisor stops
+ */
+auto Supervisor568::work(unsigned int index) -> void {
+#ifdef __unix__
+	auto mapError = std::string();
+	auto mapped = SharedProgram568::map(program->getDescriptor(), mapError);
+	if (mapped == nullptr) return;
+
+	auto engine = Engine568(mapped);
+	auto output = std::ostringstream();
+	engine.setOutput(output);
+	engine.setStepLimit(stepLimit);
+
+	/* the slot of the job just run, handed back in the same lock as taking the next */
+	auto finished = -1;
+
+	while (true) {
+		/* only waits once the ring was empty, jobs taken straight after another leave a spare post behind */
+		if (finished < 0) while (sem_wait(&shared->jobsReady) != 0 && errno == EINTR);
+
+		shared->lock();
+
+		if (finished >= 0) {
+			shared->slots[finished].state = SlotState::DONE;
+			shared->running[index] = -1;
+		}
+
+		auto queued = shared->tail - shared->head;
+		auto taken = -1;
+
+		if (queued > 0) {
+			taken = int(shared->ring[shared->head++ % SupervisorShared568::SLOTS]);
+			shared->slots[taken].state = SlotState::RUNNING;
+			shared->slots[taken].started = monotonicNanoseconds();
+			++shared->slots[taken].result.attempts;
+			shared->running[index] = taken;
+		}
+
+		auto stopping = shared->stopping;
+		shared->unlock();
+
+		/* the supervisor is only woken to collect results and refill once the ring runs low */
+		if (finished >= 0 && queued <= SupervisorShared568::LOW_WATER) sem_post(&shared->resultsReady);
+
+		finished = -1;
+
+		if (taken < 0) {
+			if (stopping) return;
+			continue;
+		}
+
+		auto & slot = shared->slots[taken];
+
+		/* the job is only read and the result only written by this worker while it runs */
+		engine.reset();
+		for (auto i = 0u; i < slot.numInputs; ++i) engine.pushInt(slot.inputs[i]);
+
+		output.str("");
+		engine.run();
+
+		auto & result = slot.result;
+		result.x = engine.getX();
+		result.y = engine.getY();
+		result.steps = engine.getSteps();
+		for (auto i = 0u; i < 6; ++i) result.registers[i] = engine.getInt(i);
+
+		auto engineError = engine.getError();
+		auto errorLength = std::min<std::size_t>(engineError.size(), SupervisorResult568::MAX_ERROR - 1);
+		std::memcpy(result.error, engineError.data(), errorLength);
+		result.error[errorLength] = '\0';
+
+		auto printed = output.str();
+		result.outputLength = static_cast<unsigned int>(std::min<std::size_t>(printed.size(), SupervisorResult568::MAX_OUTPUT));
+		std::memcpy(result.output, printed.data(), result.outputLength);
+
+		finished = taken;
+	}
+#endif
+}
+
+/**
+ * kills workers that have been on one job for longer than the timeout,
+ * then finds workers that have died, puts back or gives up on the job each was running,
+ * and forks them again
+ */
+auto Supervisor568::reap() -> void {
+#ifdef __unix__
+	auto now = monotonicNanoseconds();
+
+	/* whether the job a worker died on had run out of time, rather than the worker being killed just as it took it */
+	auto overdue = [this, now](int slot) {
+		return timeoutNanoseconds != 0 && now - shared->slots[slot].started > static_cast<long long>(timeoutNanoseconds);
+	};
+
+	if (timeoutNanoseconds != 0) {
+		shared->lock();
+
+		/* a worker not yet reaped is at worst a zombie, so its pid cannot have been taken by another process */
+		for (auto i = 0u; i < numWorkers; ++i) {
+			if (workers[i] > 0 && shared->running[i] >= 0 && overdue(shared->running[i])) kill(workers[i], SIGKILL);
+		}
+
+		shared->unlock();
+	}
+
+	for (auto i = 0u; i < numWorkers; ++i) {
+		if (workers[i] <= 0 || waitpid(workers[i], nullptr, WNOHANG) != workers[i]) continue;
+
+		workers[i] = -1;
+
+		shared->lock();
+
+		auto slot = shared->running[i];
+		shared->running[i] = -1;
+
+		if (slot >= 0) {
+			auto & result = shared->slots[slot].result;
+			result.timedOut = overdue(slot);
+
+			if (result.timedOut || result.attempts >= MAX_ATTEMPTS) {
+				result.crashed = true;
+				shared->slots[slot].state = SlotState::DONE;
+				sem_post(&shared->resultsReady);
+			} else {
+				shared->push(static_cast<unsigned int>(slot));
+				sem_post(&shared->jobsReady);
+			}
+		}
+
+		shared->unlock();
+
+		/* it may have died having taken a post without taking a job */
+		sem_post(&shared->jobsReady);
+
+		if (spawn(i)) ++restarts;
+	}
+#endif
+}
+
+/**
+ * @return true if the program was shared and every worker started
+ */
+auto Supervisor568::isRunning() -> bool {
+	return shared != nullptr && error.empty();
+}
+
+/**
+ * runs the program once for each set of inputs, blocking until all of them are done
+ *
+ * @return a result for every job in the order given, empty if the supervisor is not running
+ */
+auto Supervisor568::run(const std::vector<std::vector<int>> & jobs) -> std::vector<SupervisorResult568> {
+	auto results = std::vector<SupervisorResult568>();
+
+#ifdef __unix__
+	if (!isRunning()) return results;
+
+	results.resize(jobs.size());
+
+	/* which job of the batch is in each slot */
+	auto slotJobs = std::vector<std::size_t>(SupervisorShared568::SLOTS, 0);
+
+	auto next = std::size_t(0);
+	auto remaining = jobs.size();
+
+	while (remaining > 0) {
+		auto queued = 0u;
+
+		shared->lock();
+
+		for (auto s = 0u; s < SupervisorShared568::SLOTS; ++s) {
+			auto & slot = shared->slots[s];
+
+			if (slot.state == SlotState::DONE) {
+				results[slotJobs[s]] = slot.result;
+				slot.state = SlotState::FREE;
+				--remaining;
+			}
+
+			if (slot.state == SlotState::FREE && next < jobs.size()) {
+				auto & inputs = jobs[next];
+
+				slot.numInputs = static_cast<unsigned int>(std::min<std::size_t>(inputs.size(), MAX_INPUTS));
+				std::copy_n(inputs.begin(), slot.numInputs, slot.inputs);
+				slot.result = SupervisorResult568();
+
+				slotJobs[s] = next++;
+				shared->push(s);
+				++queued;
+			}
+		}
+
+		shared->unlock();
+
+		for (auto i = 0u; i < queued; ++i) sem_post(&shared->jobsReady);
+
+		reap();
+
+		if (remaining == 0) break;
+
+		/* wakes for a result, or every few milliseconds to look for workers that died */
+		auto deadline = timespec();
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += 5000000;
+		if (deadline.tv_nsec >= 1000000000) deadline.tv_sec += 1, deadline.tv_nsec -= 1000000000;
+
+		if (sem_timedwait(&shared->resultsReady, &deadline) == 0) while (sem_trywait(&shared->resultsReady) == 0);
+	}
+#endif
+
+	return results;
+}
+
+/**
+ * @return how many workers have been forked again after dying
+ */
+auto Supervisor568::getRestarts() -> unsigned long long {
+	return restarts;
+}
+
+auto Supervisor568::getError() -> const std::string & {
+	return error;
+}
@@ -0,0 +1,90 @@
+
+#ifndef LANGUAGE568_SUPERVISOR568_H
+#define LANGUAGE568_SUPERVISOR568_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "program568.h"
+#include "sharedProgram568.h"
+
+class SupervisorShared568;
+
+/**
+ * how one job of a batch ended
+ */
+class SupervisorResult568 {
+public:
+	constexpr static unsigned int MAX_ERROR = 256;
+	constexpr static unsigned int MAX_OUTPUT = 1024;
+
+	SupervisorResult568();
+
+	/* the worker running it died every time it was tried, or was killed for running too long */
+	bool crashed;
+	bool timedOut;
+	unsigned int attempts;
+
+	int x, y;
+	unsigned long long steps;
+	int registers [6];
+
+	/* empty if the program did not error, both cut off at their maximum */
+	char error [MAX_ERROR];
+	unsigned int outputLength;
+	char output [MAX_OUTPUT];
+};
+
+/**
+ * runs batches of one program across worker processes, so a job that crashes or leaks
+ * only takes its own worker down and not the batch
+ *
+ * the program is put in shared memory once and every worker maps it read only,
+ * jobs go to the workers through a ring in shared memory, and their results come back the same way
+ *
+ * a worker that dies is forked again, and the job it was running is put back on the ring
+ * until it has been tried MAX_ATTEMPTS times, after which it is reported as crashed
+ *
+ * a worker still on one job after the timeout is killed and its job reported as crashed and timed out straight away,
+ * runs are deterministic so another try would only run out of time again,
+ * and each worker's engine stops by itself once past the step limit, with an error like any other
+ *
+ * jobs are integer inputs only, at most MAX_INPUTS of them
+ */
+class Supervisor568 {
+private:
+	constexpr static unsigned int MAX_ATTEMPTS = 3;
+
+	std::unique_ptr<SharedProgram568> program;
+	unsigned int numWorkers;
+	unsigned long long stepLimit;
+	unsigned long long timeoutNanoseconds;
+
+	SupervisorShared568 * shared;
+	std::vector<int> workers;
+	unsigned long long restarts;
+
+	std::string error;
+
+	auto spawn(unsigned int) -> bool;
+	auto work(unsigned int) -> void;
+	auto reap() -> void;
+
+public:
+	constexpr static unsigned int MAX_INPUTS = 5;
+
+	Supervisor568(const Program568 &, unsigned int, unsigned long long = 0, unsigned int = 0);
+	~Supervisor568();
+
+	Supervisor568(const Supervisor568 &) = delete;
+	auto operator=(const Supervisor568 &) -> Supervisor568 & = delete;
+
+	auto isRunning() -> bool;
+	auto run(const std::vector<std::vector<int>> &) -> std::vector<SupervisorResult568>;
+
+	auto getRestarts() -> unsigned long long;
+	auto getError() -> const std::string &;
+};
+
+#endif //LANGUAGE568_SUPERVISOR568_H
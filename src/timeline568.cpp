@@ -0,0 +1,139 @@
+
+#include "timeline568.h"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdio>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+/* buffers are kept for the life of the process, so threads that have ended still show up */
+static auto registryMutex = std::mutex();
+static auto buffers = std::vector<std::unique_ptr<TimelineBuffer568>>();
+
+static const auto epoch = std::chrono::steady_clock::now();
+
+/* the name a thread gave itself, kept until it gets a buffer */
+static thread_local std::string threadName;
+static thread_local TimelineBuffer568 * threadBuffer = nullptr;
+
+/* events are left uninitialized, so pages of the buffer are only touched as spans fill them */
+TimelineBuffer568::TimelineBuffer568(unsigned int thread, std::string && name) :
+	thread(thread),
+	name(std::move(name)),
+	count(0),
+	dropped(0) {}
+
+auto Timeline568::enable(bool on) -> void {
+	enabled = on;
+}
+
+/**
+ * @return nanoseconds since the timeline began
+ */
+auto Timeline568::now() -> long long {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+auto Timeline568::getBuffer() -> TimelineBuffer568 & {
+	if (threadBuffer == nullptr) {
+		auto lock = std::lock_guard(registryMutex);
+
+		auto thread = static_cast<unsigned int>(buffers.size()) + 1;
+		buffers.push_back(std::make_unique<TimelineBuffer568>(thread, threadName.empty() ? "thread " + std::to_string(thread) : std::string(threadName)));
+		threadBuffer = buffers.back().get();
+	}
+
+	return *threadBuffer;
+}
+
+/**
+ * adds a span to the calling thread's buffer
+ *
+ * @param name a string literal, only its address is kept
+ */
+auto Timeline568::record(const char * name, long long begin, long long end) -> void {
+	auto & buffer = getBuffer();
+	auto count = buffer.count.load(std::memory_order_relaxed);
+
+	if (count == TimelineBuffer568::CAPACITY) {
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer.events[count] = TimelineEvent568 { name, begin, end };
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * names the calling thread's track in the timeline, only takes effect before the thread first records
+ */
+auto Timeline568::setThreadName(std::string && name) -> void {
+	threadName = std::move(name);
+}
+
+static auto writeString(std::ostream & out, const std::string & string) -> void {
+	out << '"';
+
+	for (auto c : string) {
+		if (c == '"' || c == '\\') out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+		else out << c;
+	}
+
+	out << '"';
+}
+
+/**
+ * writes every span recorded so far as chrome trace event json,
+ * complete events with times in microseconds and a track per thread
+ */
+auto Timeline568::write(std::ostream & out) -> void {
+#ifdef __unix__
+	auto process = static_cast<long long>(getpid());
+#else
+	auto process = 1ll;
+#endif
+
+	auto lock = std::lock_guard(registryMutex);
+	auto dropped = 0ull;
+	auto first = true;
+
+	out << "{\"traceEvents\":[";
+
+	auto separate = [&]() {
+		if (!first) out << ",";
+		out << "\n";
+		first = false;
+	};
+
+	char time [64];
+
+	for (auto & buffer : buffers) {
+		separate();
+		out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << process << ",\"tid\":" << buffer->thread << ",\"args\":{\"name\":";
+		writeString(out, buffer->name);
+		out << "}}";
+
+		auto count = buffer->count.load(std::memory_order_acquire);
+
+		for (auto i = 0u; i < count; ++i) {
+			auto & event = buffer->events[i];
+
+			separate();
+			out << "{\"name\":";
+			writeString(out, event.name);
+
+			std::snprintf(time, sizeof(time), ",\"ts\":%.3f,\"dur\":%.3f", double(event.begin) / 1000.0, double(event.end - event.begin) / 1000.0);
+			out << ",\"ph\":\"X\"" << time << ",\"pid\":" << process << ",\"tid\":" << buffer->thread << "}";
+		}
+
+		dropped += buffer->dropped.load(std::memory_order_relaxed);
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":\"" << dropped << "\"}}\n";
+}
@@ -0,0 +1,106 @@
+
+#ifndef LANGUAGE568_TIMELINE568_H
+#define LANGUAGE568_TIMELINE568_H
+
+#include <atomic>
+#include <string>
+#include <ostream>
+
+/**
+ * one phase on one thread, the name always a string literal so recording never allocates
+ */
+class TimelineEvent568 {
+public:
+	const char * name;
+	/* nanoseconds since the timeline began */
+	long long begin, end;
+};
+
+/**
+ * the spans one thread has recorded, only ever written by that thread
+ *
+ * the thread publishes each event by bumping the count after writing it,
+ * so the timeline can be written out while threads are still recording
+ */
+class TimelineBuffer568 {
+public:
+	constexpr static unsigned int CAPACITY = 1u << 16u;
+
+	TimelineBuffer568(unsigned int, std::string &&);
+
+	unsigned int thread;
+	std::string name;
+
+	TimelineEvent568 events [CAPACITY];
+	std::atomic<unsigned int> count;
+	/* spans recorded after the buffer filled up */
+	std::atomic<unsigned long long> dropped;
+};
+
+/**
+ * spans of time threads spend in phases like queueing, decoding, loading and running,
+ * written out as chrome trace event json that chrome://tracing and perfetto open
+ *
+ * every thread records into its own buffer, made the first time it records,
+ * so recording takes no locks and threads never wait on each other
+ *
+ * off until enabled, while off a span costs one relaxed load,
+ * and configuring with LANGUAGE568_TIMELINE off compiles the span macros away entirely
+ */
+class Timeline568 {
+private:
+	inline static std::atomic<bool> enabled = false;
+
+	static auto getBuffer() -> TimelineBuffer568 &;
+
+public:
+	static auto enable(bool) -> void;
+	static auto isEnabled() -> bool;
+
+	static auto now() -> long long;
+	static auto record(const char *, long long, long long) -> void;
+	static auto setThreadName(std::string &&) -> void;
+
+	static auto write(std::ostream &) -> void;
+};
+
+inline auto Timeline568::isEnabled() -> bool {
+	return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * records the time from its construction to the end of its scope
+ */
+class TimelineSpan568 {
+private:
+	const char * name;
+	/* -1 when the timeline was off as the span began */
+	long long begin;
+
+public:
+	inline explicit TimelineSpan568(const char * name) : name(name), begin(Timeline568::isEnabled() ? Timeline568::now() : -1) {}
+
+	inline ~TimelineSpan568() {
+		if (begin >= 0) Timeline568::record(name, begin, Timeline568::now());
+	}
+
+	TimelineSpan568(const TimelineSpan568 &) = delete;
+	auto operator=(const TimelineSpan568 &) -> TimelineSpan568 & = delete;
+};
+
+#ifndef LANGUAGE568_NO_TIMELINE
+#define TIMELINE568_JOIN_(a, b) a##b
+#define TIMELINE568_JOIN(a, b) TIMELINE568_JOIN_(a, b)
+
+/* the rest of the enclosing scope as a span */
+#define TIMELINE568_SPAN(name) TimelineSpan568 TIMELINE568_JOIN(timelineSpan, __LINE__)(name)
+/* a span that began on another thread, from a time taken with TIMELINE568_NOW */
+#define TIMELINE568_RECORD(name, begin) do { if ((begin) >= 0) Timeline568::record(name, begin, Timeline568::now()); } while (false)
+#define TIMELINE568_NOW() (Timeline568::isEnabled() ? Timeline568::now() : -1ll)
+#else
+#define TIMELINE568_SPAN(name) do {} while (false)
+#define TIMELINE568_RECORD(name, begin) do {} while (false)
+#define TIMELINE568_NOW() (-1ll)
+#endif
+
+#endif //LANGUAGE568_TIMELINE568_H
@@ -0,0 +1,327 @@
+
+#include "trace568.h"
+
+#include "engine568Run.h"
+
+static const char TRACE_MAGIC [8] = { 'L', '5', '6', '8', 'T', 'R', 'C', 1 };
+
+/* header varint plus the largest payload, the end event */
+constexpr static unsigned int MAX_EVENT_SIZE = 10 + 1 + 5 + 5;
+
+static auto zigzag(int value) -> unsigned long long {
+	return (static_cast<unsigned int>(value) << 1u) ^ static_cast<unsigned int>(value >> 31);
+}
+
+static auto unzigzag(unsigned long long value) -> int {
+	return static_cast<int>((value >> 1u) ^ (~(value & 1u) + 1u));
+}
+
+TraceEvent::TraceEvent() : kind(TraceKind::END), step(0), value(0), size(0), x(0), y(0) {}
+
+TraceInput::TraceInput() : isArray(false), integer(0), array() {}
+
+TraceRecorder::TraceRecorder(std::ostream & sink, unsigned int blockSize) :
+	sink(sink),
+	buffer(blockSize + MAX_EVENT_SIZE),
+	used(0),
+	blockSize(blockSize),
+	lastStep(0),
+	lastAllocSize(0),
+	ended(false)
+{}
+
+TraceRecorder::~TraceRecorder() {
+	flush();
+}
+
+/**
+ * every event fits in the slack past the block size,
+ * so writes never have to check for room
+ */
+auto TraceRecorder::putVarint(unsigned long long value) -> void {
+	auto * out = buffer.data() + used;
+
+	while (value >= 0x80) {
+		*out++ = static_cast<unsigned char>(value | 0x80u);
+		value >>= 7u;
+	}
+
+	*out++ = static_cast<unsigned char>(value);
+
+	used = out - buffer.data();
+}
+
+auto TraceRecorder::putSigned(int value) -> void {
+	putVarint(zigzag(value));
+}
+
+/**
+ * event header, the kind in the low three bits and
+ * the number of instructions since the last event above it
+ */
+auto TraceRecorder::putEvent(TraceKind kind, unsigned long long step) -> void {
+	putVarint(((step - lastStep) << 3u) | static_cast<unsigned int>(kind));
+	lastStep = step;
+}
+
+auto TraceRecorder::flushIfFull() -> void {
+	if (used >= blockSize) flush();
+}
+
+auto TraceRecorder::makeRoom(unsigned int size) -> void {
+	if (used + size > buffer.size()) flush();
+}
+
+/**
+ * writes the header and the values that were pushed into the engine before running
+ */
+auto TraceRecorder::begin(RegisterValue * inputs, unsigned int numInputs) -> void {
+	/* the header has to sit at the start of the first block */
+	flush();
+
+	for (auto c : TRACE_MAGIC) buffer[used++] = c;
+
+	putVarint(numInputs);
+
+	for (auto i = 0u; i < numInputs; ++i) {
+		auto & input = inputs[i];
+
+		makeRoom(MAX_EVENT_SIZE);
+
+		if (input.array == nullptr) {
+			putVarint(0);
+			putSigned(input.integer);
+
+		} else {
+			putVarint(1);
+			putVarint(input.array->size());
+
+			auto last = 0;
+			for (auto element : *input.array) {
+				makeRoom(5);
+				putSigned(element - last);
+				last = element;
+			}
+		}
+	}
+
+	lastStep = 0;
+	lastAllocSize = 0;
+	ended = false;
+}
+
+auto TraceRecorder::branch(unsigned long long step, bool taken) -> void {
+	putEvent(taken ? TraceKind::BRANCH_TAKEN : TraceKind::BRANCH_NOT_TAKEN, step);
+
+	flushIfFull();
+}
+
+auto TraceRecorder::switchCase(unsigned long long step, int choice) -> void {
+	putEvent(TraceKind::SWITCH, step);
+	putVarint(choice);
+
+	flushIfFull();
+}
+
+auto TraceRecorder::alloc(unsigned long long step, unsigned int registerIndex, int size) -> void {
+	putEvent(TraceKind::ALLOC, step);
+	buffer[used++] = registerIndex;
+	putSigned(size - lastAllocSize);
+	lastAllocSize = size;
+
+	flushIfFull();
+}
+
+auto TraceRecorder::end(unsigned long long step, int x, int y, bool error) -> void {
+	if (ended) return;
+
+	putEvent(TraceKind::END, step);
+	buffer[used++] = error;
+	putSigned(x);
+	putSigned(y);
+
+	ended = true;
+	flush();
+}
+
+/**
+ * blocks are written as a four byte little endian length followed by the bytes
+ */
+auto TraceRecorder::flush() -> void {
+	if (used == 0) return;
+
+	auto length = used;
+	unsigned char header [4] = {
+		static_cast<unsigned char>(length),
+		static_cast<unsigned char>(length >> 8u),
+		static_cast<unsigned char>(length >> 16u),
+		static_cast<unsigned char>(length >> 24u)
+	};
+
+	sink.write(reinterpret_cast<const char *>(header), 4);
+	sink.write(reinterpret_cast<const char *>(buffer.data()), length);
+	sink.flush();
+
+	used = 0;
+}
+
+TraceObserver568::TraceObserver568(TraceRecorder & recorder) : recorder(recorder) {}
+
+auto TraceObserver568::onStart(Engine568 & engine) -> void {
+	recorder.begin(&engine.getRegister(0) + 1, engine.getNumInputs());
+}
+
+auto TraceObserver568::onBranch(Engine568 & engine, bool taken) -> void {
+	recorder.branch(engine.getSteps(), taken);
+}
+
+auto TraceObserver568::onSwitch(Engine568 & engine, int choice) -> void {
+	recorder.switchCase(engine.getSteps(), choice);
+}
+
+auto TraceObserver568::onAlloc(Engine568 & engine, unsigned int registerIndex, int size) -> void {
+	recorder.alloc(engine.getSteps(), registerIndex, size);
+}
+
+auto TraceObserver568::onEnd(Engine568 & engine) -> void {
+	recorder.end(engine.getSteps(), engine.getX(), engine.getY(), !engine.getError().empty());
+}
+
+template auto Engine568::run(TraceObserver568 &) -> void;
+
+TraceReader::TraceReader(std::istream & source) :
+	source(source),
+	block(),
+	position(0),
+	lastStep(0),
+	lastAllocSize(0),
+	valid(false),
+	inputs()
+{
+	if (!readBlock() || block.size() < sizeof(TRACE_MAGIC)) return;
+
+	for (auto i = 0u; i < sizeof(TRACE_MAGIC); ++i)
+		if (block[i] != static_cast<unsigned char>(TRACE_MAGIC[i])) return;
+
+	position = sizeof(TRACE_MAGIC);
+
+	auto numInputs = 0ull;
+	if (!getVarint(numInputs)) return;
+
+	inputs.resize(numInputs);
+
+	for (auto & input : inputs) {
+		auto isArray = 0ull;
+		if (!getVarint(isArray)) return;
+
+		input.isArray = isArray != 0;
+
+		if (input.isArray) {
+			auto length = 0ull;
+			if (!getVarint(length)) return;
+
+			input.array.resize(length);
+
+			auto last = 0;
+			for (auto & element : input.array) {
+				auto delta = 0;
+				if (!getSigned(delta)) return;
+
+				element = last + delta;
+				last = element;
+			}
+
+		} else if (!getSigned(input.integer)) return;
+	}
+
+	valid = true;
+}
+
+auto TraceReader::readBlock() -> bool {
+	unsigned char header [4];
+	if (!source.read(reinterpret_cast<char *>(header), 4)) return false;
+
+	auto length = header[0] | (header[1] << 8u) | (header[2] << 16u) | (header[3] << 24u);
+
+	block.resize(length);
+	position = 0;
+
+	return static_cast<bool>(source.read(reinterpret_cast<char *>(block.data()), length));
+}
+
+auto TraceReader::getVarint(unsigned long long & value) -> bool {
+	value = 0;
+
+	for (auto shift = 0u; shift < 64; shift += 7) {
+		/* a large header can run over into the next block */
+		if (position == block.size() && !readBlock()) return false;
+
+		auto byte = block[position++];
+		value |= static_cast<unsigned long long>(byte & 0x7fu) << shift;
+
+		if ((byte & 0x80u) == 0) return true;
+	}
+
+	return false;
+}
+
+auto TraceReader::getSigned(int & value) -> bool {
+	auto raw = 0ull;
+	if (!getVarint(raw)) return false;
+
+	value = unzigzag(raw);
+	return true;
+}
+
+auto TraceReader::isValid() -> bool {
+	return valid;
+}
+
+auto TraceReader::getInputs() -> std::vector<TraceInput> & {
+	return inputs;
+}
+
+/**
+ * @return false once the trace is exhausted or malformed
+ */
+auto TraceReader::next(TraceEvent & event) -> bool {
+	if (!valid) return false;
+
+	auto header = 0ull;
+	if (!getVarint(header)) return false;
+
+	event = TraceEvent();
+	event.kind = static_cast<TraceKind>(header & 7u);
+	event.step = lastStep + (header >> 3u);
+	lastStep = event.step;
+
+	auto raw = 0ull;
+
+	switch (event.kind) {
+		case TraceKind::BRANCH_NOT_TAKEN:
+		case TraceKind::BRANCH_TAKEN:
+			break;
+		case TraceKind::SWITCH: {
+			if (!getVarint(raw)) return false;
+			event.value = static_cast<int>(raw);
+			break;
+		}
+		case TraceKind::ALLOC: {
+			auto delta = 0;
+			if (!getVarint(raw) || !getSigned(delta)) return false;
+
+			event.value = static_cast<int>(raw);
+			event.size = lastAllocSize + delta;
+			lastAllocSize = event.size;
+			break;
+		}
+		case TraceKind::END: {
+			if (!getVarint(raw) || !getSigned(event.x) || !getSigned(event.y)) return false;
+			event.value = static_cast<int>(raw);
+			break;
+		}
+		default: return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,129 @@
+
+#ifndef LANGUAGE568_TRACE568_H
+#define LANGUAGE568_TRACE568_H
+
+#include <vector>
+#include <istream>
+#include <ostream>
+
+#include "engine568Observer.h"
+
+class RegisterValue;
+
+enum class TraceKind : unsigned char {
+	BRANCH_NOT_TAKEN = 0,
+	BRANCH_TAKEN = 1,
+	SWITCH = 2,
+	ALLOC = 3,
+	END = 4,
+};
+
+class TraceEvent {
+public:
+	TraceEvent();
+
+	TraceKind kind;
+	unsigned long long step;
+
+	/* switch choice, allocated register, or error flag at the end */
+	int value;
+	/* allocation size */
+	int size;
+	/* final position at the end */
+	int x, y;
+};
+
+class TraceInput {
+public:
+	TraceInput();
+
+	bool isArray;
+	int integer;
+	std::vector<int> array;
+};
+
+/**
+ * records the decisions an engine makes while running
+ *
+ * events are delta encoded against the instruction count of the previous event
+ * and written as varints into a buffer that is flushed to the sink in large blocks
+ */
+class TraceRecorder {
+private:
+	std::ostream & sink;
+	std::vector<unsigned char> buffer;
+	unsigned int used;
+	unsigned int blockSize;
+
+	unsigned long long lastStep;
+	int lastAllocSize;
+	bool ended;
+
+	auto putVarint(unsigned long long) -> void;
+	auto putSigned(int) -> void;
+	auto putEvent(TraceKind, unsigned long long) -> void;
+	auto flushIfFull() -> void;
+	auto makeRoom(unsigned int) -> void;
+
+public:
+	constexpr static unsigned int DEFAULT_BLOCK_SIZE = 1u << 16u;
+
+	explicit TraceRecorder(std::ostream &, unsigned int = DEFAULT_BLOCK_SIZE);
+	~TraceRecorder();
+
+	auto begin(RegisterValue *, unsigned int) -> void;
+
+	auto branch(unsigned long long, bool) -> void;
+	auto switchCase(unsigned long long, int) -> void;
+	auto alloc(unsigned long long, unsigned int, int) -> void;
+	auto end(unsigned long long, int, int, bool) -> void;
+
+	auto flush() -> void;
+};
+
+/**
+ * feeds the decisions of an observed run into a recorder
+ */
+class TraceObserver568 : public NullObserver568 {
+private:
+	TraceRecorder & recorder;
+
+public:
+	explicit TraceObserver568(TraceRecorder &);
+
+	auto onStart(Engine568 &) -> void;
+	auto onBranch(Engine568 &, bool) -> void;
+	auto onSwitch(Engine568 &, int) -> void;
+	auto onAlloc(Engine568 &, unsigned int, int) -> void;
+	auto onEnd(Engine568 &) -> void;
+};
+
+/**
+ * reads back a trace written by a TraceRecorder one block at a time
+ */
+class TraceReader {
+private:
+	std::istream & source;
+	std::vector<unsigned char> block;
+	unsigned int position;
+
+	unsigned long long lastStep;
+	int lastAllocSize;
+	bool valid;
+
+	std::vector<TraceInput> inputs;
+
+	auto readBlock() -> bool;
+	auto getVarint(unsigned long long &) -> bool;
+	auto getSigned(int &) -> bool;
+
+public:
+	explicit TraceReader(std::istream &);
+
+	auto isValid() -> bool;
+	auto getInputs() -> std::vector<TraceInput> &;
+
+	auto next(TraceEvent &) -> bool;
+};
+
+#endif //LANGUAGE568_TRACE568_H
@@ -0,0 +1,342 @@
+
+#include "verifier568.h"
+
+#include "engine568.h"
+
+static auto directionName(int dx, int dy) -> const char * {
+	if (dx < 0) return "left";
+	else if (dx > 0) return "right";
+	else if (dy < 0) return "up";
+	else return "down";
+}
+
+static auto colorName(unsigned int color) -> const char * {
+	switch (color) {
+		case Engine568::RED: return "red";
+		case Engine568::YELLOW: return "yellow";
+		case Engine568::GREEN: return "green";
+		case Engine568::CYAN: return "cyan";
+		case Engine568::BLUE: return "blue";
+		case Engine568::MAGENTA: return "magenta";
+		default: return "unknown";
+	}
+}
+
+VerifyError::VerifyError(int x, int y, int dx, int dy, int instructionX, int instructionY, std::string && message) :
+	x(x), y(y), dx(dx), dy(dy), instructionX(instructionX), instructionY(instructionY), message(message) {}
+
+auto VerifyError::toString() const -> std::string {
+	return std::string("VERIFY | x: ") + std::to_string(x) + " y: " + std::to_string(y) + " d: " + directionName(dx, dy)
+		+ " | " + message + " (instruction at " + std::to_string(instructionX) + ", " + std::to_string(instructionY) + ")";
+}
+
+VerifyState::VerifyState(int x, int y, int dx, int dy, int instructionX, int instructionY, VerifyStateKind kind) :
+	x(x), y(y), dx(dx), dy(dy), instructionX(instructionX), instructionY(instructionY), kind(kind) {}
+
+Verifier568::Verifier568(const unsigned int * image, unsigned int width, unsigned int height) :
+	image(image),
+	width(int(width)),
+	height(int(height)),
+	visited(static_cast<unsigned long long>(width) * height * 4 * 3),
+	worklist(),
+	errors(),
+	x(-1), y(0),
+	dx(1), dy(0),
+	instructionX(-1), instructionY(0) {}
+
+auto Verifier568::outOfBounds() -> bool {
+	return x < 0 || y < 0 || x >= width || y >= height;
+}
+
+/**
+ * moves the cursor onto the next colored pixel like the engine does
+ *
+ * @return false if it went out of bounds first
+ */
+auto Verifier568::next(unsigned int & rgb) -> bool {
+	while (true) {
+		x += dx;
+		y += dy;
+
+		if (outOfBounds()) return false;
+
+		auto current = image[y * width + x];
+
+		if (current == Engine568::RED || current == Engine568::YELLOW || current == Engine568::GREEN || current == Engine568::CYAN || current == Engine568::BLUE || current == Engine568::MAGENTA) {
+			rgb = current;
+			return true;
+		}
+	}
+}
+
+auto Verifier568::fail(std::string && message) -> bool {
+	if (errors.size() < MAX_ERRORS) errors.emplace_back(x, y, dx, dy, instructionX, instructionY, std::move(message));
+	return false;
+}
+
+/**
+ * queues up the cursor to be checked, unless it has been already
+ */
+auto Verifier568::push(VerifyStateKind kind) -> void {
+	auto direction = dx > 0 ? 0 : dx < 0 ? 1 : dy < 0 ? 2 : 3;
+	auto index = ((static_cast<unsigned long long>(y) * width + x) * 4 + direction) * 3 + static_cast<unsigned int>(kind);
+
+	if (visited[index]) return;
+	visited[index] = true;
+
+	worklist.emplace_back(x, y, dx, dy, instructionX, instructionY, kind);
+}
+
+/**
+ * the instruction under the cursor has finished, so move on to the next one
+ * running out of bounds here is how programs end
+ */
+auto Verifier568::continueAfter() -> void {
+	auto rgb = 0u;
+	if (next(rgb)) push(VerifyStateKind::INSTRUCTION);
+}
+
+auto Verifier568::checkDirection(const char * context) -> bool {
+	auto rgb = 0u;
+	if (!next(rgb)) return fail(std::string("Out of bounds while parsing ") + context);
+
+	return turn(rgb, context);
+}
+
+/**
+ * points the cursor in the direction a color stands for
+ */
+auto Verifier568::turn(unsigned int rgb, const char * context) -> bool {
+	switch (rgb) {
+		case Engine568::RED: dx = 1; dy = 0; return true;
+		case Engine568::YELLOW: dx = 0; dy = -1; return true;
+		case Engine568::GREEN: dx = -1; dy = 0; return true;
+		case Engine568::CYAN: dx = 0; dy = 1; return true;
+		default: return fail(std::string("Invalid direction ") + colorName(rgb) + " while parsing " + context);
+	}
+}
+
+auto Verifier568::checkValue(const char * context) -> bool {
+	auto literal = false;
+	auto rgb = 0u;
+
+	while (true) {
+		if (!next(rgb)) return fail(std::string("Unterminated value while parsing ") + context);
+
+		switch (rgb) {
+			case Engine568::RED:
+			case Engine568::YELLOW: {
+				if (literal) return fail(std::string("Register selector after literal signifier while parsing ") + context);
+				if (!next(rgb)) return fail(std::string("Missing register selector while parsing ") + context);
+
+				return true;
+			}
+			case Engine568::GREEN:
+			case Engine568::CYAN: {
+				literal = true;
+				break;
+			}
+			case Engine568::BLUE: {
+				return true;
+			}
+			case Engine568::MAGENTA: {
+				if (literal) return fail(std::string("Unexpected zero end for nonzero value while parsing ") + context);
+
+				return true;
+			}
+		}
+	}
+}
+
+auto Verifier568::checkInstruction(unsigned int rgb) -> void {
+	instructionX = x;
+	instructionY = y;
+
+	switch (rgb) {
+		case Engine568::RED: {
+			if (checkDirection("direction")) continueAfter();
+			break;
+		}
+		case Engine568::YELLOW: {
+			auto kind = 0u;
+			if (!next(kind)) {
+				fail("Out of bounds while parsing branch");
+				break;
+			}
+
+			if (kind == Engine568::BLUE) {
+				push(VerifyStateKind::SWITCH);
+				break;
+			}
+
+			/* both sides carry on from the direction pixel */
+			auto fromX = x, fromY = y, fromDX = dx, fromDY = dy;
+
+			if (!turn(kind, "branch")) break;
+			continueAfter();
+
+			x = fromX;
+			y = fromY;
+			dx = fromDX;
+			dy = fromDY;
+			continueAfter();
+			break;
+		}
+		case Engine568::GREEN: {
+			if (checkValue("value")) continueAfter();
+			break;
+		}
+		case Engine568::CYAN: {
+			auto registerColor = 0u;
+			if (!next(registerColor)) {
+				fail("Missing register selector while parsing array allocation");
+				break;
+			}
+
+			if (checkValue("array size")) push(VerifyStateKind::HEAP);
+			break;
+		}
+		case Engine568::BLUE: {
+			auto op = 0u;
+			if (!next(op)) fail("Out of bounds while parsing operator");
+			else continueAfter();
+			break;
+		}
+		case Engine568::MAGENTA: {
+			auto op = 0u;
+			if (!next(op)) {
+				fail("Out of bounds while parsing operator");
+				break;
+			}
+
+			if (op == Engine568::MAGENTA && !next(op)) {
+				fail("Out of bounds while parsing compound assignment operator");
+				break;
+			}
+
+			continueAfter();
+			break;
+		}
+	}
+}
+
+/**
+ * the inside of a switch, from the cursor up to wherever it exits
+ */
+auto Verifier568::checkSwitch() -> void {
+	auto rgb = 0u;
+
+	while (true) {
+		if (!next(rgb)) {
+			fail("Out of bounds while parsing switch");
+			return;
+		}
+
+		switch (rgb) {
+			case Engine568::RED: {
+				/* turning inside a switch can loop back onto itself */
+				if (checkDirection("switch")) push(VerifyStateKind::SWITCH);
+				return;
+			}
+			case Engine568::GREEN: {
+				if (!checkValue("switch case")) return;
+
+				auto direction = 0u;
+				if (!next(direction)) {
+					fail("Out of bounds while parsing switch case direction");
+					return;
+				}
+
+				auto caseX = x, caseY = y, caseDX = dx, caseDY = dy;
+
+				/* case matches, leave the switch in the case direction */
+				if (!turn(direction, "switch case direction")) return;
+				continueAfter();
+
+				/* case does not match, keep parsing the switch from the case direction pixel */
+				x = caseX;
+				y = caseY;
+				dx = caseDX;
+				dy = caseDY;
+				break;
+			}
+			case Engine568::CYAN: {
+				if (checkDirection("switch default case")) continueAfter();
+				return;
+			}
+			case Engine568::BLUE: {
+				continueAfter();
+				return;
+			}
+			default: {
+				fail(std::string("Unexpected ") + colorName(rgb) + " while parsing switch");
+				return;
+			}
+		}
+	}
+}
+
+/**
+ * the element initializers of an array allocation
+ */
+auto Verifier568::checkHeap() -> void {
+	auto rgb = 0u;
+
+	while (true) {
+		if (!next(rgb)) {
+			fail("Out of bounds while initializing array elements");
+			return;
+		}
+
+		switch (rgb) {
+			case Engine568::RED: {
+				if (checkDirection("array elements")) push(VerifyStateKind::HEAP);
+				return;
+			}
+			case Engine568::GREEN: {
+				if (!checkValue("array initializer value")) return;
+				break;
+			}
+			case Engine568::CYAN: {
+				continueAfter();
+				return;
+			}
+			default: {
+				fail(std::string("Unexpected ") + colorName(rgb) + " while allocating array elements");
+				return;
+			}
+		}
+	}
+}
+
+/**
+ * @return true if every reachable instruction parses
+ */
+auto Verifier568::verify() -> bool {
+	/* execution starts just off the left edge of the top row moving right */
+	continueAfter();
+
+	while (!worklist.empty()) {
+		auto state = worklist.back();
+		worklist.pop_back();
+
+		x = state.x;
+		y = state.y;
+		dx = state.dx;
+		dy = state.dy;
+		instructionX = state.instructionX;
+		instructionY = state.instructionY;
+
+		switch (state.kind) {
+			case VerifyStateKind::INSTRUCTION: checkInstruction(image[y * width + x]); break;
+			case VerifyStateKind::SWITCH: checkSwitch(); break;
+			case VerifyStateKind::HEAP: checkHeap(); break;
+		}
+	}
+
+	return errors.empty();
+}
+
+auto Verifier568::getErrors() -> std::vector<VerifyError> & {
+	return errors;
+}
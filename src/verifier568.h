@@ -0,0 +1,83 @@
+
+#ifndef LANGUAGE568_VERIFIER568_H
+#define LANGUAGE568_VERIFIER568_H
+
+#include <vector>
+#include <string>
+
+class VerifyError {
+public:
+	VerifyError(int, int, int, int, int, int, std::string &&);
+
+	/* pixel the problem was found at and the direction of travel there */
+	int x, y;
+	int dx, dy;
+
+	/* the instruction being parsed */
+	int instructionX, instructionY;
+
+	std::string message;
+
+	auto toString() const -> std::string;
+};
+
+enum class VerifyStateKind : unsigned char {
+	INSTRUCTION = 0,
+	SWITCH = 1,
+	HEAP = 2,
+};
+
+class VerifyState {
+public:
+	VerifyState(int, int, int, int, int, int, VerifyStateKind);
+
+	int x, y;
+	int dx, dy;
+	int instructionX, instructionY;
+	VerifyStateKind kind;
+};
+
+/**
+ * walks every control path reachable from the top left corner
+ * taking both sides of every branch and switch case, and checks
+ * that every instruction along the way parses
+ *
+ * what it cannot see, like array contents, is still checked at run time
+ */
+class Verifier568 {
+private:
+	constexpr static unsigned int MAX_ERRORS = 64;
+
+	const unsigned int * image;
+	int width, height;
+
+	std::vector<bool> visited;
+	std::vector<VerifyState> worklist;
+	std::vector<VerifyError> errors;
+
+	/* cursor inside the instruction being checked */
+	int x, y;
+	int dx, dy;
+	int instructionX, instructionY;
+
+	auto outOfBounds() -> bool;
+	auto next(unsigned int &) -> bool;
+	auto fail(std::string &&) -> bool;
+	auto push(VerifyStateKind) -> void;
+	auto continueAfter() -> void;
+
+	auto checkDirection(const char *) -> bool;
+	auto turn(unsigned int, const char *) -> bool;
+	auto checkValue(const char *) -> bool;
+	auto checkInstruction(unsigned int) -> void;
+	auto checkSwitch() -> void;
+	auto checkHeap() -> void;
+
+public:
+	Verifier568(const unsigned int *, unsigned int, unsigned int);
+
+	auto verify() -> bool;
+	auto getErrors() -> std::vector<VerifyError> &;
+};
+
+#endif //LANGUAGE568_VERIFIER568_H
@@ -0,0 +1,22 @@
+
+#include <iostream>
+
+#include "helloWorld.h"
+#include "slabcod.h"
+
+/*
+ * the sample programs run by the compiler, the binary only prints what it already knows
+ */
+
+constexpr auto hello = evaluate568(helloWorld, { 5 });
+constexpr auto slab = evaluate568(slabcod, { 5 });
+
+int main() {
+	std::cout << hello.getOutput() << std::endl;
+	std::cout << hello.getSteps() << " instructions, exited at " << hello.getX() << ", " << hello.getY() << std::endl;
+
+	std::cout << slab.getOutput() << std::endl;
+	std::cout << slab.getSteps() << " instructions, exited at " << slab.getX() << ", " << slab.getY() << std::endl;
+
+	return 0;
+}
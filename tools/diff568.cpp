@@ -0,0 +1,154 @@
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "engine568.h"
+#include "compiled568.h"
+#include "programs.h"
+
+/*
+ * differential test of transpile568
+ *
+ * the build transpiles the random programs Random1 through Random<DIFF_PROGRAMS> into this binary,
+ * and each again as Profiled<seed>, fused and laid out by a profile recorded when it was built,
+ * each one is regenerated from its seed here and run in the interpreter and compiled
+ * on the same inputs, then output, registers, arrays, errors and exit positions are compared
+ */
+
+#ifndef DIFF_PROGRAMS
+#define DIFF_PROGRAMS 32
+#endif
+
+constexpr static unsigned int RUNS_PER_PROGRAM = 16;
+
+class Inputs {
+public:
+	std::vector<int> integers;
+	std::vector<std::vector<int>> arrays;
+
+	/* which of the pushed values are arrays, in push order */
+	std::vector<bool> order;
+};
+
+static auto makeInputs(std::mt19937 & random) -> Inputs {
+	auto inputs = Inputs();
+	auto count = random() % 5;
+
+	for (auto i = 0u; i < count; ++i) {
+		if (random() % 4 == 0) {
+			auto & array = inputs.arrays.emplace_back(random() % 4);
+			for (auto & element : array) element = int(random() % 9) - 4;
+
+			inputs.order.push_back(true);
+
+		} else {
+			inputs.integers.push_back(int(random() % 9) - 4);
+			inputs.order.push_back(false);
+		}
+	}
+
+	return inputs;
+}
+
+template <typename Runner>
+static auto push(Runner & runner, Inputs & inputs) -> void {
+	auto integer = 0u, array = 0u;
+
+	for (auto isArray : inputs.order) {
+		if (isArray) {
+			auto & values = inputs.arrays[array++];
+			runner.pushArray(values.size(), values.data());
+
+		} else {
+			runner.pushInt(inputs.integers[integer++]);
+		}
+	}
+}
+
+/**
+ * runs with standard out captured
+ */
+template <typename Runner>
+static auto capture(Runner & runner) -> std::string {
+	auto output = std::ostringstream();
+	auto * original = std::cout.rdbuf(output.rdbuf());
+
+	runner.run();
+
+	std::cout.rdbuf(original);
+	return output.str();
+}
+
+template <typename Runner>
+static auto describe(Runner & runner, std::string & output) -> std::string {
+	auto description = std::ostringstream();
+
+	description << "  output: \"" << output << "\"\n";
+	description << "  exited at " << runner.getX() << ", " << runner.getY() << "\n";
+	description << "  error: " << runner.getError() << "\n";
+
+	for (auto i = 0u; i < 6; ++i) {
+		auto * array = runner.getRegister(i).array;
+
+		description << "  register " << i << ": " << runner.getInt(i);
+		if (array != nullptr) description << " -> array " << array - &runner.getArray(0);
+		description << " [";
+		for (auto element : runner.getArray(i)) description << ' ' << element;
+		description << " ]\n";
+	}
+
+	return description.str();
+}
+
+int main() {
+	auto programs = 0u, runs = 0u, failures = 0u;
+
+	for (auto index = 0u; index < 2 * DIFF_PROGRAMS; ++index) {
+		auto seed = index % DIFF_PROGRAMS + 1;
+		auto name = (index < DIFF_PROGRAMS ? "Random" : "Profiled") + std::to_string(seed);
+		auto factory = Compiled568::find(name);
+
+		if (factory == nullptr) {
+			std::cout << name << " was not compiled in" << std::endl;
+			++failures;
+			continue;
+		}
+
+		auto canvas = Programs::random(seed);
+		auto compiled = factory();
+		auto engine = Engine568();
+
+		auto random = std::mt19937(seed);
+
+		for (auto run = 0u; run < RUNS_PER_PROGRAM; ++run) {
+			auto inputs = makeInputs(random);
+
+			engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+			push(engine, inputs);
+			auto engineOutput = capture(engine);
+
+			compiled->reset();
+			push(*compiled, inputs);
+			auto compiledOutput = capture(*compiled);
+
+			auto expected = describe(engine, engineOutput);
+			auto actual = describe(*compiled, compiledOutput);
+
+			if (expected != actual) {
+				std::cout << name << " run " << run << " diverged\ninterpreter:\n" << expected << "compiled:\n" << actual;
+				++failures;
+			}
+
+			++runs;
+		}
+
+		++programs;
+	}
+
+	std::cout << programs << " programs, " << runs << " runs, " << failures << " mismatches" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "image/image.h"
+#include "engine568.h"
+#include "constexpr568.h"
+
+/*
+ * writes a program image as a header of codels for ConstEngine568,
+ * one byte per codel after collapsing any upscaling
+ */
+
+static auto codelOf(unsigned int color) -> Codel568 {
+	switch (color) {
+		case Engine568::RED: return Codel568::RED;
+		case Engine568::YELLOW: return Codel568::YELLOW;
+		case Engine568::GREEN: return Codel568::GREEN;
+		case Engine568::CYAN: return Codel568::CYAN;
+		case Engine568::BLUE: return Codel568::BLUE;
+		case Engine568::MAGENTA: return Codel568::MAGENTA;
+		default: return Codel568::NONE;
+	}
+}
+
+int main(int argc, char ** argv) {
+	if (argc != 4) {
+		std::cout << "usage: embed568 <program.png> <output.h> <name>" << std::endl;
+		return 2;
+	}
+
+	auto image = CNGE::Image::fromPNG(argv[1]);
+
+	if (image == nullptr || !image->isValid()) {
+		std::cout << "invalid filename" << std::endl;
+		return 2;
+	}
+
+	auto engine = Engine568();
+	engine.load(image->getWidth(), image->getHeight(), image->getPixels());
+
+	auto & stats = engine.getLoadStats();
+	auto & pixels = engine.getImage();
+
+	auto name = std::string(argv[3]);
+	auto guard = std::string("LANGUAGE568_EMBEDDED_") + name + "_H";
+	for (auto & c : guard) c = char(std::toupper(c));
+
+	auto out = std::ofstream(argv[2]);
+
+	if (!out) {
+		std::cout << "could not write " << argv[2] << std::endl;
+		return 2;
+	}
+
+	out << "\n/* generated by embed568 from " << argv[1] << " */\n\n";
+	out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+	out << "#include \"constexpr568.h\"\n\n";
+	out << "constexpr unsigned char " << name << "Codels [] = {\n";
+
+	for (auto j = 0u; j < stats.height; ++j) {
+		out << '\t';
+		for (auto i = 0u; i < stats.width; ++i) out << static_cast<int>(codelOf(pixels[j * stats.width + i])) << ',';
+		out << '\n';
+	}
+
+	out << "};\n\n";
+	out << "constexpr auto " << name << " = EmbeddedProgram568 { " << stats.width << ", " << stats.height << ", " << name << "Codels };\n\n";
+	out << "#endif //" << guard << "\n";
+
+	return 0;
+}
@@ -0,0 +1,182 @@
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * load generator for language568 --serve
+ *
+ * load568 <socket> <program.png> [requests] [connections] [inputs ...]
+ *
+ * the first request names the program by path, every request after that by the hash it came back with,
+ * each connection sends its share of requests one after another
+ */
+
+/**
+ * one connection to the server, reading whole responses back
+ */
+class Connection {
+private:
+	int fd;
+	std::string buffer;
+
+	auto fill() -> bool {
+		char chunk [4096];
+
+		auto received = recv(fd, chunk, sizeof(chunk), 0);
+		if (received <= 0) return false;
+
+		buffer.append(chunk, received);
+		return true;
+	}
+
+	auto readLine(std::string & line) -> bool {
+		auto newline = std::string::npos;
+
+		while ((newline = buffer.find('\n')) == std::string::npos) if (!fill()) return false;
+
+		line = buffer.substr(0, newline);
+		buffer.erase(0, newline + 1);
+
+		return true;
+	}
+
+public:
+	explicit Connection(const char * path) : fd(socket(AF_UNIX, SOCK_STREAM, 0)), buffer() {
+		auto address = sockaddr_un();
+		address.sun_family = AF_UNIX;
+		std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+		if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	~Connection() {
+		if (fd >= 0) close(fd);
+	}
+
+	auto isOpen() -> bool {
+		return fd >= 0;
+	}
+
+	/**
+	 * sends a request and reads its response
+	 *
+	 * @return the first line of the response, empty if the connection broke
+	 */
+	auto request(const std::string & line) -> std::string {
+		auto message = line + "\n";
+
+		if (send(fd, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size())) return "";
+
+		auto first = std::string();
+		if (!readLine(first)) return "";
+		if (first.rfind("ok ", 0) != 0) return first;
+
+		/* everything up to the output block, then the output */
+		for (auto next = std::string(); readLine(next);) {
+			if (next.rfind("output ", 0) != 0) continue;
+
+			auto length = std::strtoull(next.c_str() + 7, nullptr, 10);
+
+			while (buffer.size() < length) if (!fill()) return "";
+			buffer.erase(0, length);
+
+			return first;
+		}
+
+		return "";
+	}
+};
+
+int main(int argc, char ** argv) {
+	if (argc < 3) {
+		std::cout << "usage: load568 <socket> <program.png> [requests] [connections] [inputs ...]" << std::endl;
+		return 2;
+	}
+
+	auto * socketPath = argv[1];
+	auto requests = argc > 3 ? std::stoi(argv[3]) : 10000;
+	auto numConnections = argc > 4 ? std::stoi(argv[4]) : int(std::max(1u, std::thread::hardware_concurrency()));
+
+	auto inputs = std::string();
+	for (auto i = 5; i < argc; ++i) inputs += std::string(" ") + argv[i];
+
+	/* warms the cache and learns the program's hash */
+	auto first = Connection(socketPath);
+
+	if (!first.isOpen()) {
+		std::cout << "could not connect to " << socketPath << std::endl;
+		return 1;
+	}
+
+	auto response = first.request(std::string("run ") + argv[2] + inputs);
+
+	if (response.rfind("ok ", 0) != 0) {
+		std::cout << "first request failed: " << response << std::endl;
+		return 1;
+	}
+
+	auto request = "run #" + response.substr(3) + inputs;
+
+	auto latencies = std::vector<std::vector<std::chrono::nanoseconds>>(numConnections);
+	auto failures = std::vector<int>(numConnections);
+	auto threads = std::vector<std::thread>();
+
+	auto begin = std::chrono::steady_clock::now();
+
+	for (auto c = 0; c < numConnections; ++c) threads.emplace_back([&, c]() {
+		auto connection = Connection(socketPath);
+		auto share = requests / numConnections + (c < requests % numConnections ? 1 : 0);
+
+		for (auto i = 0; i < share; ++i) {
+			auto sent = std::chrono::steady_clock::now();
+			auto result = connection.request(request);
+			auto received = std::chrono::steady_clock::now();
+
+			if (result.rfind("ok ", 0) != 0) ++failures[c];
+			else latencies[c].push_back(received - sent);
+		}
+	});
+
+	for (auto & thread : threads) thread.join();
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	auto all = std::vector<std::chrono::nanoseconds>();
+	for (auto & connectionLatencies : latencies) all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+
+	auto failed = 0;
+	for (auto count : failures) failed += count;
+
+	if (all.empty()) {
+		std::cout << "every request failed" << std::endl;
+		return 1;
+	}
+
+	std::sort(all.begin(), all.end());
+
+	auto percentile = [&](double fraction) {
+		auto index = std::min(all.size() - 1, static_cast<std::size_t>(fraction * double(all.size())));
+		return all[index].count() / 1000.0;
+	};
+
+	std::cout << all.size() << " requests over " << numConnections << " connections, " << failed << " failed" << std::endl;
+	std::cout << double(all.size()) / elapsed << " requests/s, p50 " << percentile(0.5) << " us, p99 "
+		<< percentile(0.99) << " us, max " << all.back().count() / 1000.0 << " us" << std::endl;
+
+	std::cout << first.request("stats") << std::endl;
+
+	return failed == 0 ? 0 : 1;
+}
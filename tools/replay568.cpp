@@ -0,0 +1,147 @@
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "image/image.h"
+#include "engine568Run.h"
+#include "trace568.h"
+
+static const char * registerNames [6] = { "red", "yellow", "green", "cyan", "blue", "magenta" };
+
+static auto directionName(int dx, int dy) -> const char * {
+	if (dx < 0) return "left";
+	else if (dx > 0) return "right";
+	else if (dy < 0) return "up";
+	else return "down";
+}
+
+static auto sameEvent(TraceEvent & a, TraceEvent & b) -> bool {
+	return a.kind == b.kind && a.step == b.step && a.value == b.value && a.size == b.size && a.x == b.x && a.y == b.y;
+}
+
+/**
+ * records the rerun like the original was recorded,
+ * and prints every colored pixel the engine reads along the way
+ */
+class ReplayObserver : public TraceObserver568 {
+private:
+	std::ostream & out;
+
+public:
+	ReplayObserver(TraceRecorder & recorder, std::ostream & out) : TraceObserver568(recorder), out(out) {}
+
+	auto onFetch(Engine568 & engine, unsigned int) -> void {
+		out << "  " << engine.getX() << " " << engine.getY() << std::endl;
+	}
+};
+
+/**
+ * replays a trace recorded by language568 --trace against the program it was recorded from
+ *
+ * the replay is a rerun plus a check, not a reconstruction:
+ * the program is run again from the inputs stored in the trace and decides every branch, switch
+ * and allocation for itself, the recorded decisions are only compared against the rerun's once it ends,
+ * so the path printed is the rerun's and a trace of a different program or build is reported, not followed
+ *
+ * prints the position of every instruction the engine executed along with the register file before it
+ * and the pixels read while executing it,
+ * then checks that the rerun made the same decisions as the recording
+ */
+int main(int argc, char ** argv) {
+	if (argc != 3) {
+		std::cout << "usage: replay568 <program.png> <trace>" << std::endl;
+		return 2;
+	}
+
+	auto image = CNGE::Image::fromPNG(argv[1]);
+
+	if (image == nullptr || !image->isValid()) {
+		std::cout << "invalid filename" << std::endl;
+		return 2;
+	}
+
+	auto traceFile = std::ifstream(argv[2], std::ios::binary);
+	auto reader = TraceReader(traceFile);
+
+	if (!reader.isValid()) {
+		std::cout << "invalid trace" << std::endl;
+		return 2;
+	}
+
+	auto engine = Engine568();
+	engine.load(image->getWidth(), image->getHeight(), image->getPixels());
+
+	for (auto & input : reader.getInputs()) {
+		if (input.isArray) engine.pushArray(input.array.size(), input.array.data());
+		else engine.pushInt(input.integer);
+	}
+
+	auto rerecorded = std::stringstream();
+	auto recorder = TraceRecorder(rerecorded);
+
+	/* the program's own output goes to stdout alongside the path, so keep it apart */
+	auto * programOutput = std::cout.rdbuf();
+	auto captured = std::stringstream();
+	auto path = std::ostream(programOutput);
+
+	auto observer = ReplayObserver(recorder, path);
+
+	engine.start(observer);
+
+	while (true) {
+		auto x = engine.getX(), y = engine.getY();
+
+		std::cout.rdbuf(programOutput);
+
+		std::cout << engine.getSteps() << " " << x << " " << y << " " << directionName(engine.getDX(), engine.getDY()) << " |";
+
+		for (auto i = 0u; i < 6; ++i) {
+			std::cout << " " << registerNames[i] << ": ";
+
+			auto & array = engine.getArray(i);
+			if (!array.empty()) std::cout << "[" << array.size() << "] ";
+
+			std::cout << engine.getInt(i);
+		}
+
+		std::cout << std::endl;
+
+		std::cout.rdbuf(captured.rdbuf());
+		if (!engine.step(observer)) break;
+	}
+
+	std::cout.rdbuf(programOutput);
+
+	recorder.flush();
+
+	std::cout << "output: " << captured.str() << std::endl;
+
+	auto err = engine.getError();
+	if (!err.empty()) std::cout << err << std::endl;
+
+	/* the rerun has to make exactly the decisions that were recorded */
+	traceFile.clear();
+	traceFile.seekg(0);
+
+	auto original = TraceReader(traceFile);
+	auto replayed = TraceReader(rerecorded);
+
+	auto expected = TraceEvent(), actual = TraceEvent();
+
+	while (true) {
+		auto hasExpected = original.next(expected);
+		auto hasActual = replayed.next(actual);
+
+		if (!hasExpected && !hasActual) break;
+
+		if (hasExpected != hasActual || !sameEvent(expected, actual)) {
+			std::cout << "rerun diverged from the trace at instruction " << (hasExpected ? expected.step : actual.step) << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "trace matched " << engine.getSteps() << " instructions" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,823 @@
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <random>
+
+#include "image/image.h"
+#include "engine568.h"
+#include "programProfile568.h"
+#include "programs.h"
+
+/*
+ * compiles a verified program image into a C++ class deriving Compiled568
+ *
+ * every instruction the program can reach becomes a labeled block of straight line code,
+ * control flow between them is goto, the six registers are locals
+ * and arrays stay std::vectors so pointers into them behave like the engine's
+ *
+ * runtime errors are checked at the same points and with the same text as the engine,
+ * structural errors cannot happen since only verified programs are accepted
+ *
+ * given a profile of the program, recorded by language568 --record-profile
+ * or for a random program by transpile568 --record-profile itself,
+ * instructions the profile found hot are fused into the block before them instead of jumped to,
+ * so a value following an operator applies it directly instead of switching on it,
+ * branches are marked likely or unlikely the way they went, and hot blocks are laid out
+ * one after another along the way execution went, with blocks that never ran at the end
+ */
+
+enum class StateKind : int {
+	INSTRUCTION = 0,
+	SWITCH = 1,
+	HEAP = 2,
+};
+
+/* kind, x, y, dx, dy, and the register being allocated for heap states */
+using StateKey = std::array<int, 6>;
+
+class Operand {
+public:
+	enum Kind {
+		LITERAL,
+		REGISTER,
+		DEREFERENCE,
+	};
+
+	Kind kind;
+	int value;
+	int index;
+};
+
+class Transpiler {
+private:
+	/* instructions fused into one block at most, counting turns */
+	constexpr static unsigned int MAX_FUSED = 8;
+	/* a branch going one way at least this many times in ten is marked likely that way */
+	constexpr static unsigned long long BIAS_TENTHS = 9;
+	/* stands in for a block label while emitting the jump into the first block */
+	constexpr static unsigned int ENTRY = ~0u;
+
+	static const char * colorNames [6];
+
+	const ProgramProfile568 * profile;
+
+	const unsigned int * image;
+	int width, height;
+
+	int x, y;
+	int dx, dy;
+
+	std::map<StateKey, unsigned int> labels;
+	std::vector<StateKey> worklist;
+
+	std::ostringstream code;
+
+	/* the code of each block, and the blocks each jumps to with how often the profile went there */
+	std::map<unsigned int, std::string> blocks;
+	std::map<unsigned int, std::vector<std::pair<unsigned int, unsigned long long>>> successors;
+	unsigned int currentLabel;
+
+	/* instructions fused into the block so far, and the operator known to be waiting, empty if unknown */
+	unsigned int fused;
+	std::string knownOp;
+
+	auto outOfBounds() -> bool {
+		return x < 0 || y < 0 || x >= width || y >= height;
+	}
+
+	static auto colorIndex(unsigned int color) -> int {
+		switch (color) {
+			case Engine568::RED: return 0;
+			case Engine568::YELLOW: return 1;
+			case Engine568::GREEN: return 2;
+			case Engine568::CYAN: return 3;
+			case Engine568::BLUE: return 4;
+			case Engine568::MAGENTA: return 5;
+			default: return -1;
+		}
+	}
+
+	/**
+	 * moves onto the next colored pixel like the engine does
+	 *
+	 * @return the color there, or 0 out of bounds
+	 */
+	auto next() -> unsigned int {
+		while (true) {
+			x += dx;
+			y += dy;
+
+			if (outOfBounds()) return 0;
+
+			auto current = image[y * width + x];
+			if (colorIndex(current) != -1) return current;
+		}
+	}
+
+	auto turn(unsigned int rgb) -> void {
+		switch (rgb) {
+			case Engine568::RED: dx = 1; dy = 0; break;
+			case Engine568::YELLOW: dx = 0; dy = -1; break;
+			case Engine568::GREEN: dx = -1; dy = 0; break;
+			case Engine568::CYAN: dx = 0; dy = 1; break;
+		}
+	}
+
+	/* the arguments of fail and end for the cursor */
+	auto position() -> std::string {
+		return std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(dx) + ", " + std::to_string(dy);
+	}
+
+	auto fail(const std::string & message) -> std::string {
+		auto color = std::string("\"") + colorNames[colorIndex(image[y * width + x])] + "\"";
+		return "fail(" + position() + ", " + color + ", " + message + ");";
+	}
+
+	static auto quote(const std::string & text) -> std::string {
+		return "std::string(\"" + text + "\")";
+	}
+
+	/**
+	 * @return a statement that jumps to the block for the cursor, queueing it if it is new
+	 */
+	auto jump(StateKind kind, int registerIndex = 0) -> std::string {
+		auto key = StateKey { static_cast<int>(kind), x, y, dx, dy, registerIndex };
+		auto found = labels.find(key);
+
+		if (found == labels.end()) {
+			found = labels.emplace(key, labels.size()).first;
+			worklist.push_back(key);
+		}
+
+		successors[currentLabel].emplace_back(found->second, kind == StateKind::INSTRUCTION ? countAt(x, y, dx, dy) : 0);
+
+		return "goto L" + std::to_string(found->second) + ";";
+	}
+
+	/**
+	 * @return how many times the profile ran the instruction entered at a position in a direction, 0 without one
+	 */
+	auto countAt(int atX, int atY, int atDX, int atDY) -> unsigned long long {
+		auto * counts = profile == nullptr ? nullptr : profile->find(atX, atY, atDX, atDY);
+
+		return counts == nullptr ? 0 : counts->count;
+	}
+
+	/**
+	 * @return a statement that moves on to the next instruction, or ends the program out of bounds
+	 */
+	auto continueAfter() -> std::string {
+		if (next() == 0) return "{ end(" + position() + "); goto finish; }";
+
+		return jump(StateKind::INSTRUCTION);
+	}
+
+	/**
+	 * moves on to the next instruction, emitting it in place if the profile found it hot,
+	 * with the operator waiting on it known if the instruction before set one
+	 */
+	auto emitContinue() -> void {
+		if (next() == 0) {
+			code << "\t{ end(" << position() << "); goto finish; }\n";
+			return;
+		}
+
+		if (profile != nullptr && fused < MAX_FUSED && profile->isHot(x, y, dx, dy)) {
+			++fused;
+
+			code << "\t/* fused " << x << ", " << y << " */\n";
+			emitInstruction();
+			return;
+		}
+
+		code << "\t" << jump(StateKind::INSTRUCTION) << "\n";
+	}
+
+	auto parseOperand() -> Operand {
+		auto value = 1;
+
+		while (true) {
+			switch (next()) {
+				case Engine568::RED: return Operand { Operand::REGISTER, 0, colorIndex(next()) };
+				case Engine568::YELLOW: return Operand { Operand::DEREFERENCE, 0, colorIndex(next()) };
+				case Engine568::GREEN: value = (value << 1) + 1; break;
+				case Engine568::CYAN: value <<= 1; break;
+				case Engine568::BLUE: return Operand { Operand::LITERAL, value, 0 };
+				default: return Operand { Operand::LITERAL, 0, 0 };
+			}
+		}
+	}
+
+	/**
+	 * emits code putting an operand in val, ref and reg
+	 *
+	 * @param prefix expression prepended to error messages, or empty
+	 * @param onError statements run after failing
+	 */
+	auto load(Operand & operand, const std::string & prefix, const std::string & onError, const std::string & indent) -> void {
+		auto i = std::to_string(operand.index);
+
+		switch (operand.kind) {
+			case Operand::LITERAL: {
+				code << indent << "val = " << operand.value << "; ref = nullptr; reg = -1;\n";
+				break;
+			}
+			case Operand::REGISTER: {
+				code << indent << "val = r[" << i << "]; ref = r + " << i << "; reg = " << i << ";\n";
+				break;
+			}
+			case Operand::DEREFERENCE: {
+				auto name = std::string(colorNames[operand.index]);
+				auto before = prefix.empty() ? std::string() : prefix + " + ";
+
+				code << indent << "if (a[" << i << "] == nullptr) { " << fail(before + quote("Register " + name + " does not point to an array")) << ' ' << onError << " }\n";
+				code << indent << "if (static_cast<std::size_t>(r[" << i << "]) >= a[" << i << "]->size()) { "
+					<< fail(before + quote("Trying to access array " + name + " out of bounds (") + " + std::to_string(r[" + i + "]) + \" out of \" + std::to_string(a[" + i + "]->size()) + \")\"")
+					<< ' ' << onError << " }\n";
+				code << indent << "val = (*a[" << i << "])[r[" << i << "]]; ref = a[" << i << "]->data() + r[" << i << "]; reg = -1;\n";
+				break;
+			}
+		}
+	}
+
+	/* a value instruction, applying whatever operator is waiting on it */
+	auto emitValue() -> void {
+		auto operand = parseOperand();
+		auto i = std::to_string(operand.index);
+
+		/* the engine still applies the operator to a value that failed to load, which can replace the error */
+		auto overrideError = "if (op == ASSIGN) " + fail(quote("Trying to assign to value"))
+			+ " else if (op >= COMPOUND_ADD) " + fail(quote("Trying to compound assign to value"))
+			+ " else if (op == DIVIDE || op == MODULO) " + fail(quote("Division by zero")) + " goto finish;";
+		load(operand, "", overrideError, "\t\t");
+
+		/*
+		 * an arithmetic operator checked and wrapped around the way DefaultChecks568 has the engine do it,
+		 * storing the result through target first for compound assignment,
+		 * which also gets the 0 the engine stores before failing on a zero divisor
+		 */
+		auto arithmetic = [this](const std::string & name, const std::string & target) -> std::string {
+			auto divisionByZero = "if (val == 0) { " + (target.empty() ? std::string() : target + "0; ") + fail(quote("Division by zero")) + " goto finish; } ";
+
+			if (name == "ADD") return "val = " + target + "wrap(static_cast<long long>(last) + val);";
+			if (name == "SUBTRACT") return "val = " + target + "wrap(static_cast<long long>(last) - val);";
+			if (name == "MULTIPLY") return "val = " + target + "wrap(static_cast<long long>(last) * val);";
+			if (name == "DIVIDE") return divisionByZero + "val = " + target + "(val == -1 ? wrap(-static_cast<long long>(last)) : last / val);";
+			return divisionByZero + "val = " + target + "(val == -1 ? 0 : last % val);";
+		};
+
+		/* each operator and what applying it is, the ones ending in goto finish do not fall out of the switch */
+		auto cases = std::vector<std::pair<std::string, std::string>> {
+			{ "NONE", "" },
+			{ "ADD", arithmetic("ADD", "") },
+			{ "SUBTRACT", arithmetic("SUBTRACT", "") },
+			{ "MULTIPLY", arithmetic("MULTIPLY", "") },
+			{ "DIVIDE", arithmetic("DIVIDE", "") },
+			{ "MODULO", arithmetic("MODULO", "") },
+			{ "EQUAL", "val = last == val;" },
+			{ "LESS", "val = last < val;" },
+			{ "GREATER", "val = last > val;" },
+		};
+
+		const char * compounds [5] = { "ADD", "SUBTRACT", "MULTIPLY", "DIVIDE", "MODULO" };
+
+		switch (operand.kind) {
+			case Operand::LITERAL: {
+				cases.emplace_back("ASSIGN", fail(quote("Trying to assign to value")) + " goto finish;");
+				cases.emplace_back("", fail(quote("Trying to compound assign to value")) + " goto finish;");
+				break;
+			}
+			case Operand::REGISTER: {
+				cases.emplace_back("ASSIGN", "if (lastReg >= 0) { r[" + i + "] = r[lastReg]; a[" + i + "] = a[lastReg]; } else r[" + i + "] = last;");
+				for (auto * compound : compounds) cases.emplace_back(std::string("COMPOUND_") + compound, arithmetic(compound, "r[" + i + "] = "));
+				break;
+			}
+			case Operand::DEREFERENCE: {
+				cases.emplace_back("ASSIGN", "*ref = last;");
+				for (auto * compound : compounds) cases.emplace_back(std::string("COMPOUND_") + compound, arithmetic(compound, "*ref = "));
+				break;
+			}
+		}
+
+		auto known = std::find_if(cases.begin(), cases.end(), [this](auto & entry) { return entry.first == knownOp; });
+		if (!knownOp.empty() && known == cases.end()) known = cases.end() - 1;
+
+		if (knownOp.empty()) {
+			code << "\t\tswitch (op) {\n";
+
+			for (auto & [name, apply] : cases) {
+				code << "\t\t\t" << (name.empty() ? "default" : "case " + name) << ": " << apply;
+
+				auto finishes = apply.size() >= 12 && apply.compare(apply.size() - 12, 12, "goto finish;") == 0;
+				if (!finishes) code << (apply.empty() ? "" : " ") << "break;";
+				code << "\n";
+			}
+
+			code << "\t\t}\n";
+
+		/* fused after the operator, so only its case is left */
+		} else if (!known->second.empty()) {
+			code << "\t\t" << known->second << "\n";
+		}
+
+		setOp("NONE");
+		code << "\t\tlast = val; lastRef = ref; lastReg = reg;\n";
+	}
+
+	/* an operator waiting on the next value, which it can be fused into */
+	auto setOp(const char * name) -> void {
+		code << "\t\top = " << name << ";\n";
+		knownOp = name;
+	}
+
+	auto emitOperator1() -> void {
+		switch (next()) {
+			case Engine568::RED: setOp("ADD"); break;
+			case Engine568::YELLOW: setOp("SUBTRACT"); break;
+			case Engine568::GREEN: setOp("MULTIPLY"); break;
+			case Engine568::CYAN: setOp("DIVIDE"); break;
+			case Engine568::BLUE: setOp("MODULO"); break;
+			case Engine568::MAGENTA: {
+				code << "\t\tif (lastRef != nullptr) *lastRef = !last;\n";
+				code << "\t\telse { " << fail(quote("Trying to negate value")) << " goto finish; }\n";
+				break;
+			}
+		}
+	}
+
+	auto emitOperator2() -> void {
+		switch (next()) {
+			case Engine568::RED: setOp("EQUAL"); break;
+			case Engine568::YELLOW: setOp("LESS"); break;
+			case Engine568::GREEN: setOp("GREATER"); break;
+			case Engine568::CYAN: code << "\t\tstd::cout << char(last);\n"; break;
+			case Engine568::BLUE: setOp("ASSIGN"); break;
+			case Engine568::MAGENTA: {
+				switch (next()) {
+					case Engine568::RED: setOp("COMPOUND_ADD"); break;
+					case Engine568::YELLOW: setOp("COMPOUND_SUBTRACT"); break;
+					case Engine568::GREEN: setOp("COMPOUND_MULTIPLY"); break;
+					case Engine568::CYAN: setOp("COMPOUND_DIVIDE"); break;
+					case Engine568::BLUE: setOp("COMPOUND_MODULO"); break;
+					case Engine568::MAGENTA: {
+						code << "\t\tif (lastRef != nullptr) *lastRef = !last;\n";
+						code << "\t\telse { " << fail(quote("Trying to compound assign to value")) << " goto finish; }\n";
+						break;
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	auto emitBranch() -> void {
+		auto * counts = profile == nullptr ? nullptr : profile->find(x, y, dx, dy);
+		auto kind = next();
+
+		if (kind == Engine568::BLUE) {
+			code << "\t" << jump(StateKind::SWITCH) << "\n";
+			return;
+		}
+
+		auto fromX = x, fromY = y, fromDX = dx, fromDY = dy;
+
+		turn(kind);
+		auto taken = continueAfter();
+
+		x = fromX;
+		y = fromY;
+		dx = fromDX;
+		dy = fromDY;
+		auto notTaken = continueAfter();
+
+		/* which way the branch went when profiled, if it went one way nearly always */
+		auto hint = "";
+
+		if (counts != nullptr && counts->taken + counts->notTaken > 0) {
+			auto total = counts->taken + counts->notTaken;
+
+			if (counts->taken * 10 >= total * BIAS_TENTHS) hint = "[[likely]] ";
+			else if (counts->notTaken * 10 >= total * BIAS_TENTHS) hint = "[[unlikely]] ";
+		}
+
+		code << "\tif (last != 0) " << hint << taken << "\n";
+		code << "\t" << notTaken << "\n";
+	}
+
+	auto emitHeap() -> void {
+		auto index = colorIndex(next());
+		auto i = std::to_string(index);
+		auto name = std::string(colorNames[index]);
+
+		auto size = parseOperand();
+		load(size, quote("While parsing array size for register " + name + ": "), "goto finish;", "\t\t");
+
+		code << "\t\tif (val < 0) { " << fail(quote("Trying to allocate array of negative size (") + " + std::to_string(val) + \") for register " + name + "\"") << " goto finish; }\n";
+		code << "\t\tsize = val;\n";
+		code << "\t\tarrays[" << i << "].assign(static_cast<std::size_t>(size), 0);\n";
+		code << "\t\tr[" << i << "] = 0; a[" << i << "] = arrays.data() + " << i << ";\n";
+		code << "\t\telement = 0;\n";
+		code << "\t}\n";
+		code << "\t" << jump(StateKind::HEAP, index) << "\n";
+	}
+
+	auto emitInstruction() -> void {
+		auto rgb = image[y * width + x];
+
+		/* turns and branches are nothing but control flow */
+		if (rgb == Engine568::RED) {
+			turn(next());
+			emitContinue();
+			return;
+
+		} else if (rgb == Engine568::YELLOW) {
+			emitBranch();
+			return;
+		}
+
+		code << "\t{\n";
+
+		switch (rgb) {
+			case Engine568::GREEN: emitValue(); break;
+			case Engine568::CYAN: emitHeap(); return;
+			case Engine568::BLUE: emitOperator1(); break;
+			case Engine568::MAGENTA: emitOperator2(); break;
+		}
+
+		code << "\t}\n";
+		emitContinue();
+	}
+
+	/**
+	 * the inside of a switch, cases compare against the last value without touching it
+	 */
+	auto emitSwitch() -> void {
+		while (true) {
+			switch (next()) {
+				case Engine568::RED: {
+					turn(next());
+					code << "\t" << jump(StateKind::SWITCH) << "\n";
+					return;
+				}
+				case Engine568::GREEN: {
+					auto value = parseOperand();
+
+					code << "\t{\n";
+					load(value, quote("while parsing switch case: "), "goto finish;", "\t\t");
+					code << "\t}\n";
+
+					auto direction = next();
+					auto caseX = x, caseY = y, caseDX = dx, caseDY = dy;
+
+					turn(direction);
+					code << "\tif (val == last) " << continueAfter() << "\n";
+
+					x = caseX;
+					y = caseY;
+					dx = caseDX;
+					dy = caseDY;
+					break;
+				}
+				case Engine568::CYAN: {
+					turn(next());
+					code << "\t" << continueAfter() << "\n";
+					return;
+				}
+				default: {
+					code << "\t" << continueAfter() << "\n";
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	 * the element initializers of an array allocation
+	 */
+	auto emitHeap(int index) -> void {
+		auto i = std::to_string(index);
+		auto name = std::string(colorNames[index]);
+
+		while (true) {
+			switch (next()) {
+				case Engine568::RED: {
+					turn(next());
+					code << "\t" << jump(StateKind::HEAP, index) << "\n";
+					return;
+				}
+				case Engine568::GREEN: {
+					code << "\tif (element == size) { " << fail(quote("Trying to initialize more array elements than array size (") + " + std::to_string(size) + \") for register " + name + "\"") << " goto finish; }\n";
+
+					auto value = parseOperand();
+
+					code << "\t{\n";
+					load(value, "\"While parsing array initializer value \" + std::to_string(element + 1) + \" for register " + name + ": \"", "goto finish;", "\t\t");
+					code << "\t\tarrays[" << i << "][element] = val;\n";
+					code << "\t\t++element;\n";
+					code << "\t}\n";
+					break;
+				}
+				default: {
+					code << "\t" << continueAfter() << "\n";
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	 * orders blocks so each is followed by the one execution went to most from it, as a chain from the entry,
+	 * then chains from the hottest blocks left, then the blocks that never ran in the order they were made
+	 */
+	auto layout(const std::vector<unsigned int> & made, std::map<unsigned int, unsigned long long> & heat) -> std::vector<unsigned int> {
+		auto order = std::vector<unsigned int>();
+		auto placed = std::set<unsigned int>();
+
+		auto chain = [&](unsigned int label) {
+			while (placed.insert(label).second) {
+				order.push_back(label);
+
+				auto hottest = ENTRY;
+				auto hottestCount = 0ull;
+
+				for (auto [to, count] : successors[label]) {
+					if (count > hottestCount && placed.count(to) == 0) hottest = to, hottestCount = count;
+				}
+
+				if (hottest == ENTRY) return;
+				label = hottest;
+			}
+		};
+
+		for (auto [to, count] : successors[ENTRY]) chain(to);
+
+		auto byHeat = made;
+		std::stable_sort(byHeat.begin(), byHeat.end(), [&heat](auto left, auto right) { return heat[left] > heat[right]; });
+
+		for (auto label : byHeat) if (heat[label] > 0) chain(label);
+
+		for (auto label : made) if (placed.insert(label).second) order.push_back(label);
+
+		return order;
+	}
+
+public:
+	/**
+	 * @param profile of runs of the program to fuse and lay out by, or null to do neither
+	 */
+	Transpiler(const unsigned int * image, unsigned int width, unsigned int height, const ProgramProfile568 * profile) :
+		profile(profile),
+		image(image),
+		width(int(width)),
+		height(int(height)),
+		x(-1), y(0),
+		dx(1), dy(0),
+		labels(),
+		worklist(),
+		code(),
+		blocks(),
+		successors(),
+		currentLabel(ENTRY),
+		fused(0),
+		knownOp() {}
+
+	/**
+	 * @param header file name the source includes for the class declaration
+	 */
+	auto transpile(const std::string & name, const std::string & source, const std::string & header, std::ostream & headerOut, std::ostream & sourceOut) -> void {
+		/* execution starts just off the left edge of the top row moving right */
+		auto entry = continueAfter();
+
+		/* blocks in the order they were made, and how often the profile ran each */
+		auto made = std::vector<unsigned int>();
+		auto heat = std::map<unsigned int, unsigned long long>();
+
+		while (!worklist.empty()) {
+			auto state = worklist.back();
+			worklist.pop_back();
+
+			auto kind = static_cast<StateKind>(state[0]);
+			x = state[1];
+			y = state[2];
+			dx = state[3];
+			dy = state[4];
+
+			currentLabel = labels[state];
+			fused = 0;
+			knownOp.clear();
+			code.str("");
+
+			made.push_back(currentLabel);
+			heat[currentLabel] = kind == StateKind::INSTRUCTION ? countAt(x, y, dx, dy) : 0;
+
+			code << "L" << currentLabel << ": /* ";
+			if (kind == StateKind::SWITCH) code << "switch ";
+			else if (kind == StateKind::HEAP) code << "array elements ";
+			code << "at " << x << ", " << y << " moving " << (dx > 0 ? "right" : dx < 0 ? "left" : dy < 0 ? "up" : "down") << " */\n";
+
+			switch (kind) {
+				case StateKind::INSTRUCTION: emitInstruction(); break;
+				case StateKind::SWITCH: emitSwitch(); break;
+				case StateKind::HEAP: emitHeap(state[5]); break;
+			}
+
+			blocks[currentLabel] = code.str();
+		}
+
+		auto order = profile == nullptr ? made : layout(made, heat);
+
+		auto guard = std::string("LANGUAGE568_") + name + "_H";
+		for (auto & c : guard) c = char(std::toupper(c));
+
+		auto from = source + (profile == nullptr ? "" : " with a profile of " + std::to_string(profile->getRuns()) + " runs");
+
+		headerOut << "\n/* generated by transpile568 from " << from << " */\n\n";
+		headerOut << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+		headerOut << "#include \"compiled568.h\"\n\n";
+		headerOut << "class " << name << " : public Compiled568 {\npublic:\n\tauto run() -> void override;\n};\n\n";
+		headerOut << "#endif //" << guard << "\n";
+
+		sourceOut << "\n/* generated by transpile568 from " << from << " */\n\n";
+		sourceOut << "#include \"" << header << "\"\n\n";
+		sourceOut << "#include <iostream>\n\n";
+		sourceOut << "static auto registered = Compiled568::add(\"" << name << "\", []() -> std::unique_ptr<Compiled568> { return std::make_unique<" << name << ">(); });\n\n";
+		sourceOut << "auto " << name << "::run() -> void {\n";
+		sourceOut << "\tint r [NUM_REGISTERS];\n";
+		sourceOut << "\tstd::vector<int> * a [NUM_REGISTERS];\n\n";
+		sourceOut << "\tauto last = 0;\n";
+		sourceOut << "\t[[maybe_unused]] auto * lastRef = static_cast<int *>(nullptr);\n";
+		sourceOut << "\t[[maybe_unused]] auto lastReg = -1;\n";
+		sourceOut << "\t[[maybe_unused]] auto op = NONE;\n\n";
+		sourceOut << "\t/* the operand being loaded */\n";
+		sourceOut << "\t[[maybe_unused]] auto val = 0;\n";
+		sourceOut << "\t[[maybe_unused]] auto * ref = static_cast<int *>(nullptr);\n";
+		sourceOut << "\t[[maybe_unused]] auto reg = -1;\n\n";
+		sourceOut << "\t/* the array being initialized */\n";
+		sourceOut << "\t[[maybe_unused]] auto size = 0;\n";
+		sourceOut << "\t[[maybe_unused]] auto element = 0;\n\n";
+		sourceOut << "\t/* first register enters as number of registers */\n";
+		sourceOut << "\tregisters[0].integer = registerIndex - 1;\n";
+		sourceOut << "\terror = \"\";\n\n";
+		sourceOut << "\tfor (auto i = 0; i < NUM_REGISTERS; ++i) {\n\t\tr[i] = registers[i].integer;\n\t\ta[i] = registers[i].array;\n\t}\n\n";
+		sourceOut << "\t" << entry << "\n\n";
+		for (auto label : order) sourceOut << blocks[label];
+		sourceOut << "finish:\n";
+		sourceOut << "\tfor (auto i = 0; i < NUM_REGISTERS; ++i) {\n\t\tregisters[i].integer = r[i];\n\t\tregisters[i].array = a[i];\n\t}\n";
+		sourceOut << "}\n";
+	}
+};
+
+const char * Transpiler::colorNames [6] = {
+	"red",
+	"yellow",
+	"green",
+	"cyan",
+	"blue",
+	"magenta"
+};
+
+/**
+ * profiles a random program over runs of small integer and array inputs like diff568's,
+ * drawn from another stream than diff568's so the profile is not a record of exactly the runs it checks
+ *
+ * runs are held to a step limit in case some input never lets the program out
+ */
+static auto recordRandom(Engine568 & engine, unsigned long seed, unsigned int runs, ProgramProfile568 & profile) -> void {
+	constexpr static unsigned long long STEP_LIMIT = 1000000;
+
+	auto random = std::mt19937(~seed);
+	auto printed = std::ostringstream();
+	auto observer = ProgramProfileObserver568(profile);
+
+	engine.setOutput(printed);
+	engine.setStepLimit(STEP_LIMIT);
+
+	for (auto run = 0u; run < runs; ++run) {
+		engine.reset();
+		auto count = random() % 5;
+
+		for (auto i = 0u; i < count; ++i) {
+			if (random() % 4 == 0) {
+				auto array = std::vector<int>(random() % 4);
+				for (auto & element : array) element = int(random() % 9) - 4;
+
+				engine.pushArray(array.size(), array.data());
+
+			} else {
+				engine.pushInt(int(random() % 9) - 4);
+			}
+		}
+
+		engine.run(observer);
+	}
+}
+
+int main(int argc, char ** argv) {
+	/* the profile next to a png is used unless another is given or it is turned off */
+	auto profilePath = std::string();
+	auto useProfile = true;
+	auto recordRuns = 0u;
+	auto args = std::vector<char *>();
+
+	for (auto i = 0; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+
+		if (arg == "--profile" && i + 1 < argc) profilePath = argv[++i];
+		else if (arg == "--no-profile") useProfile = false;
+		else if (arg == "--record-profile" && i + 1 < argc) recordRuns = std::stoul(argv[++i]);
+		else args.push_back(argv[i]);
+	}
+
+	argc = static_cast<int>(args.size());
+	argv = args.data();
+
+	auto random = argc == 5 && std::string(argv[1]) == "--random";
+
+	if (!random && !(argc == 4 && std::string(argv[1]) != "--random")) {
+		std::cout << "usage: transpile568 <program.png> <output> <class name> [--profile <file> | --no-profile]" << std::endl;
+		std::cout << "       transpile568 --random <seed> <output> <class name> [--profile <file> | --record-profile <runs>]" << std::endl;
+		std::cout << "writes <output>.h and <output>.cpp, fused and laid out by <program.png>.profile if there is one" << std::endl;
+		return 2;
+	}
+
+	if (recordRuns != 0 && (!random || !profilePath.empty())) {
+		std::cout << "--record-profile only profiles --random programs, and in place of --profile" << std::endl;
+		return 2;
+	}
+
+	auto source = std::string(random ? std::string("random program ") + argv[2] : argv[1]);
+	auto output = std::string(argv[argc - 2]);
+	auto name = std::string(argv[argc - 1]);
+
+	if (!profilePath.empty() && !std::filesystem::exists(profilePath)) {
+		std::cout << "no profile at " << profilePath << std::endl;
+		return 2;
+	}
+
+	if (profilePath.empty() && !random) profilePath = ProgramProfile568::pathFor(argv[1]);
+
+	auto profile = ProgramProfile568();
+	auto profileError = std::string();
+
+	useProfile = useProfile && !profilePath.empty() && std::filesystem::exists(profilePath);
+
+	if (useProfile && !profile.load(profilePath, profileError)) {
+		std::cout << profileError << std::endl;
+		return 2;
+	}
+
+	auto engine = Engine568();
+
+	if (random) {
+		auto canvas = Programs::random(std::stoul(argv[2]));
+		engine.load(canvas.getWidth(), canvas.getHeight(), canvas.getPixels());
+
+		if (recordRuns != 0 && engine.getLoadStats().verified) {
+			recordRandom(engine, std::stoul(argv[2]), recordRuns, profile);
+			useProfile = true;
+		}
+
+	} else {
+		auto image = CNGE::Image::fromPNG(argv[1]);
+
+		if (image == nullptr || !image->isValid()) {
+			std::cout << "invalid filename" << std::endl;
+			return 2;
+		}
+
+		engine.load(image->getWidth(), image->getHeight(), image->getPixels());
+	}
+
+	auto & stats = engine.getLoadStats();
+
+	if (!stats.verified) {
+		for (auto & error : engine.getVerifyErrors()) std::cout << error.toString() << std::endl;
+		std::cout << "Rejected, only verified programs can be transpiled" << std::endl;
+		return 1;
+	}
+
+	auto header = output + ".h";
+	auto slash = header.find_last_of("/\\");
+
+	auto headerOut = std::ofstream(header);
+	auto sourceOut = std::ofstream(output + ".cpp");
+
+	if (!headerOut || !sourceOut) {
+		std::cout << "could not write " << output << std::endl;
+		return 2;
+	}
+
+	auto transpiler = Transpiler(engine.getImage().data(), stats.width, stats.height, useProfile ? &profile : nullptr);
+	transpiler.transpile(name, source, slash == std::string::npos ? header : header.substr(slash + 1), headerOut, sourceOut);
+
+	return 0;
+}